@@ -69,6 +69,9 @@ About::init_credits ()
     case ARDOUR::AVX:
 		optimization = "AVX";
 	break;
+    case ARDOUR::AVX2:
+		optimization = "AVX2/FMA";
+	break;
 	case ARDOUR::APPLE_VECLIB:
 		optimization = "Apple VecLib";
 	break;
@@ -73,6 +73,7 @@
 #include "ardour/audiofilesource.h"
 #include "ardour/automation_watch.h"
 #include "ardour/diskstream.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/engine_state_controller.h"
 #include "ardour/filename_extensions.h"
 #include "ardour/filesystem_paths.h"
@@ -1172,6 +1173,21 @@ ARDOUR_UI::update_cpu_load ()
     stringstream ss;
     ss << (int)c;
     _dsp_load_label->set_text ( ss.str() + "%" );
+
+	if (_session && DSPProfiler::enabled ()) {
+		DSPTimingStats const cp = _session->critical_path_stats ();
+		vector<DSPTimingStats> idle;
+		_session->process_thread_idle_stats (idle);
+
+		stringstream tip;
+		tip << string_compose (_("Critical path: avg %1us, max %2us, 99%% %3us"), cp.avg, cp.max, cp.p99);
+		for (vector<DSPTimingStats>::size_type n = 0; n < idle.size(); ++n) {
+			tip << "\n" << string_compose (_("Thread %1 idle: avg %2us, min %3us"), n + 1, idle[n].avg, idle[n].min);
+		}
+		_dsp_load_label->set_tooltip_text (tip.str ());
+	} else {
+		_dsp_load_label->set_tooltip_text ("");
+	}
 }
 
 void
@@ -975,5 +975,7 @@ AutomationTimeAxisView::cut_copy_clear_one (AutomationLine& line, Selection& sel
 			(*x)->when = when;
 			(*x)->value = val;
 		}
+		/* we changed the events behind the list's back */
+		what_we_got->mark_dirty ();
 	}
 }
@@ -4606,7 +4606,8 @@ Editor::reset_point_selection ()
 {
 	for (PointSelection::iterator i = selection->points.begin(); i != selection->points.end(); ++i) {
 		ARDOUR::AutomationList::iterator j = (*i)->model ();
-		(*j)->value = (*i)->line().the_list()->default_value ();
+		boost::shared_ptr<ARDOUR::AutomationList> alist = (*i)->line().the_list ();
+		alist->modify (j, (*j)->when, alist->default_value ());
 	}
 }
 
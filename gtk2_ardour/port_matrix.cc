@@ -268,6 +268,8 @@ PortMatrix::disassociate_all ()
 	PortGroup::BundleList a = _ports[0].bundles ();
 	PortGroup::BundleList b = _ports[1].bundles ();
 
+	ARDOUR::Session::RouteGraphBatch rgb (_session);
+
 	for (PortGroup::BundleList::iterator i = a.begin(); i != a.end(); ++i) {
 		for (uint32_t j = 0; j < (*i)->bundle->nchannels().n_total(); ++j) {
 			for (PortGroup::BundleList::iterator k = b.begin(); k != b.end(); ++k) {
@@ -569,6 +571,8 @@ PortMatrix::disassociate_all_on_bundle (boost::weak_ptr<Bundle> bundle, int dim)
 		return;
 	}
 
+	ARDOUR::Session::RouteGraphBatch rgb (_session);
+
 	for (uint32_t i = 0; i < sb->nchannels().n_total(); ++i) {
 		if (should_show (sb->channel_type(i))) {
 			disassociate_all_on_channel (bundle, i, dim);
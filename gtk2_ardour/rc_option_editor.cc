@@ -1928,6 +1928,14 @@ RCOptionEditor::RCOptionEditor ()
 
 	add_option (_("Audio"), dm);
 
+	add_option (_("Audio"),
+	     new BoolOption (
+		     "dsp-profiling",
+		     _("Measure how long routes and plugins take to process"),
+		     sigc::mem_fun (*_rc_config, &RCConfiguration::get_dsp_profiling),
+		     sigc::mem_fun (*_rc_config, &RCConfiguration::set_dsp_profiling)
+		     ));
+
 	add_option (_("Audio"), new OptionEditorHeading (_("Plugins")));
 
 	add_option (_("Audio"),
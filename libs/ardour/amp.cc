@@ -28,6 +28,7 @@
 #include "ardour/buffer_set.h"
 #include "ardour/midi_buffer.h"
 #include "ardour/rc_configuration.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/session.h"
 
 #include "i18n.h"
@@ -110,13 +111,18 @@ Amp::run (BufferSet& bufs, framepos_t /*start_frame*/, framepos_t /*end_frame*/,
 			const double a = 156.825 / _session.nominal_frame_rate(); // 25 Hz LPF; see Amp::apply_gain for details
 			double lpf = _current_gain;
 
+			/* the filter is recursive, so run it once to turn the automation
+			   into the gain actually applied at each sample, and then apply
+			   that to every channel.
+			*/
+			for (pframes_t nx = 0; nx < nframes; ++nx) {
+				const gain_t g = gab[nx];
+				gab[nx] = lpf;
+				lpf += a * (g - lpf);
+			}
+
 			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-				Sample* const sp = i->data();
-				lpf = _current_gain;
-				for (pframes_t nx = 0; nx < nframes; ++nx) {
-					sp[nx] *= lpf;
-					lpf += a * (gab[nx] - lpf);
-				}
+				apply_gain_vector (i->data(), gab, nframes);
 			}
 
 			if (fabs (lpf) < GAIN_COEFF_TINY) {
@@ -213,13 +219,7 @@ Amp::apply_gain (BufferSet& bufs, framecnt_t sample_rate, framecnt_t nframes, ga
 	const double a = 156.825 / sample_rate; // 25 Hz LPF
 
 	for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-		Sample* const buffer = i->data();
-		double lpf = initial;
-
-		for (pframes_t nx = 0; nx < nframes; ++nx) {
-			buffer[nx] *= lpf;
-			lpf += a * (target - lpf);
-		}
+		const gain_t lpf = apply_gain_ramp (i->data(), nframes, initial, target, a);
 		if (i == bufs.audio_begin()) {
 			rv = lpf;
 		}
@@ -288,14 +288,9 @@ Amp::apply_gain (AudioBuffer& buf, framecnt_t sample_rate, framecnt_t nframes, g
 		return target;
 	}
 
-        Sample* const buffer = buf.data();
 	const double a = 156.825 / sample_rate; // 25 Hz LPF, see [other] Amp::apply_gain() above for details
 
-	double lpf = initial;
-        for (pframes_t nx = 0; nx < nframes; ++nx) {
-                buffer[nx] *= lpf;
-		lpf += a * (target - lpf);
-        }
+	const gain_t lpf = apply_gain_ramp (buf.data(), nframes, initial, target, a);
 
 	if (fabs (lpf - target) < GAIN_COEFF_TINY) return target;
 	if (fabs (lpf) < GAIN_COEFF_TINY) return GAIN_COEFF_ZERO;
@@ -49,7 +49,8 @@ namespace ARDOUR {
         NONE,
         SSE,
         AVX,
-        APPLE_VECLIB
+        APPLE_VECLIB,
+        AVX2
     };
     
 	class AudioEngine;
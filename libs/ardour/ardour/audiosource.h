@@ -131,6 +131,8 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	int compute_and_write_peaks (Sample* buf, framecnt_t first_frame, framecnt_t cnt,
 	bool force, bool intermediate_peaks_ready_signal);
 	void truncate_peakfile();
+	void drop_peakfile_map ();
+	std::string peak_levels_path () const;
 
 	mutable off_t _peak_byte_max; // modified in compute_and_write_peak()
 
@@ -164,6 +166,34 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	Sample*    peak_leftovers;
 	framepos_t peak_leftover_frame;
 
+	/** A read-only mapping of the peakfile, kept until the peakfile is
+	 *  rewritten, renamed or removed so that reading peaks needs neither
+	 *  open() nor mmap() each time. It, and the peak cache below, are
+	 *  protected by _peak_map_lock rather than _lock so that drawing
+	 *  waveforms does not wait on capture writes.
+	 */
+	class PeakFileMap;
+	mutable Glib::Threads::Mutex _peak_map_lock;
+	mutable PeakFileMap* _peak_map;
+
+	off_t map_peakfile (off_t bytes) const;
+
+	/** Coarser levels of the peakfile, each with a quarter as many peaks
+	 *  as the one before, kept in a sidecar file (see peak_levels_path())
+	 *  so that wide zoom levels do not have to reduce huge spans of peaks.
+	 *  Built alongside the peakfile, or from it when first needed if the
+	 *  peakfile predates them.
+	 */
+	mutable PeakFileMap* _peak_levels_map;
+	mutable bool _peak_levels_valid; ///< protected by _peak_map_lock
+	mutable bool _peak_levels_failed;
+	int   _peak_levels_fd;
+	off_t _peak_levels_byte_max;
+
+	off_t map_peak_levels (off_t bytes) const;
+	bool build_peak_levels () const;
+	int write_peak_levels (framepos_t first_peak, framecnt_t npeaks);
+
 	mutable bool _first_run;
 	mutable double _last_scale;
 	mutable off_t _last_map_off;
@@ -96,6 +96,9 @@ public:
 
 	const ARDOUR::Session& session() const { return _session; }
 
+	/** Emitted by set_list(), in its caller's thread */
+	PBD::Signal0<void> ListReplaced;
+
 protected:
 
 	ARDOUR::Session& _session;
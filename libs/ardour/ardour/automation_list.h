@@ -113,6 +113,8 @@ class LIBARDOUR_API AutomationList : public PBD::StatefulDestructible, public Ev
   private:
 	void create_curve_if_necessary ();
 	int deserialize_events (const XMLNode&);
+	void listen_for_changes ();
+	XMLNode const & cached_events ();
 
 	void maybe_signal_changed ();
 
@@ -120,6 +122,15 @@ class LIBARDOUR_API AutomationList : public PBD::StatefulDestructible, public Ev
 	AutoStyle    _style;
 	gint         _touching;
 
+	/* the last result of serialize_events(), and the state_generation()
+	   it was made at; events can be many thousands of points, so only
+	   serialize them again when they have changed.
+	*/
+	Glib::Threads::Mutex _events_state_lock;
+	XMLNode*             _events_state;
+	uint32_t             _events_state_generation;
+	PBD::ScopedConnection _dirty_connection;
+
 	bool operator== (const AutomationList&) const { /* not called */ abort(); return false; }
 };
 
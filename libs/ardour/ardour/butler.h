@@ -20,7 +20,11 @@
 #ifndef __ardour_butler_h__
 #define __ardour_butler_h__
 
+#include <map>
+#include <vector>
+
 #include <pthread.h>
+#include <sys/types.h>
 
 #include <glibmm/threads.h>
 
@@ -35,10 +39,14 @@
 #include "ardour/types.h"
 #include "ardour/session_handle.h"
 
+#include "pbd/id.h"
+
 
 
 namespace ARDOUR {
 
+class Track;
+
 /**
  *  One of the Butler's functions is to clean up (ie delete) unused CrossThreadPools.
  *  When a thread with a CrossThreadPool terminates, its CTP is added to pool_trash.
@@ -72,6 +80,7 @@ class LIBARDOUR_API Butler : public SessionHandleRef
     void update_buffering_parameters();
     
 	static void* _thread_work(void *arg);
+	static void keep_off_process_cpus ();
 	void*         thread_work();
 
 	struct Request {
@@ -97,6 +106,63 @@ private:
 	void empty_pool_trash ();
 	void config_changed (std::string);
 
+	/* Optional pool of disk workers. The butler thread itself still
+	 * handles requests and transport work; when the pool is in use it
+	 * hands each refill or flush pass to the workers as jobs, queued
+	 * per device and ordered by buffer load (most urgent first), and
+	 * waits for the pass to complete.
+	 */
+
+	struct DiskJob {
+		DiskJob (boost::shared_ptr<Track> t, float l) : track (t), load (l) {}
+		boost::shared_ptr<Track> track;
+		float load; ///< buffer load as reported by the track; lower is more urgent
+
+		/* sorts least urgent first, so that the most urgent job is at the back */
+		bool operator< (DiskJob const & other) const { return load > other.load; }
+	};
+
+	typedef std::vector<DiskJob> DiskQueue;
+
+	struct Worker {
+		Worker (Butler& b) : butler (b), mixdown_buffer (0), gain_buffer (0) {}
+		Butler&   butler;
+		pthread_t thread;
+		Sample*   mixdown_buffer;
+		gain_t*   gain_buffer;
+	};
+
+	enum DiskPass {
+		RefillPass,
+		FlushPass
+	};
+
+	int  start_workers ();
+	void terminate_workers ();
+	static void* _worker_thread_work (void* arg);
+	void worker_thread_work (Worker*);
+	bool run_disk_pass (DiskPass, RouteList const &, uint32_t& err);
+	bool next_disk_job (DiskJob&);
+	dev_t device_for (boost::shared_ptr<Track>, DiskPass);
+
+	std::vector<Worker*>   _workers;
+	Glib::Threads::Mutex   _worker_lock;
+	Glib::Threads::Cond    _worker_cond;
+	Glib::Threads::Cond    _pass_done;
+	std::vector<DiskQueue> _disk_queues;
+	DiskPass               _pass;
+	size_t                 _next_queue;
+	uint32_t               _jobs_pending;
+	bool                   _pass_outstanding;
+	uint32_t               _pass_err;
+	bool                   _workers_quit;
+
+	/* device that each track reads from and writes to; only used by the
+	   butler thread
+	*/
+	std::map<std::pair<PBD::ID, DiskPass>, dev_t> _device_cache;
+	boost::shared_ptr<RouteList>      _device_cache_routes;
+
 	/**
 	 * Add request to butler thread request queue
 	 */
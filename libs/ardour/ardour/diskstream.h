@@ -246,6 +246,17 @@ class LIBARDOUR_API Diskstream : public SessionObject, public PublicDiskstream
 	virtual int do_flush (RunContext context, bool force = false) = 0;
 	virtual int do_refill () = 0;
 
+	/* As do_refill(), but using caller-supplied working buffers so that
+	   several butler workers can refill different diskstreams at once.
+	*/
+	virtual int do_refill_with_buffers (Sample*, gain_t*) { return do_refill (); }
+
+	/* a file that this diskstream reads from (for playback) or writes to
+	   (when capturing), used by the butler to group disk I/O by device
+	*/
+	std::string disk_read_path () const;
+	virtual std::string disk_write_path () const;
+
 	/* XXX fix this redundancy ... */
 
 	virtual void playlist_changed (const PBD::PropertyChange&);
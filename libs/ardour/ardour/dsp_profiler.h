@@ -0,0 +1,116 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_dsp_profiler_h__
+#define __ardour_dsp_profiler_h__
+
+#include <stdint.h>
+#include <glib.h>
+
+#include "ardour/ardour.h"
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** Whether the process threads are timing routes, processors and the
+ *  graph.  When it is off, each timing point costs a test of a flag.
+ */
+class LIBARDOUR_API DSPProfiler
+{
+  public:
+	static bool enabled () { return _enabled; }
+	static void set_enabled (bool yn) { _enabled = yn; }
+
+  private:
+	static bool _enabled;
+};
+
+/** Summary of some DSPTimings, in microseconds */
+struct LIBARDOUR_API DSPTimingStats {
+	DSPTimingStats () : count (0), min (0), avg (0), max (0), p99 (0) {}
+
+	uint64_t       count;
+	microseconds_t min;
+	microseconds_t avg;
+	microseconds_t max;
+	microseconds_t p99; ///< to within an eighth or so, from the histogram
+};
+
+/** A histogram of how long something took in each process cycle: a route,
+ *  a processor, the graph's critical path or a process thread's idle time.
+ *
+ *  Only one process thread adds to a given DSPTimings in any one cycle,
+ *  and stats() and reset() may be called from any other thread; nobody
+ *  takes a lock.  A reader may see the values from part way through an
+ *  add(), which does no harm to a statistic.
+ */
+class LIBARDOUR_API DSPTimings
+{
+  public:
+	DSPTimings ();
+
+	/** Called from the process thread */
+	void add (microseconds_t);
+
+	DSPTimingStats stats () const;
+
+	/** Clear the timings; takes effect at the next add() */
+	void reset () { g_atomic_int_set (&_reset, 1); }
+
+  private:
+	/* four buckets for each power of two, up to about 8 seconds */
+	static const int bucket_count = 88;
+
+	static int bucket (microseconds_t);
+	static microseconds_t bucket_top (int);
+
+	uint32_t       _buckets[bucket_count];
+	uint64_t       _count;
+	uint64_t       _total;
+	microseconds_t _min;
+	microseconds_t _max;
+	mutable gint   _reset;
+};
+
+/** Adds the time between its construction and destruction to a
+ *  DSPTimings, if profiling is enabled.
+ */
+class LIBARDOUR_API DSPTimer
+{
+  public:
+	DSPTimer (DSPTimings& t)
+		: _timings (t)
+		, _start (DSPProfiler::enabled () ? get_microseconds () : 0)
+	{}
+
+	~DSPTimer () {
+		if (_start) {
+			_timings.add (get_microseconds () - _start);
+		}
+	}
+
+  private:
+	DSPTimings&    _timings;
+	microseconds_t _start;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_dsp_profiler_h__ */
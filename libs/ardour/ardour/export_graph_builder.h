@@ -23,21 +23,24 @@
 
 #include "ardour/export_handler.h"
 
-#include "audiographer/utils/identity_vertex.h"
+#include "audiographer/sink.h"
 
 #include <boost/ptr_container/ptr_list.hpp>
 #include <glibmm/threadpool.h>
+#include <glibmm/threads.h>
 
 namespace AudioGrapher {
 	class SampleRateConverter;
 	class PeakReader;
 	class Normalizer;
+	class ThreaderException;
 	template <typename T> class Chunker;
 	template <typename T> class SampleFormatConverter;
 	template <typename T> class Interleaver;
 	template <typename T> class SndfileWriter;
 	template <typename T> class SilenceTrimmer;
 	template <typename T> class TmpFile;
+	template <typename T> class TmpBuffer;
 	template <typename T> class Threader;
 	template <typename T> class AllocatingProcessContext;
 }
@@ -54,8 +57,8 @@ class LIBARDOUR_API ExportGraphBuilder
 	typedef ExportHandler::FileSpec FileSpec;
 
 	typedef boost::shared_ptr<AudioGrapher::Sink<Sample> > FloatSinkPtr;
-	typedef boost::shared_ptr<AudioGrapher::IdentityVertex<Sample> > IdentityVertexPtr;
-	typedef std::map<ExportChannelPtr,  IdentityVertexPtr> ChannelMap;
+	// Each channel's data for the current cycle
+	typedef std::map<ExportChannelPtr, Sample const *> ChannelMap;
 
   public:
 
@@ -116,6 +119,8 @@ class LIBARDOUR_API ExportGraphBuilder
 		void remove_children (bool remove_out_files);
 		bool operator== (FileSpec const & other_config) const;
 
+		float normalize_target () const;
+
 	                                        private:
 		typedef boost::shared_ptr<AudioGrapher::SampleFormatConverter<Sample> > FloatConverterPtr;
 		typedef boost::shared_ptr<AudioGrapher::SampleFormatConverter<int> >   IntConverterPtr;
@@ -131,6 +136,10 @@ class LIBARDOUR_API ExportGraphBuilder
 		ShortConverterPtr short_converter;
 	};
 
+	/* Measures the peak while writing to a temporary file (or memory),
+	   then reads it back once for every normalized format below one SRC,
+	   each format with its own gain, in parallel.
+	*/
 	class Normalizer {
 	                                        public:
 		Normalizer (ExportGraphBuilder & parent, FileSpec const & new_config, framecnt_t max_frames);
@@ -143,11 +152,13 @@ class LIBARDOUR_API ExportGraphBuilder
 
 		/// Returns true when finished
 		bool process ();
+		bool finished () const { return _finished; }
 
 	                                        private:
 		typedef boost::shared_ptr<AudioGrapher::PeakReader> PeakReaderPtr;
 		typedef boost::shared_ptr<AudioGrapher::Normalizer> NormalizerPtr;
 		typedef boost::shared_ptr<AudioGrapher::TmpFile<Sample> > TmpFilePtr;
+		typedef boost::shared_ptr<AudioGrapher::TmpBuffer<Sample> > TmpBufferPtr;
 		typedef boost::shared_ptr<AudioGrapher::Threader<Sample> > ThreaderPtr;
 		typedef boost::shared_ptr<AudioGrapher::AllocatingProcessContext<Sample> > BufferPtr;
 
@@ -160,10 +171,14 @@ class LIBARDOUR_API ExportGraphBuilder
 
 		BufferPtr       buffer;
 		PeakReaderPtr   peak_reader;
+		// Only one of these is used, depending on the length of the export
 		TmpFilePtr      tmp_file;
-		NormalizerPtr   normalizer;
+		TmpBufferPtr    tmp_buffer;
 		ThreaderPtr     threader;
 		boost::ptr_list<SFC> children;
+		// The gain for each child, in the same order
+		std::list<NormalizerPtr> normalizers;
+		bool            _finished;
 
 		PBD::ScopedConnection post_processing_connection;
 	};
@@ -219,12 +234,16 @@ class LIBARDOUR_API ExportGraphBuilder
 		void remove_children (bool remove_out_files);
 		bool operator== (FileSpec const & other_config) const;
 
+		/// Processes this cycle's data, once every channel has been read
+		void process (framecnt_t frames, bool last_cycle);
+
 	                                        private:
 		typedef boost::shared_ptr<AudioGrapher::Interleaver<Sample> > InterleaverPtr;
 		typedef boost::shared_ptr<AudioGrapher::Chunker<Sample> > ChunkerPtr;
 
 		ExportGraphBuilder &      parent;
 		FileSpec                  config;
+		ChannelMap &              channel_map;
 		boost::ptr_list<SilenceHandler> children;
 		InterleaverPtr            interleaver;
 		ChunkerPtr                chunker;
@@ -245,7 +264,32 @@ class LIBARDOUR_API ExportGraphBuilder
 
 	std::list<Normalizer *> normalizers;
 
+	void run_channel_configs (framecnt_t frames, bool last_cycle);
+	void run_channel_config (ChannelConfig *, framecnt_t frames, bool last_cycle);
+	void run_normalizers ();
+	void run_normalizer (Normalizer *);
+
+	/* Work run in parallel by run_channel_configs() and run_normalizers() */
+	void start_jobs (unsigned);
+	void job_failed (std::exception const &);
+	void job_done ();
+	void wait_for_jobs ();
+
 	Glib::ThreadPool thread_pool;
+
+	/* Normalizers run in parallel from here, and their Threaders use
+	   thread_pool; with one pool the normalizers could fill it while
+	   waiting for their Threaders' work.
+	*/
+	Glib::ThreadPool normalize_pool;
+
+	/* also protects normalizers, which channel configs add to as they
+	   finish, perhaps in parallel
+	*/
+	Glib::Threads::Mutex jobs_mutex;
+	Glib::Threads::Cond jobs_cond;
+	gint jobs_running;
+	boost::shared_ptr<AudioGrapher::ThreaderException> jobs_exception;
 };
 
 } // namespace ARDOUR
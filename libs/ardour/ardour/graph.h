@@ -30,11 +30,14 @@
 
 #include <glib.h>
 
+#include <glibmm/threads.h>
+
 #include "pbd/semutils.h"
 
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 #include "ardour/audio_backend.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/session_handle.h"
 
 namespace ARDOUR
@@ -43,6 +46,7 @@ namespace ARDOUR
 class GraphNode;
 class Graph;
 
+class ProcessThread;
 class Route;
 class Session;
 class GraphEdges;	
@@ -85,6 +89,25 @@ public:
 
 	bool in_process_thread () const;
 
+	/** Counts of scheduler events since the process threads were
+	 *  (re)started: nodes taken from another thread's queue, threads
+	 *  going to sleep for lack of work, and sleeping threads woken.
+	 */
+	void scheduler_counts (uint32_t& steals, uint32_t& parks, uint32_t& wakes) const;
+
+	/** While DSP profiling is enabled, the time taken by the slowest
+	 *  chain of routes through the graph in each cycle.  No number of
+	 *  threads can run a cycle faster than this.
+	 */
+	DSPTimingStats critical_path_stats () const { return _critical_path_timings.stats (); }
+
+	/** While DSP profiling is enabled, the time that each process
+	 *  thread spent in each cycle not running routes.
+	 */
+	void thread_idle_stats (std::vector<DSPTimingStats>&);
+
+	void reset_dsp_timings ();
+
 protected:
 	virtual void session_going_away ();
 
@@ -98,11 +121,53 @@ private:
 
 	node_list_t _init_trigger_list[2];
 
+	/* Each process thread has its own queue of nodes that are ready to
+	 * run. A thread pushes the nodes that it triggers onto its own queue
+	 * and pops from it LIFO; idle threads steal from the other end of
+	 * other threads' queues, spin for a while and then sleep on
+	 * _execution_sem.
+	 */
+	class WorkQueue;
+
+	std::vector<WorkQueue*>            _work_queues;
+	Glib::Threads::Private<WorkQueue>  _thread_work_queue;
+	volatile gint                      _next_work_queue;
+
+	uint32_t claim_work_queue ();
+	void setup_thread (ProcessThread*);
+	GraphNode* find_work (WorkQueue*);
+	bool work_available () const;
+	void wake_one ();
+
+	/** Nodes triggered from outside the process threads, or which did not
+	 *  fit on a thread's own queue.
+	 */
 	std::vector<GraphNode *> _trigger_queue;
 	pthread_mutex_t          _trigger_mutex;
+	volatile gint            _trigger_queue_size;
 
 	PBD::ProcessSemaphore _execution_sem;
 
+	/** CPUs to pin the process threads to, one each; empty for no pinning */
+	std::vector<uint32_t> _thread_cpus;
+	/** Signalled by each process thread once it is set up */
+	PBD::ProcessSemaphore _thread_start_sem;
+
+	volatile gint _steal_count;
+	volatile gint _park_count;
+	volatile gint _wake_count;
+
+	/* DSP profiling; see critical_path_stats() and thread_idle_stats() */
+	friend class GraphNode;
+
+	microseconds_t              _cycle_start;
+	volatile gint               _critical_path;
+	DSPTimings                  _critical_path_timings;
+	std::vector<microseconds_t> _thread_busy;
+	std::vector<DSPTimings>     _thread_idle;
+
+	void add_cycle_timings ();
+
 	/** Signalled to start a run of the graph for a process callback */
 	PBD::ProcessSemaphore _callback_start_sem;
 	PBD::ProcessSemaphore _callback_done_sem;
@@ -61,6 +61,11 @@ class LIBARDOUR_API GraphNode
 	gint _refcount;
 	/** The number of nodes that we directly feed us (one count for each chain) */
 	gint _init_refcount[2];
+
+	/** While DSP profiling, the time in microseconds along the slowest
+	 *  chain of nodes from the start of the graph to the end of this one.
+	 */
+	gint _path;
 };
 
 }
@@ -66,6 +66,8 @@ class LIBARDOUR_API MidiDiskstream : public Diskstream
 	float playback_buffer_load() const;
 	float capture_buffer_load() const;
 
+	std::string disk_write_path () const;
+
 	void get_playback (MidiBuffer& dst, framecnt_t);
 	void flush_playback (framepos_t, framepos_t);
 
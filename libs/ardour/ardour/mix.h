@@ -45,6 +45,36 @@ extern "C" {
 LIBARDOUR_API void  x86_sse_find_peaks                 (const float * buf, uint32_t nsamples, float *min, float *max);
 LIBARDOUR_API void  x86_sse_avx_find_peaks             (const float * buf, uint32_t nsamples, float *min, float *max);
 
+LIBARDOUR_API ARDOUR::gain_t x86_sse_apply_gain_ramp   (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, ARDOUR::gain_t initial, ARDOUR::gain_t target, ARDOUR::gain_t coefficient);
+LIBARDOUR_API void  x86_sse_apply_gain_vector          (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_sse_apply_inverse_gain_vector  (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_sse_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_sse_deinterleave               (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, uint32_t nchannels);
+
+#ifdef BUILD_AVX2_OPTIMIZATIONS
+
+/* AVX2/FMA functions */
+
+LIBARDOUR_API float x86_avx2_compute_peak              (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float current);
+LIBARDOUR_API void  x86_avx2_find_peaks                (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float *min, float *max);
+LIBARDOUR_API void  x86_avx2_apply_gain_to_buffer      (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, float gain);
+LIBARDOUR_API void  x86_avx2_mix_buffers_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
+LIBARDOUR_API void  x86_avx2_mix_buffers_no_gain       (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API ARDOUR::gain_t x86_avx2_apply_gain_ramp  (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, ARDOUR::gain_t initial, ARDOUR::gain_t target, ARDOUR::gain_t coefficient);
+LIBARDOUR_API void  x86_avx2_apply_gain_vector         (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_apply_inverse_gain_vector (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_interleave                (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, uint32_t nchannels);
+LIBARDOUR_API void  x86_avx2_deinterleave              (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, uint32_t nchannels);
+LIBARDOUR_API void  x86_avx2_float_to_int16            (int16_t * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_int16_to_float            (ARDOUR::Sample * dst, const int16_t * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_float_to_int24            (int32_t * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_int24_to_float            (ARDOUR::Sample * dst, const int32_t * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_float_to_int32            (int32_t * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  x86_avx2_int32_to_float            (ARDOUR::Sample * dst, const int32_t * src, ARDOUR::pframes_t nframes);
+
+#endif
+
 /* debug wrappers for SSE functions */
 
 LIBARDOUR_API float debug_compute_peak               (const ARDOUR::Sample * buf, ARDOUR::pframes_t nsamples, float current);
@@ -62,6 +92,8 @@ LIBARDOUR_API void veclib_find_peaks                 (const ARDOUR::Sample * buf
 LIBARDOUR_API void  veclib_apply_gain_to_buffer      (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, float gain);
 LIBARDOUR_API void  veclib_mix_buffers_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, float gain);
 LIBARDOUR_API void  veclib_mix_buffers_no_gain       (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  veclib_apply_gain_vector         (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  veclib_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
 
 #endif
 
@@ -74,4 +106,17 @@ LIBARDOUR_API void  default_mix_buffers_with_gain     (ARDOUR::Sample * dst, con
 LIBARDOUR_API void  default_mix_buffers_no_gain       (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
 LIBARDOUR_API void  default_copy_vector				  (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
 
+LIBARDOUR_API ARDOUR::gain_t default_apply_gain_ramp  (ARDOUR::Sample * buf, ARDOUR::pframes_t nframes, ARDOUR::gain_t initial, ARDOUR::gain_t target, ARDOUR::gain_t coefficient);
+LIBARDOUR_API void  default_apply_gain_vector         (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_apply_inverse_gain_vector (ARDOUR::Sample * buf, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const ARDOUR::gain_t * gain, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_interleave                (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, uint32_t nchannels);
+LIBARDOUR_API void  default_deinterleave              (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes, uint32_t nchannels);
+LIBARDOUR_API void  default_float_to_int16            (int16_t * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_int16_to_float            (ARDOUR::Sample * dst, const int16_t * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_float_to_int24            (int32_t * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_int24_to_float            (ARDOUR::Sample * dst, const int32_t * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_float_to_int32            (int32_t * dst, const ARDOUR::Sample * src, ARDOUR::pframes_t nframes);
+LIBARDOUR_API void  default_int32_to_float            (ARDOUR::Sample * dst, const int32_t * src, ARDOUR::pframes_t nframes);
+
 #endif /* __ardour_mix_h__ */
@@ -50,6 +50,7 @@ namespace ARDOUR  {
 class Session;
 class Playlist;
 class Crossfade;
+class RegionIndex;
 
 namespace Properties {
 	/* fake the type, since regions are handled by SequenceProperty which doesn't
@@ -259,6 +260,9 @@ public:
             }
 
         ~RegionWriteLock() {
+                /* rebuild here rather than in a reader, which may be the butler */
+                playlist->invalidate_region_index (true);
+                playlist->bump_state_generation ();
                 Glib::Threads::RWLock::WriterLock::release ();
                 if (block_notify) {
                         playlist->release_notifications ();
@@ -393,6 +397,30 @@ public:
 	friend class RegionWriteLock;
 	mutable Glib::Threads::RWLock region_lock;
 
+  private:
+	/* an index of `regions' by extent (see RegionIndex), rebuilt by
+	   whoever releases the region write lock, and otherwise on demand
+	   after a region's bounds change; the butler's read path never
+	   rebuilds it, and scans the list while it is out of date.
+	*/
+	mutable Glib::Threads::Mutex _region_index_lock;
+	mutable boost::shared_ptr<RegionIndex const> _region_index;
+	mutable gint    _region_index_generation;
+	mutable gint    _region_index_built;
+
+	void invalidate_region_index (bool rebuild = false);
+	boost::shared_ptr<RegionIndex const> region_index () const;
+	boost::shared_ptr<RegionIndex const> current_region_index () const;
+
+	/* the last full state, and the state_generation() of this playlist
+	   and (summed) of its regions when it was made; reused by state()
+	   until one of them changes.
+	*/
+	Glib::Threads::Mutex _state_cache_lock;
+	XMLNode*             _state_cache;
+	uint32_t             _state_cache_generation;
+	uint32_t             _state_cache_region_generations;
+
   private:
 	void setup_layering_indices (RegionList const &);
 	void coalesce_and_check_crossfades (std::list<Evoral::Range<framepos_t> >);
@@ -117,6 +117,11 @@ class LIBARDOUR_API Plugin : public PBD::StatefulDestructible, public Latent
 	virtual void deactivate () = 0;
 	virtual void flush () { deactivate(); activate(); }
 
+	/** @return how long the plugin may go on producing output after its
+	 *  input falls silent, if it says; otherwise -1.
+	 */
+	virtual framecnt_t tail_length () const { return -1; }
+
 	virtual int set_block_size (pframes_t nframes) = 0;
 
 	virtual int connect_and_run (BufferSet& bufs,
@@ -66,6 +66,8 @@ class LIBARDOUR_API PluginInsert : public Processor
 
 	int set_block_size (pframes_t nframes);
 
+	void add_control (boost::shared_ptr<Evoral::Control>);
+
 	ChanCount output_streams() const;
 	ChanCount input_streams() const;
 	ChanCount natural_output_streams() const;
@@ -132,6 +134,7 @@ class LIBARDOUR_API PluginInsert : public Processor
 	std::string describe_parameter (Evoral::Parameter param);
 
 	framecnt_t signal_latency () const;
+	framecnt_t tail_length () const;
 
 	boost::shared_ptr<Plugin> get_impulse_analysis_plugin();
 
@@ -197,7 +200,37 @@ class LIBARDOUR_API PluginInsert : public Processor
 	Match _match;
 
 	void automation_run (BufferSet& bufs, framepos_t start, pframes_t nframes);
-	void connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t offset, bool with_auto, framepos_t now = 0);
+	void connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t offset);
+
+	/** A control whose automation automation_run() may play back, kept
+	 *  here so that it need not be looked up and cast in every cycle.
+	 *  The list is only set outside the process thread, so that a list
+	 *  which has been replaced is never destroyed in it.
+	 */
+	struct AutomationSlot {
+		AutomationSlot (boost::shared_ptr<AutomationControl> c)
+			: control (c), list_ref (c->alist ()), list (list_ref.get ()), cursor (0), playing (false) {}
+
+		boost::shared_ptr<AutomationControl> control;
+		boost::shared_ptr<AutomationList> list_ref; ///< keeps list alive
+		AutomationList* list; ///< reader-locked while the cycle's timeline is built
+		size_t cursor; ///< position of the last event found in the list's index
+		bool playing;
+	};
+
+	/* the automation timeline for one cycle; _automation_values holds the
+	   value of each slot at the start of each slice, slice by slice.
+	   All are protected by _automation_lock, which is separate from
+	   control_lock() since controls may be added while that is held.
+	*/
+	Glib::Threads::Mutex        _automation_lock;
+	std::vector<AutomationSlot> _automation;
+	std::vector<framepos_t>     _automation_slices;
+	std::vector<float>          _automation_values;
+	framecnt_t                  _automation_granularity;
+
+	void resize_automation_timeline (pframes_t);
+	void automation_list_replaced (boost::weak_ptr<AutomationControl>);
 
 	void create_automatable_parameters ();
 	void control_list_automation_state_changed (Evoral::Parameter, AutoState);
@@ -41,6 +41,7 @@ public:
 
 	void get_buffers ();
 	void drop_buffers ();
+	void reallocate_buffers ();
 
 	/* these MUST be called by a process thread's thread, nothing else
 	 */
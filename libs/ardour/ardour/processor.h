@@ -28,6 +28,7 @@
 
 #include "ardour/ardour.h"
 #include "ardour/buffer_set.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/latent.h"
 #include "ardour/session_object.h"
 #include "ardour/libardour_visibility.h"
@@ -67,6 +68,14 @@ class LIBARDOUR_API Processor : public SessionObject, public Automatable, public
 
 	virtual framecnt_t signal_latency() const { return 0; }
 
+	/** @return how long this processor may go on making sound once its
+	 *  input has fallen silent, or -1 if it must run even when its input
+	 *  is silent (because it makes sound of its own, meters, delivers to
+	 *  ports, or we cannot tell).
+	 */
+	virtual framecnt_t tail_length () const { return -1; }
+	bool can_skip_run (bool input_silent, pframes_t nframes);
+
 	virtual int set_block_size (pframes_t /*nframes*/) { return 0; }
 	virtual bool requires_fixed_sized_buffers() const { return false; }
 
@@ -121,6 +130,10 @@ class LIBARDOUR_API Processor : public SessionObject, public Automatable, public
 	void set_owner (SessionObject*);
 	SessionObject* owner() const;
 
+	/** Time spent in run() while DSP profiling is enabled */
+	DSPTimings&       dsp_timings ()       { return _dsp_timings; }
+	DSPTimings const& dsp_timings () const { return _dsp_timings; }
+
 protected:
 	virtual int set_state_2X (const XMLNode&, int version);
 
@@ -135,6 +148,8 @@ protected:
 	void*     _ui_pointer;
 	ProcessorWindowProxy *_window_proxy;
 	SessionObject* _owner;
+	DSPTimings _dsp_timings;
+	framecnt_t _silent_input_frames; ///< how long our input has been silent for, as far as can_skip_run() knows
 };
 
 } // namespace ARDOUR
@@ -43,6 +43,9 @@ public:
 	virtual float playback_buffer_load () const = 0;
 	virtual float capture_buffer_load () const = 0;
 	virtual int do_refill () = 0;
+	virtual int do_refill_with_buffers (Sample*, gain_t*) = 0;
+	virtual std::string disk_read_path () const = 0;
+	virtual std::string disk_write_path () const = 0;
 	virtual int do_flush (RunContext, bool force = false) = 0;
 	virtual void set_pending_overwrite (bool) = 0;
 	virtual int seek (framepos_t, bool complete_refill = false) = 0;
@@ -97,6 +97,7 @@ CONFIG_VARIABLE (float, audio_capture_buffer_seconds, "capture-buffer-seconds",
 CONFIG_VARIABLE (float, audio_playback_buffer_seconds, "playback-buffer-seconds", 5.0)
 CONFIG_VARIABLE (float, midi_track_buffer_seconds, "midi-track-buffer-seconds", 1.0)
 CONFIG_VARIABLE (uint32_t, disk_choice_space_threshold,  "disk-choice-space-threshold", 57600000)
+CONFIG_VARIABLE (uint32_t, butler_worker_threads, "butler-worker-threads", 0)
 CONFIG_VARIABLE (bool, auto_analyse_audio, "auto-analyse-audio", false)
 
 /* OSC */
@@ -212,6 +213,8 @@ CONFIG_VARIABLE_SPECIAL (std::string, default_session_parent_dir, "default-sessi
 #endif
 CONFIG_VARIABLE (bool, allow_special_bus_removal, "allow-special-bus-removal", false)
 CONFIG_VARIABLE (int32_t, processor_usage, "processor-usage", -1)
+CONFIG_VARIABLE (std::string, process_thread_cpus, "process-thread-cpus", "") /* e.g. "0-3,8"; empty for any */
+CONFIG_VARIABLE (bool, process_threads_on_one_socket, "process-threads-on-one-socket", false)
 CONFIG_VARIABLE (gain_t, max_gain, "max-gain", 2.0) /* +6.0dB */
 CONFIG_VARIABLE (uint32_t, max_recent_sessions, "max-recent-sessions", 10)
 CONFIG_VARIABLE (uint32_t, max_recent_templates, "max-recent-templates", 10)
@@ -230,6 +233,7 @@ CONFIG_VARIABLE (bool, use_lxvst, "use-lxvst", true)
 CONFIG_VARIABLE (bool, discover_vst_on_start, "discover-vst-on-start", false)
 CONFIG_VARIABLE (int, vst_scan_timeout, "vst-scan-timeout", 600) /* deciseconds, per plugin, <= 0 no timeout */
 CONFIG_VARIABLE (bool, discover_audio_units, "discover-audio-units", false)
+CONFIG_VARIABLE (uint32_t, plugin_automation_granularity, "plugin-automation-granularity", 64) /* samples, applied when the block size changes */
 
 /* custom user plugin paths */
 CONFIG_VARIABLE (std::string, plugin_path_vst, "plugin-path-vst", "@default@")
@@ -238,8 +242,20 @@ CONFIG_VARIABLE (std::string, plugin_path_lxvst, "plugin-path-lxvst", "@default@
 /* denormal management */
 
 CONFIG_VARIABLE (bool, denormal_protection, "denormal-protection", false)
+CONFIG_VARIABLE (bool, skip_silent_plugins, "skip-silent-plugins", false)
+CONFIG_VARIABLE (float, silent_plugin_tail, "silent-plugin-tail", 10.0) /* seconds, for plugins which do not give their tail length */
 CONFIG_VARIABLE (DenormalModel, denormal_model, "denormal-model", DenormalFTZDAZ)
 
+/* profiling */
+
+CONFIG_VARIABLE (bool, dsp_profiling, "dsp-profiling", false)
+
+/* export */
+
+CONFIG_VARIABLE (bool, parallel_export_normalize, "parallel-export-normalize", false)
+CONFIG_VARIABLE (bool, parallel_export_stems, "parallel-export-stems", false)
+CONFIG_VARIABLE (uint32_t, export_normalize_memory, "export-normalize-memory", 0) /* MB; normalize exports which fit in memory, not through a temporary file */
+
 /* visibility of various things */
 
 
@@ -281,7 +281,12 @@ class LIBARDOUR_API Region
 	virtual boost::shared_ptr<Region> get_parent() const;
 
 	uint64_t layering_index () const { return _layering_index; }
-	void set_layering_index (uint64_t when) { _layering_index = when; }
+	void set_layering_index (uint64_t when) {
+		if (_layering_index != when) {
+			_layering_index = when;
+			bump_state_generation ();
+		}
+	}
 
 	virtual bool is_dependent() const { return false; }
 	virtual bool depends_on (boost::shared_ptr<Region> /*other*/) const { return false; }
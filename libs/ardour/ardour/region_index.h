@@ -0,0 +1,106 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_region_index_h__
+#define __ardour_region_index_h__
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "evoral/Range.hpp"
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class Region;
+
+/** An index of a set of regions by their extent, answering the queries
+ *  that Playlist needs in O(log n) per result rather than by scanning
+ *  every region.
+ *
+ *  Regions are kept sorted by position; the sorted array is treated as an
+ *  implicit balanced binary tree in which each node also records the latest
+ *  last frame in its subtree, so that subtrees which end before a query
+ *  range can be skipped. Separate arrays sorted by first frame, last frame
+ *  and sync position serve the "next region" and "within" queries.
+ *
+ *  An index is a snapshot of the regions' bounds at the time it was built;
+ *  it is up to the owner to build a new one when those bounds change.
+ */
+class LIBARDOUR_API RegionIndex
+{
+  public:
+	RegionIndex (RegionList::const_iterator begin, RegionList::const_iterator end);
+
+	size_t size () const { return _by_start.size(); }
+
+	/** Append to @param result the regions which have some part within
+	 *  @param start to @param end (inclusive), in position order.
+	 */
+	void touched (framepos_t start, framepos_t end, RegionList& result) const;
+
+	/** Append to @param result the regions which cover @param frame, in position order */
+	void at (framepos_t frame, RegionList& result) const {
+		touched (frame, frame, result);
+	}
+
+	uint32_t count_at (framepos_t) const;
+
+	void with_start_within (Evoral::Range<framepos_t>, RegionList& result) const;
+	void with_end_within (Evoral::Range<framepos_t>, RegionList& result) const;
+
+	/** @return the region whose @param point is closest to @param frame,
+	 *  after it if @param dir is 1 or before it otherwise.
+	 */
+	boost::shared_ptr<Region> next (framepos_t frame, RegionPoint point, int dir) const;
+
+  private:
+	struct Entry {
+		Entry (boost::shared_ptr<Region> r, framepos_t f, framepos_t l)
+			: region (r), first (f), last (l) {}
+
+		boost::shared_ptr<Region> region;
+		framepos_t first;
+		framepos_t last;
+	};
+
+	struct Point {
+		Point (framepos_t p, size_t i) : pos (p), index (i) {}
+
+		framepos_t pos;
+		size_t     index; ///< into _by_start
+	};
+
+	std::vector<Entry>      _by_start;
+	std::vector<framepos_t> _max_last;  ///< latest last frame in the subtree rooted at each entry
+	std::vector<Point>      _by_first;
+	std::vector<Point>      _by_last;
+	std::vector<Point>      _by_sync;
+
+	framepos_t build (size_t lo, size_t hi);
+	void touched (size_t lo, size_t hi, framepos_t start, framepos_t end, RegionList& result) const;
+	void within (std::vector<Point> const &, Evoral::Range<framepos_t> const &, RegionList& result) const;
+};
+
+} /* namespace ARDOUR */
+
+#endif /* __ardour_region_index_h__ */
@@ -41,6 +41,7 @@
 #include "pbd/destructible.h"
 
 #include "ardour/ardour.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/instrument_info.h"
 #include "ardour/io.h"
 #include "ardour/libardour_visibility.h"
@@ -286,6 +287,10 @@ class LIBARDOUR_API Route : public SessionObject, public Automatable, public Rou
 	framecnt_t initial_delay() const { return _initial_delay; }
 	framecnt_t signal_latency() const { return _signal_latency; }
 
+	/** Time spent processing this route while DSP profiling is enabled */
+	DSPTimings&       dsp_timings ()       { return _dsp_timings; }
+	DSPTimings const& dsp_timings () const { return _dsp_timings; }
+
 	PBD::Signal0<void>       active_changed;
 	PBD::Signal0<void>       phase_invert_changed;
 	PBD::Signal0<void>       denormal_protection_changed;
@@ -356,6 +361,11 @@ class LIBARDOUR_API Route : public SessionObject, public Automatable, public Rou
 	 */
 	bool direct_feeds_according_to_reality (boost::shared_ptr<Route>, bool* via_send_only = 0);
 
+	/** @return true if the port belongs to this route's input or output,
+	 *  or to the IO of one of its sends, returns or inserts.
+	 */
+	bool has_port (boost::shared_ptr<Port>) const;
+
 	/**
 	 * return true if this route feeds the first argument directly, via
 	 * either its main outs or a send, according to the graph that
@@ -515,6 +525,7 @@ class LIBARDOUR_API Route : public SessionObject, public Automatable, public Rou
 	framecnt_t     _signal_latency;
 	framecnt_t     _signal_latency_at_amp_position;
 	framecnt_t     _signal_latency_at_trim_position;
+	DSPTimings     _dsp_timings;
 	framecnt_t     _initial_delay;
 	framecnt_t     _roll_delay;
 
@@ -45,7 +45,10 @@ public:
 	void add (GraphVertex from, GraphVertex to, bool via_sends_only);
 	bool has (GraphVertex from, GraphVertex to, bool* via_sends_only);
 	std::set<GraphVertex> from (GraphVertex r) const;
+	std::set<GraphVertex> to (GraphVertex r) const;
 	void remove (GraphVertex from, GraphVertex to);
+	void remove_vertex (GraphVertex);
+	void add_component (GraphVertex, std::set<GraphVertex>& component) const;
 	bool has_none_to (GraphVertex to) const;
 	bool empty () const;
 	void dump () const;
@@ -32,12 +32,50 @@ namespace ARDOUR {
 	typedef void  (*mix_buffers_no_gain_t)		(ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t);
 	typedef void  (*copy_vector_t)			    (ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t);
 
+	typedef gain_t (*apply_gain_ramp_t)             (ARDOUR::Sample *, pframes_t, gain_t, gain_t, gain_t);
+	typedef void  (*apply_gain_vector_t)            (ARDOUR::Sample *, const gain_t *, pframes_t);
+	typedef void  (*mix_buffers_with_gain_vector_t) (ARDOUR::Sample *, const ARDOUR::Sample *, const gain_t *, pframes_t);
+	typedef void  (*interleave_t)                   (ARDOUR::Sample *, const ARDOUR::Sample *, pframes_t, uint32_t);
+	typedef void  (*float_to_int16_t)               (int16_t *, const ARDOUR::Sample *, pframes_t);
+	typedef void  (*int16_to_float_t)               (ARDOUR::Sample *, const int16_t *, pframes_t);
+	typedef void  (*float_to_int32_t)               (int32_t *, const ARDOUR::Sample *, pframes_t);
+	typedef void  (*int32_to_float_t)               (ARDOUR::Sample *, const int32_t *, pframes_t);
+
 	LIBARDOUR_API extern compute_peak_t		compute_peak;
 	LIBARDOUR_API extern find_peaks_t               find_peaks;
 	LIBARDOUR_API extern apply_gain_to_buffer_t	apply_gain_to_buffer;
 	LIBARDOUR_API extern mix_buffers_with_gain_t	mix_buffers_with_gain;
 	LIBARDOUR_API extern mix_buffers_no_gain_t	mix_buffers_no_gain;
 	LIBARDOUR_API extern copy_vector_t			copy_vector;
+
+	/** Apply a gain which moves from the first to the second gain_t by a
+	 *  one-pole smoother with the given coefficient, as Amp does when
+	 *  declicking; returns the gain reached.
+	 */
+	LIBARDOUR_API extern apply_gain_ramp_t              apply_gain_ramp;
+	/** Multiply by a gain per sample (automation, envelopes, fades) */
+	LIBARDOUR_API extern apply_gain_vector_t            apply_gain_vector;
+	/** Multiply by one minus a gain per sample (the other side of a fade) */
+	LIBARDOUR_API extern apply_gain_vector_t            apply_inverse_gain_vector;
+	LIBARDOUR_API extern mix_buffers_with_gain_vector_t mix_buffers_with_gain_vector;
+
+	/** Copy a mono buffer into one channel of an interleaved buffer, given
+	 *  a pointer to that channel's first sample and the channel count.
+	 */
+	LIBARDOUR_API extern interleave_t                   interleave;
+	/** Copy one channel out of an interleaved buffer, the reverse of interleave */
+	LIBARDOUR_API extern interleave_t                   deinterleave;
+
+	/* conversion to and from integer samples, scaled by the largest
+	   positive value, clipped, and truncated towards zero; 24 bit samples
+	   are held in the low bits of an int32_t.
+	*/
+	LIBARDOUR_API extern float_to_int16_t               float_to_int16;
+	LIBARDOUR_API extern int16_to_float_t               int16_to_float;
+	LIBARDOUR_API extern float_to_int32_t               float_to_int24;
+	LIBARDOUR_API extern int32_to_float_t               int24_to_float;
+	LIBARDOUR_API extern float_to_int32_t               float_to_int32;
+	LIBARDOUR_API extern int32_to_float_t               int32_to_float;
 }
 
 #endif /* __ardour_runtime_functions_h__ */
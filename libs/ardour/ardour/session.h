@@ -31,6 +31,7 @@
 
 #include <boost/dynamic_bitset.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/utility.hpp>
 
@@ -55,6 +56,7 @@
 #include "ardour/ardour.h"
 #include "ardour/chan_count.h"
 #include "ardour/delivery.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/interthread_info.h"
 #include "ardour/rc_configuration.h"
 #include "ardour/session_configuration.h"
@@ -416,6 +418,15 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	framecnt_t worst_input_latency ()  const { return _worst_input_latency; }
 	framecnt_t worst_track_latency ()  const { return _worst_track_latency; }
 	framecnt_t worst_playback_latency () const { return _worst_output_latency + _worst_track_latency; }
+
+	/* DSP profiling (see DSPProfiler).  Routes and processors keep
+	   their own timings; these are for the process graph, and are
+	   empty when there is no graph.
+	*/
+	DSPTimingStats critical_path_stats () const;
+	void process_thread_idle_stats (std::vector<DSPTimingStats>&) const;
+	/** Clear the timings of the graph and of every route and processor */
+	void reset_dsp_timings ();
 	
 	struct SaveAs {
 		std::string new_parent_folder;  /* parent folder where new session folder will be created */
@@ -517,6 +528,24 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 		Session * _session;
 	};
 
+	/** While one of these exists, resorts of the routes are put off, and
+	 *  one is done (if any were asked for) when the last one goes away.
+	 *  For operations which change many connections at once.
+	 */
+	class RouteGraphBatch {
+	  public:
+		RouteGraphBatch (Session* s) : _session (s) {
+			g_atomic_int_inc (&s->_route_graph_batch);
+		}
+		~RouteGraphBatch () {
+			if (g_atomic_int_dec_and_test (&_session->_route_graph_batch)) {
+				_session->resort_routes_if_deferred ();
+			}
+		}
+	  private:
+		Session* _session;
+	};
+
 	void add_route_group (RouteGroup *);
 	void remove_route_group (RouteGroup&);
 	void reorder_route_groups (std::list<RouteGroup*>);
@@ -1242,6 +1271,21 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	volatile bool   _save_queued;
 	Glib::Threads::Mutex save_state_lock;
 
+	/* pending (capture/auto) saves are written out by this thread,
+	   so that the caller does not wait for the disk; held by
+	   save_state_lock.
+	*/
+	Glib::Threads::Thread* _state_write_thread;
+	void wait_for_state_write ();
+	void write_state_in_background (XMLTree*, std::string tmp_path, std::string xml_path, uint32_t pending_file_generation);
+
+	/* bumped by remove_pending_capture_state(), so that a pending save
+	   started before the removal is not renamed into place after it;
+	   both are done with _pending_file_lock held.
+	*/
+	Glib::Threads::Mutex _pending_file_lock;
+	uint32_t             _pending_file_generation;
+
 	int      load_options (const XMLNode&);
 	int      load_state (std::string snapshot_name);
 
@@ -1511,6 +1555,26 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 
 	SerializedRCUManager<RouteList>  routes;
 
+	/** Indexes of routes for route_by_id(), route_by_name() and
+	 *  route_by_remote_id(), which control surfaces call for every message.
+	 *  They are rebuilt when routes are added or removed, or a route is
+	 *  renamed or given a new remote control ID, and read without locking
+	 *  as routes is.
+	 */
+	struct RouteLookup {
+		typedef boost::unordered_map<PBD::ID, boost::shared_ptr<Route> > ByID;
+		typedef boost::unordered_map<std::string, boost::shared_ptr<Route> > ByName;
+		typedef boost::unordered_map<uint32_t, boost::shared_ptr<Route> > ByRemoteID;
+
+		ByID       by_id;
+		ByName     by_name;
+		ByRemoteID by_remote_id;
+	};
+
+	SerializedRCUManager<RouteLookup> _route_lookup;
+	void rebuild_route_lookup ();
+	void route_lookup_property_changed (PBD::PropertyChange const &);
+
 	void add_routes (RouteList&, bool input_auto_connect, bool output_auto_connect, bool save);
 	void add_routes_inner (RouteList&, bool input_auto_connect, bool output_auto_connect);
 	bool _adding_routes_in_progress;
@@ -1522,7 +1586,7 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	boost::shared_ptr<Route> XMLRouteFactory (const XMLNode&, int);
 	boost::shared_ptr<Route> XMLRouteFactory_2X (const XMLNode&, int);
 
-	void route_processors_changed (RouteProcessorChange);
+	void route_processors_changed (RouteProcessorChange, boost::weak_ptr<Route>);
 
 	bool find_route_name (std::string const &, uint32_t& id, std::string& name, bool);
 	void count_existing_track_channels (ChanCount& in, ChanCount& out);
@@ -1817,6 +1881,34 @@ class LIBARDOUR_API Session : public PBD::StatefulDestructible, public PBD::Scop
 	*/
 	GraphEdges _current_route_graph;
 
+	/** The directed graph of routes according to their current connections,
+	    which may contain feedback.  This is kept from one resort to the next,
+	    and only the edges of routes which have changed are found again.
+	*/
+	GraphEdges _route_graph_edges;
+	/** the routes that _route_graph_edges was built for */
+	std::set<GraphVertex> _route_graph_vertices;
+	/** true if the last resort found feedback, so that the routes' fed-by
+	    lists were not fully traced.
+	*/
+	bool _route_graph_feedback;
+
+	/* changes to the route graph noted since the last resort; these may
+	   come from the backend's threads, so they are protected by a lock.
+	*/
+	Glib::Threads::Mutex _route_graph_changes_lock;
+	std::set<boost::weak_ptr<Route> > _route_graph_changed_routes;
+	std::vector<boost::weak_ptr<Port> > _route_graph_changed_ports;
+	/** true if a resort was asked for during a RouteGraphBatch */
+	bool _route_graph_resort_deferred;
+	friend class RouteGraphBatch;
+	gint _route_graph_batch; /* atomic */
+
+	void route_graph_changed (boost::weak_ptr<Route>);
+	void route_graph_ports_changed (boost::weak_ptr<Port>, boost::weak_ptr<Port>);
+	void update_route_graph_edges (boost::shared_ptr<RouteList>, std::set<GraphVertex>& changed);
+	void resort_routes_if_deferred ();
+
 	uint32_t next_control_id () const;
 	int32_t _order_hint;
 	bool ignore_route_processor_changes;
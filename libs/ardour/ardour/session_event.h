@@ -24,6 +24,7 @@
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include "pbd/mpsc_queue.h"
 #include "pbd/pool.h"
 #include "pbd/ringbuffer.h"
 #include "pbd/event_loop.h"
@@ -151,15 +152,22 @@ private:
 class SessionEventManager {
 public:
 	SessionEventManager () : pending_events (2048),
-	                         auto_loop_event(0), punch_out_event(0), punch_in_event(0) {}
+	                         auto_loop_event(0), punch_out_event(0), punch_in_event(0),
+	                         _events_processed (0), _events_processed_last_cycle (0), _events_queued_last_cycle (0) {}
 	virtual ~SessionEventManager() {}
 
 	virtual void queue_event (SessionEvent *ev) = 0;
 	void clear_events (SessionEvent::Type type);
 	void clear_events (SessionEvent::Type type, boost::function<void (void)> after);
 
+	/** @return number of events processed during the last process cycle */
+	uint32_t events_processed_last_cycle () const { return g_atomic_int_get (&_events_processed_last_cycle); }
+	/** @return number of events waiting in the queue at the start of the last process cycle */
+	uint32_t events_queued_last_cycle () const { return g_atomic_int_get (&_events_queued_last_cycle); }
+
 protected:
-	RingBuffer<SessionEvent*> pending_events;
+	/* written by any thread, read by the process thread */
+	PBD::MPSCQueue<SessionEvent*> pending_events;
 	typedef std::list<SessionEvent *> Events;
 	Events           events;
 	Events           immediate_events;
@@ -171,7 +179,11 @@ protected:
 	SessionEvent *punch_out_event;
 	SessionEvent *punch_in_event;
 
+	/* process thread only */
+	uint32_t _events_processed;
+
 	void dump_events () const;
+	void merge_pending_events ();
 	void merge_event (SessionEvent*);
 	void replace_event (SessionEvent::Type, framepos_t action_frame, framepos_t target = 0);
 	bool _replace_event (SessionEvent*);
@@ -183,6 +195,10 @@ protected:
 
 	virtual void process_event(SessionEvent*) = 0;
 	virtual void set_next_event () = 0;
+
+private:
+	mutable gint _events_processed_last_cycle;
+	mutable gint _events_queued_last_cycle;
 };
 
 } /* namespace */
@@ -58,6 +58,8 @@ class LIBARDOUR_API SessionObject : public SessionHandleRef, public PBD::Statefu
 	virtual bool set_name (const std::string& str) {
 		if (_name != str) {
 			_name = str;
+			/* PropertyChanged is emitted directly, not by send_change() */
+			bump_state_generation ();
 			PropertyChanged (PBD::PropertyChange (Properties::name));
 		}
 		return true;
@@ -84,6 +84,9 @@ public:
 	mutable framepos_t _smf_last_read_end;
 	/** time (in SMF ticks, 1 tick per _ppqn) of the last event read by read_unlocked */
 	mutable framepos_t _smf_last_read_time;
+	/** scratch space for the events read by read_unlocked, kept between calls */
+	mutable uint8_t*   _read_buffer;
+	mutable uint32_t   _read_buffer_size;
 
 	int open_for_write ();
 	
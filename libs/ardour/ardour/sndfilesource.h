@@ -90,6 +90,15 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 	SF_INFO _info;
 	BroadcastInfo *_broadcast_info;
 
+	/** The most recently read block of a multichannel file, shared by
+	 *  the sources for each of its channels so that a block is only read
+	 *  (and decoded) once however many of its channels are in use.
+	 */
+	class InterleaveCache;
+	boost::shared_ptr<InterleaveCache> _interleave_cache;
+
+	framecnt_t read_interleaved (Sample *dst, framepos_t start, framecnt_t cnt) const;
+
 	void init_sndfile ();
 	int open();
 	int setup_broadcast_info (framepos_t when, struct tm&, time_t);
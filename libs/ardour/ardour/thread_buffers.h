@@ -36,6 +36,7 @@ public:
 	~ThreadBuffers ();
 
 	void ensure_buffers (ChanCount howmany = ChanCount::ZERO, size_t custom = 0);
+	void reallocate ();
 
 	BufferSet* silent_buffers;
 	BufferSet* scratch_buffers;
@@ -49,6 +50,8 @@ public:
 
 private:
 	void allocate_pan_automation_buffers (framecnt_t nframes, uint32_t howmany, bool force);
+
+	size_t _automation_buffer_size;
 };
 
 } // namespace
@@ -128,6 +128,9 @@ class LIBARDOUR_API Track : public Route, public PublicDiskstream
 	float playback_buffer_load () const;
 	float capture_buffer_load () const;
 	int do_refill ();
+	int do_refill_with_buffers (Sample*, gain_t*);
+	std::string disk_read_path () const;
+	std::string disk_write_path () const;
 	int do_flush (RunContext, bool force = false);
 	void set_pending_overwrite (bool);
 	int seek (framepos_t, bool complete_refill = false);
@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cmath>
 
 #if __APPLE__
@@ -173,6 +174,17 @@ LIBARDOUR_API bool matching_unsuffixed_filename_exists_in (const std::string& di
 
 LIBARDOUR_API uint32_t how_many_dsp_threads ();
 
+/** @return the CPUs that the process threads should run on, one thread
+ *  to each, or an empty list to leave them wherever the scheduler likes.
+ */
+LIBARDOUR_API std::vector<uint32_t> process_thread_cpus ();
+
+/** @return the CPUs that other busy threads, such as the butler, should
+ *  keep to so as to stay out of the process threads' way, or an empty
+ *  list for any CPU.
+ */
+LIBARDOUR_API std::vector<uint32_t> non_process_thread_cpus ();
+
 #if __APPLE__
 LIBARDOUR_API std::string CFStringRefToStdString(CFStringRef stringRef);
 #endif // __APPLE__
@@ -50,6 +50,7 @@ public:
 	int get_parameter_descriptor (uint32_t which, ParameterDescriptor&) const;
 	std::string describe_parameter (Evoral::Parameter);
 	framecnt_t signal_latency() const;
+	framecnt_t tail_length () const { return _tail_length; }
 	std::set<Evoral::Parameter> automatable() const;
 
 	bool parameter_is_audio (uint32_t) const { return false; }
@@ -95,6 +96,7 @@ protected:
 	VSTHandle* _handle;
 	VSTState*  _state;
 	AEffect*   _plugin;
+	framecnt_t _tail_length; ///< as the plugin gave it when last activated, or -1
 
 	MidiBuffer* _midi_out_buf;
 };
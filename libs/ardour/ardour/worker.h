@@ -22,15 +22,14 @@
 
 #include <stdint.h>
 
-#include <glibmm/threads.h>
-
 #include "pbd/ringbuffer.h"
-#include "pbd/semaphore.h"
 
 #include "ardour/libardour_visibility.h"
 
 namespace ARDOUR {
 
+class WorkerPool;
+
 /**
    An object that needs to schedule non-RT work in the audio thread.
 */
@@ -50,7 +49,11 @@ public:
 };
 
 /**
-   A worker thread for non-realtime tasks scheduled in the audio thread.
+   A queue of non-realtime tasks scheduled in the audio thread.
+
+   The work is done by a pool of threads, sized to the number of cores, which
+   is shared by all Workers; each Worker's requests are handled one at a
+   time, and in the order in which they were scheduled.
 */
 class LIBARDOUR_API Worker
 {
@@ -76,7 +79,19 @@ public:
 	void emit_responses();
 
 private:
-	void run();
+	friend class WorkerPool;
+
+	/**
+	   Do all complete requests that are pending (pool thread).
+	   @param buf per-thread buffer for the request body, grown as needed.
+	*/
+	void run(void*& buf, size_t& buf_size);
+
+	/**
+	   @return true if a complete request is waiting to be done.
+	*/
+	bool have_request();
+
 	/**
 	   Peek in RB, get size and check if a block of 'size' is available.
 
@@ -92,10 +107,8 @@ private:
 	RingBuffer<uint8_t>*   _requests;
 	RingBuffer<uint8_t>*   _responses;
 	uint8_t*               _response;
-	PBD::Semaphore         _sem;
-	bool                   _exit;
-	Glib::Threads::Thread* _thread;
-
+	WorkerPool*            _pool;
+	bool                   _busy; ///< a pool thread is doing our requests; protected by the pool's lock
 };
 
 } // namespace ARDOUR
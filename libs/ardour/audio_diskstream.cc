@@ -2244,6 +2244,18 @@ AudioDiskstream::remove_channel (uint32_t how_many)
 	return remove_channel_from (c, how_many);
 }
 
+string
+AudioDiskstream::disk_write_path () const
+{
+	boost::shared_ptr<ChannelList> c = channels.reader();
+
+	if (!c->empty() && c->front()->write_source) {
+		return c->front()->write_source->path ();
+	}
+
+	return Diskstream::disk_write_path ();
+}
+
 float
 AudioDiskstream::playback_buffer_load () const
 {
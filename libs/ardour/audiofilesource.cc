@@ -154,6 +154,7 @@ AudioFileSource::~AudioFileSource ()
 	if (removable()) {
 		::g_unlink (_path.c_str());
 		::g_unlink (peakpath.c_str());
+		::g_unlink (peak_levels_path().c_str());
 	}
 }
 
@@ -325,6 +326,8 @@ AudioFileSource::mark_streaming_write_completed (const Lock& lock)
 int
 AudioFileSource::move_dependents_to_trash()
 {
+	drop_peakfile_map ();
+	::g_unlink (peak_levels_path().c_str());
 	return ::g_unlink (peakpath.c_str());
 }
 
@@ -404,6 +404,16 @@ AudioRegion::listen_to_my_curves ()
 	_envelope->StateChanged.connect_same_thread (*this, boost::bind (&AudioRegion::envelope_changed, this));
 	_fade_in->StateChanged.connect_same_thread (*this, boost::bind (&AudioRegion::fade_in_changed, this));
 	_fade_out->StateChanged.connect_same_thread (*this, boost::bind (&AudioRegion::fade_out_changed, this));
+
+	/* not every edit of a curve emits StateChanged, but all of them
+	   mark it dirty; either way our state has changed.
+	*/
+
+	_envelope->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::bump_state_generation, this));
+	_fade_in->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::bump_state_generation, this));
+	_fade_out->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::bump_state_generation, this));
+	_inverse_fade_in->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::bump_state_generation, this));
+	_inverse_fade_out->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::bump_state_generation, this));
 }
 
 void
@@ -589,14 +599,10 @@ AudioRegion::read_at (Sample *buf, Sample *mixdown_buffer, float *gain_buffer,
 		_envelope->curve().get_vector (internal_offset, internal_offset + to_read, gain_buffer, to_read);
 
 		if (_scale_amplitude != 1.0f) {
-			for (framecnt_t n = 0; n < to_read; ++n) {
-				mixdown_buffer[n] *= gain_buffer[n] * _scale_amplitude;
-			}
-		} else {
-			for (framecnt_t n = 0; n < to_read; ++n) {
-				mixdown_buffer[n] *= gain_buffer[n];
-			}
+			apply_gain_to_buffer (gain_buffer, to_read, _scale_amplitude);
 		}
+
+		apply_gain_vector (mixdown_buffer, gain_buffer, to_read);
 	} else if (_scale_amplitude != 1.0f) {
 		apply_gain_to_buffer (mixdown_buffer, to_read, _scale_amplitude);
 	}
@@ -620,9 +626,7 @@ AudioRegion::read_at (Sample *buf, Sample *mixdown_buffer, float *gain_buffer,
 				_inverse_fade_in->curve().get_vector (internal_offset, internal_offset + fade_in_limit, gain_buffer, fade_in_limit);
 				
 				/* Fade the data from lower layers out */
-				for (framecnt_t n = 0; n < fade_in_limit; ++n) {
-					buf[n] *= gain_buffer[n];
-				}
+				apply_gain_vector (buf, gain_buffer, fade_in_limit);
 				
 				/* refill gain buffer with the fade in */
 				
@@ -636,18 +640,14 @@ AudioRegion::read_at (Sample *buf, Sample *mixdown_buffer, float *gain_buffer,
 				
 				_fade_in->curve().get_vector (internal_offset, internal_offset + fade_in_limit, gain_buffer, fade_in_limit);
 				
-				for (framecnt_t n = 0; n < fade_in_limit; ++n) {
-					buf[n] *= 1 - gain_buffer[n];
-				}
+				apply_inverse_gain_vector (buf, gain_buffer, fade_in_limit);
 			}
 		} else {
 			_fade_in->curve().get_vector (internal_offset, internal_offset + fade_in_limit, gain_buffer, fade_in_limit);
 		}
 
 		/* Mix our newly-read data in, with the fade */
-		for (framecnt_t n = 0; n < fade_in_limit; ++n) {
-			buf[n] += mixdown_buffer[n] * gain_buffer[n];
-		}
+		mix_buffers_with_gain_vector (buf, mixdown_buffer, gain_buffer, fade_in_limit);
 	}
 
 	if (fade_out_limit != 0) {
@@ -660,9 +660,7 @@ AudioRegion::read_at (Sample *buf, Sample *mixdown_buffer, float *gain_buffer,
 				_inverse_fade_out->curve().get_vector (curve_offset, curve_offset + fade_out_limit, gain_buffer, fade_out_limit);
 				
 				/* Fade the data from lower levels in */
-				for (framecnt_t n = 0, m = fade_out_offset; n < fade_out_limit; ++n, ++m) {
-					buf[m] *= gain_buffer[n];
-				}
+				apply_gain_vector (buf + fade_out_offset, gain_buffer, fade_out_limit);
 				
 				/* fetch the actual fade out */
 
@@ -677,9 +675,7 @@ AudioRegion::read_at (Sample *buf, Sample *mixdown_buffer, float *gain_buffer,
 				
 				_fade_out->curve().get_vector (curve_offset, curve_offset + fade_out_limit, gain_buffer, fade_out_limit);
 				
-				for (framecnt_t n = 0, m = fade_out_offset; n < fade_out_limit; ++n, ++m) {
-					buf[m] *= 1 - gain_buffer[n];
-				}
+				apply_inverse_gain_vector (buf + fade_out_offset, gain_buffer, fade_out_limit);
 			}
 		} else {
 			_fade_out->curve().get_vector (curve_offset, curve_offset + fade_out_limit, gain_buffer, fade_out_limit);
@@ -688,9 +684,7 @@ AudioRegion::read_at (Sample *buf, Sample *mixdown_buffer, float *gain_buffer,
 		/* Mix our newly-read data with whatever was already there,
 		   with the fade out applied to our data.
 		*/
-		for (framecnt_t n = 0, m = fade_out_offset; n < fade_out_limit; ++n, ++m) {
-			buf[m] += mixdown_buffer[m] * gain_buffer[n];
-		}
+		mix_buffers_with_gain_vector (buf + fade_out_offset, mixdown_buffer + fade_out_offset, gain_buffer, fade_out_limit);
 	}
 	
 	/* MIX OR COPY THE REGION BODY FROM mixdown_buffer INTO buf */
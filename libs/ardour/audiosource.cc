@@ -50,10 +50,10 @@
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
-#include "pbd/scoped_file_descriptor.h"
 #include "pbd/xml++.h"
 
 #include "ardour/audiosource.h"
+#include "ardour/filename_extensions.h"
 #include "ardour/rc_configuration.h"
 #include "ardour/runtime_functions.h"
 
@@ -75,6 +75,286 @@ bool AudioSource::_build_peakfiles = false;
 
 #define _FPP 256
 
+namespace {
+
+/* The peakfile levels sidecar holds levels 1 .. peak_levels, where level n
+   has one peak for every 4^n peaks of the peakfile itself (level 0). It is
+   made up of blocks, each covering 4^peak_levels level 0 peaks and holding
+   the peaks of every level for that range, finest first, so that it only
+   grows at the end as peaks are computed.
+*/
+
+const uint32_t peak_levels = 5;
+const uint32_t peak_level_bits = 2;
+
+/** @return number of level @param n peaks in each block */
+inline framecnt_t
+level_block_peaks (uint32_t n)
+{
+	return (framecnt_t) 1 << (peak_level_bits * (peak_levels - n));
+}
+
+/** @return offset of peak @param p of level @param n in the sidecar */
+off_t
+level_peak_byte (uint32_t n, framepos_t p)
+{
+	framecnt_t block = 0;
+	framecnt_t before = 0;
+
+	for (uint32_t l = 1; l <= peak_levels; ++l) {
+		if (l < n) {
+			before += level_block_peaks (l);
+		}
+		block += level_block_peaks (l);
+	}
+
+	const framecnt_t per_block = level_block_peaks (n);
+
+	return ((p / per_block) * block + before + (p % per_block)) * sizeof (PeakData);
+}
+
+/** Reduce @param n peaks from @param src to (n + 3) / 4 peaks in @param dst */
+void
+reduce_peaks (PeakData const * src, framecnt_t n, PeakData* dst)
+{
+	const framecnt_t factor = 1 << peak_level_bits;
+
+	for (framecnt_t i = 0; i < n; i += factor, ++dst) {
+
+		dst->max = src[i].max;
+		dst->min = src[i].min;
+
+		for (framecnt_t j = i + 1; j < min (n, i + factor); ++j) {
+			dst->max = max (dst->max, src[j].max);
+			dst->min = min (dst->min, src[j].min);
+		}
+	}
+}
+
+/** Read or write @param n peaks of level @param level, starting at peak
+ *  @param first, in the peakfile (for level 0) or sidecar open on @param fd.
+ *  Peaks beyond the end of the file read as silence.
+ *  @return 0 on success.
+ */
+int
+level_io (int fd, uint32_t level, framepos_t first, PeakData* buf, framecnt_t n, bool writing)
+{
+	while (n) {
+
+		framecnt_t run = n;
+		off_t byte = first * sizeof (PeakData);
+
+		if (level) {
+			const framecnt_t per_block = level_block_peaks (level);
+			run = min (n, per_block - (first % per_block));
+			byte = level_peak_byte (level, first);
+		}
+
+		if (lseek (fd, byte, SEEK_SET) != byte) {
+			return -1;
+		}
+
+		const ssize_t bytes = run * sizeof (PeakData);
+
+		if (writing) {
+			if (::write (fd, buf, bytes) != bytes) {
+				return -1;
+			}
+		} else {
+			const ssize_t got = ::read (fd, buf, bytes);
+			if (got < 0) {
+				return -1;
+			}
+			memset ((char*) buf + got, 0, bytes - got);
+		}
+
+		first += run;
+		buf += run;
+		n -= run;
+	}
+
+	return 0;
+}
+
+}
+
+/** A read-only mapping of the whole of a peakfile. The file descriptor is
+ *  kept open for the life of the map, and the mapping is only replaced when
+ *  the file has grown beyond it (e.g. during capture).
+ */
+class AudioSource::PeakFileMap
+{
+  public:
+	PeakFileMap (string const & path)
+		: _path (path)
+		, _fd (-1)
+		, _addr (0)
+		, _length (0)
+#ifdef PLATFORM_WINDOWS
+		, _map_handle (NULL)
+#endif
+	{}
+
+	~PeakFileMap ()
+	{
+		unmap ();
+		if (_fd >= 0) {
+			::close (_fd);
+		}
+	}
+
+	off_t map (off_t bytes);
+	off_t length () const { return _length; }
+
+	/** @return a pointer to @param n peaks starting at @param first_byte,
+	 *  or 0 if they are not all mapped.
+	 */
+	PeakData const * peaks (off_t first_byte, framecnt_t n) const {
+		if (!_addr || first_byte < 0 || first_byte + (off_t) (n * sizeof (PeakData)) > _length) {
+			return 0;
+		}
+		return reinterpret_cast<PeakData const *> (_addr + first_byte);
+	}
+
+	/** Copy @param n peaks starting at @param first_byte to @param dst,
+	 *  zero-filling any which are not (yet) in the file.
+	 */
+	void copy (PeakData* dst, off_t first_byte, framecnt_t n) const {
+		off_t avail = 0;
+		if (_addr && first_byte >= 0 && first_byte < _length) {
+			avail = min ((off_t) (n * sizeof (PeakData)), _length - first_byte) / sizeof (PeakData);
+			memcpy (dst, _addr + first_byte, avail * sizeof (PeakData));
+		}
+		if (avail < n) {
+			memset (dst + avail, 0, (n - avail) * sizeof (PeakData));
+		}
+	}
+
+	/** As copy(), for @param n peaks of @param level from a levels sidecar */
+	void copy_level (PeakData* dst, uint32_t level, framepos_t first, framecnt_t n) const {
+		const framecnt_t per_block = level_block_peaks (level);
+		while (n) {
+			const framecnt_t run = min (n, per_block - (first % per_block));
+			copy (dst, level_peak_byte (level, first), run);
+			first += run;
+			dst += run;
+			n -= run;
+		}
+	}
+
+  private:
+	string _path;
+	int    _fd;
+	char*  _addr;
+	off_t  _length;
+#ifdef PLATFORM_WINDOWS
+	HANDLE _map_handle;
+#endif
+
+	void unmap ();
+};
+
+/** Make sure that at least @param bytes of the file are mapped, or all of it
+ *  if it is shorter than that.
+ *  @return number of bytes mapped, or -1 on error.
+ */
+off_t
+AudioSource::PeakFileMap::map (off_t bytes)
+{
+	if (_addr && _length >= bytes) {
+		return _length;
+	}
+
+	if (_fd < 0) {
+		if ((_fd = ::open (_path.c_str(), O_RDONLY)) < 0) {
+			error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), _path, strerror (errno)) << endmsg;
+			return -1;
+		}
+	}
+
+	struct stat statbuf;
+
+	if (fstat (_fd, &statbuf) != 0) {
+		error << string_compose (_("Cannot open peakfile @ %1 for size check (%2)"), _path, strerror (errno)) << endmsg;
+		return -1;
+	}
+
+	if (statbuf.st_size == _length) {
+		/* nothing more has been written since we last looked */
+		return _length;
+	}
+
+	if (statbuf.st_size == 0) {
+		unmap ();
+		return 0;
+	}
+
+#ifdef PLATFORM_WINDOWS
+	unmap ();
+
+	_map_handle = CreateFileMapping ((HANDLE) _get_osfhandle (_fd), NULL, PAGE_READONLY, 0, 0, NULL);
+	if (_map_handle == NULL) {
+		error << string_compose (_("map failed - could not create file mapping for peakfile %1."), _path) << endmsg;
+		return -1;
+	}
+
+	LPVOID view_handle = MapViewOfFile (_map_handle, FILE_MAP_READ, 0, 0, 0);
+	if (view_handle == NULL) {
+		error << string_compose (_("map failed - could not map peakfile %1."), _path) << endmsg;
+		unmap ();
+		return -1;
+	}
+
+	_addr = (char*) view_handle;
+#else
+	void* addr;
+
+#ifdef __linux__
+	if (_addr) {
+		addr = mremap (_addr, _length, statbuf.st_size, MREMAP_MAYMOVE);
+	} else
+#endif
+	{
+		unmap ();
+		addr = mmap (0, statbuf.st_size, PROT_READ, MAP_SHARED, _fd, 0);
+	}
+
+	if (addr == MAP_FAILED) {
+		error << string_compose (_("map failed - could not mmap peakfile %1."), _path) << endmsg;
+		unmap ();
+		return -1;
+	}
+
+	_addr = (char*) addr;
+#endif
+
+	_length = statbuf.st_size;
+
+	return _length;
+}
+
+void
+AudioSource::PeakFileMap::unmap ()
+{
+#ifdef PLATFORM_WINDOWS
+	if (_addr) {
+		if (!UnmapViewOfFile (_addr)) {
+			error << string_compose (_("unmap failed - could not unmap peakfile %1."), _path) << endmsg;
+		}
+	}
+	if (_map_handle != NULL) {
+		CloseHandle (_map_handle);
+		_map_handle = NULL;
+	}
+#else
+	if (_addr) {
+		munmap (_addr, _length);
+	}
+#endif
+	_addr = 0;
+	_length = 0;
+}
+
 AudioSource::AudioSource (Session& s, string name)
 	: Source (s, DataType::AUDIO, name)
 	, _length (0)
@@ -84,6 +364,12 @@ AudioSource::AudioSource (Session& s, string name)
 	, peak_leftover_cnt (0)
 	, peak_leftover_size (0)
 	, peak_leftovers (0)
+	, _peak_map (0)
+	, _peak_levels_map (0)
+	, _peak_levels_valid (false)
+	, _peak_levels_failed (false)
+	, _peak_levels_fd (-1)
+	, _peak_levels_byte_max (0)
 	, _first_run (true)
 	, _last_scale (0.0)
 	, _last_map_off (0)
@@ -100,6 +386,12 @@ AudioSource::AudioSource (Session& s, const XMLNode& node)
 	, peak_leftover_cnt (0)
 	, peak_leftover_size (0)
 	, peak_leftovers (0)
+	, _peak_map (0)
+	, _peak_levels_map (0)
+	, _peak_levels_valid (false)
+	, _peak_levels_failed (false)
+	, _peak_levels_fd (-1)
+	, _peak_levels_byte_max (0)
 	, _first_run (true)
 	, _last_scale (0.0)
 	, _last_map_off (0)
@@ -123,6 +415,13 @@ AudioSource::~AudioSource ()
 		_peakfile_fd = -1;
 	}
 
+	if ((-1) != _peak_levels_fd) {
+		close (_peak_levels_fd);
+		_peak_levels_fd = -1;
+	}
+
+	delete _peak_map;
+	delete _peak_levels_map;
 	delete [] peak_leftovers;
 }
 
@@ -222,6 +521,8 @@ AudioSource::rename_peakfile (string newpath)
 
 	string oldpath = peakpath;
 
+	drop_peakfile_map ();
+
 	if (Glib::file_test (oldpath, Glib::FILE_TEST_EXISTS)) {
 		if (g_rename (oldpath.c_str(), newpath.c_str()) != 0) {
 			error << string_compose (_("cannot rename peakfile for %1 from %2 to %3 (%4)"), _name, oldpath, newpath, strerror (errno)) << endmsg;
@@ -231,6 +532,17 @@ AudioSource::rename_peakfile (string newpath)
 
 	peakpath = newpath;
 
+	string const old_levels = oldpath + peakfile_levels_suffix;
+
+	if (Glib::file_test (old_levels, Glib::FILE_TEST_EXISTS)) {
+		if (g_rename (old_levels.c_str(), peak_levels_path().c_str()) != 0) {
+			/* not fatal, they will be rebuilt when needed */
+			::g_unlink (old_levels.c_str());
+			Glib::Threads::Mutex::Lock pm (_peak_map_lock);
+			_peak_levels_valid = false;
+		}
+	}
+
 	return 0;
 }
 
@@ -300,6 +612,14 @@ AudioSource::initialize_peakfile (string audio_path)
 		}
 	}
 
+	if (_peaks_built) {
+		/* the levels can only be used if they were written with, or since, the peakfile */
+		struct stat levels_statbuf;
+		bool const valid = (stat (peak_levels_path().c_str(), &levels_statbuf) == 0 && levels_statbuf.st_mtime >= statbuf.st_mtime);
+		Glib::Threads::Mutex::Lock pm (_peak_map_lock);
+		_peak_levels_valid = valid;
+	}
+
 	if (!empty() && !_peaks_built && _build_missing_peakfiles && _build_peakfiles) {
 		build_peaks_from_scratch ();
 	}
@@ -339,29 +659,22 @@ int
 AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t start, framecnt_t cnt,
 				  double samples_per_visual_peak, framecnt_t samples_per_file_peak) const
 {
-	Glib::Threads::Mutex::Lock lm (_lock);
 	double scale;
 	double expected_peaks;
 	PeakData::PeakDatum xmax;
 	PeakData::PeakDatum xmin;
 	int32_t to_read;
-#ifdef PLATFORM_WINDOWS
-	SYSTEM_INFO system_info;
-        GetSystemInfo (&system_info);
-	const int bufsize = system_info.dwAllocationGranularity;;
-#else
-	const int bufsize = sysconf(_SC_PAGESIZE);
-#endif
 	framecnt_t read_npeaks = npeaks;
 	framecnt_t zero_fill = 0;
 
-	struct stat statbuf;
+	/* peaks are read from the persistent mapping of the peakfile under
+	   _peak_map_lock; _lock is only taken (after dropping _peak_map_lock)
+	   when we have to go to the audio data itself.
+	*/
+
+	Glib::Threads::Mutex::Lock pm (_peak_map_lock);
 
 	expected_peaks = (cnt / (double) samples_per_file_peak);
-	if (stat (peakpath.c_str(), &statbuf) != 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for size check (%2)"), peakpath, strerror (errno)) << endmsg;
-		return -1;
-	}
 
 	/* check actual size of the peakfile is at least large enough for all
 	 * the data in the audio file. if it is too short, assume that a crash
@@ -369,26 +682,26 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	 */
 	
 	const off_t expected_file_size = (_length / (double) samples_per_file_peak) * sizeof (PeakData);
+	off_t mapped;
+
+	if ((mapped = map_peakfile (expected_file_size)) < 0) {
+		return -1;
+	}
 
-	if (statbuf.st_size < expected_file_size) {
-		warning << string_compose (_("peak file %1 is truncated from %2 to %3"), peakpath, expected_file_size, statbuf.st_size) << endmsg;
+	if (mapped < expected_file_size) {
+		warning << string_compose (_("peak file %1 is truncated from %2 to %3"), peakpath, expected_file_size, mapped) << endmsg;
+		pm.release ();
 		const_cast<AudioSource*>(this)->build_peaks_from_scratch ();
-		if (stat (peakpath.c_str(), &statbuf) != 0) {
-			error << string_compose (_("Cannot open peakfile @ %1 for size check (%2) after rebuild"), peakpath, strerror (errno)) << endmsg;
+		pm.acquire ();
+		if ((mapped = map_peakfile (expected_file_size)) < 0) {
+			return -1;
 		}
-		if (statbuf.st_size < expected_file_size) {
+		if (mapped < expected_file_size) {
 			fatal << "peak file is still truncated after rebuild" << endmsg;
 			/*NOTREACHED*/
 		}
 	}
 
-	ScopedFileDescriptor sfd (::open (peakpath.c_str(), O_RDONLY));
-
-	if (sfd < 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), peakpath, strerror (errno)) << endmsg;
-		return -1;
-	}
-				  
 	scale = npeaks/expected_peaks;
 
 
@@ -416,6 +729,9 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 		   both max and min peak values.
 		*/
 
+		pm.release ();
+		Glib::Threads::Mutex::Lock lm (_lock);
+
 		boost::scoped_array<Sample> raw_staging(new Sample[cnt]);
 
 		if (read_unlocked (raw_staging.get(), start, cnt) != cnt) {
@@ -434,68 +750,23 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	if (scale == 1.0) {
 		off_t first_peak_byte = (start / samples_per_file_peak) * sizeof (PeakData);
 		size_t bytes_to_read = sizeof (PeakData) * read_npeaks;
-		/* open, read, close */
 
 		DEBUG_TRACE (DEBUG::Peaks, "DIRECT PEAKS\n");
 
-		off_t  map_off =  first_peak_byte;
-		off_t  read_map_off = map_off & ~(bufsize - 1);
-		off_t  map_delta = map_off - read_map_off;
-		size_t map_length = bytes_to_read + map_delta;
-
-		if (_first_run  || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length  < bytes_to_read)) {
-			peak_cache.reset (new PeakData[npeaks]);
-			char* addr;
-#ifdef PLATFORM_WINDOWS
-			HANDLE file_handle = (HANDLE) _get_osfhandle(int(sfd));
-			HANDLE map_handle;
-			LPVOID view_handle;
-			bool err_flag;
-
-			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
-			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
-
-			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
-			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
-
-			addr = (char*) view_handle;
-
-			memcpy ((void*)peak_cache.get(), (void*)(addr + map_delta), bytes_to_read);
+		/* straight out of the mapped file; anything captured but not
+		   yet written to it reads as silence.
+		*/
 
-			err_flag = UnmapViewOfFile (view_handle);
-			err_flag = CloseHandle(map_handle);
-			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
-#else
-			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
-			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
+		if (map_peakfile (first_peak_byte + bytes_to_read) < 0) {
+			return -1;
+		}
 
-			memcpy ((void*)peak_cache.get(), (void*)(addr + map_delta), bytes_to_read);
-			munmap (addr, map_length);
-#endif
-			if (zero_fill) {
-				memset (&peak_cache[read_npeaks], 0, sizeof (PeakData) * zero_fill);
-			}
+		_peak_map->copy (peaks, first_peak_byte, read_npeaks);
 
-			_first_run = false;
-			_last_scale = samples_per_visual_peak;
-			_last_map_off = map_off;
-			_last_raw_map_length = bytes_to_read;
+		if (zero_fill) {
+			memset (&peaks[read_npeaks], 0, sizeof (PeakData) * zero_fill);
 		}
 
-		memcpy ((void*)peaks, (void*)peak_cache.get(), npeaks * sizeof(PeakData));
-
 		return 0;
 	}
 
@@ -508,19 +779,36 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 		    - more frames-per-peak (lower resolution) than the peakfile, or to put it another way,
                     - less peaks than the peakfile holds for the same range
 
-		    So, read a block into a staging area, and then downsample from there.
+		    So, downsample from the stored peaks, which we can read in place in the mapped file.
 
 		    to avoid confusion, I'll refer to the requested peaks as visual_peaks and the peakfile peaks as stored_peaks
 		*/
 
-		const framecnt_t chunksize = (framecnt_t) expected_peaks; // we read all the peaks we need in one hit.
+		/* use the coarsest level of the peakfile which still has at
+		   least one stored peak per visual peak.
+		*/
+
+		uint32_t level = 0;
+		framecnt_t fpp = samples_per_file_peak;
+
+		while (level < peak_levels && (fpp << peak_level_bits) <= samples_per_visual_peak) {
+			fpp <<= peak_level_bits;
+			++level;
+		}
+
+		if (level && !_peak_levels_valid && (_peak_levels_failed || !build_peak_levels ())) {
+			level = 0;
+			fpp = samples_per_file_peak;
+		}
+
+		const framecnt_t chunksize = (framecnt_t) (cnt / (double) fpp); // we read all the peaks we need in one hit.
 
 		/* compute the rounded up frame position  */
 
-		framepos_t current_stored_peak = (framepos_t) ceil (start / (double) samples_per_file_peak);
+		framepos_t current_stored_peak = (framepos_t) ceil (start / (double) fpp);
 		framepos_t next_visual_peak  = (framepos_t) ceil (start / samples_per_visual_peak);
 		double     next_visual_peak_frame = next_visual_peak * samples_per_visual_peak;
-		framepos_t stored_peak_before_next_visual_peak = (framepos_t) next_visual_peak_frame / samples_per_file_peak;
+		framepos_t stored_peak_before_next_visual_peak = (framepos_t) next_visual_peak_frame / fpp;
 		framecnt_t nvisual_peaks = 0;
 		uint32_t i = 0;
 
@@ -528,57 +816,42 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 
 		current_stored_peak = min (current_stored_peak, stored_peak_before_next_visual_peak);
 
-		/* open ... close during out: handling */
-
 		off_t  map_off =  (uint32_t) (ceil (start / (double) samples_per_file_peak)) * sizeof(PeakData);
-		off_t  read_map_off = map_off & ~(bufsize - 1);
-		off_t  map_delta = map_off - read_map_off;
 		size_t raw_map_length = chunksize * sizeof(PeakData);
-		size_t map_length = (chunksize * sizeof(PeakData)) + map_delta;
 
 		if (_first_run || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length < raw_map_length)) {
 			peak_cache.reset (new PeakData[npeaks]);
-			boost::scoped_array<PeakData> staging (new PeakData[chunksize]);
 
-			char* addr;
-#ifdef PLATFORM_WINDOWS
-			HANDLE file_handle =  (HANDLE) _get_osfhandle(int(sfd));
-			HANDLE map_handle;
-			LPVOID view_handle;
-			bool err_flag;
-
-			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
-			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
+			PeakData const * staging = 0;
+			boost::scoped_array<PeakData> partial_staging;
 
-			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
-			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
+			if (level) {
 
-			addr = (char *) view_handle;
+				const framepos_t first = (framepos_t) ceil (start / (double) fpp);
 
-			memcpy ((void*)staging.get(), (void*)(addr + map_delta), raw_map_length);
+				if (map_peak_levels (level_peak_byte (level, first + max (chunksize, (framecnt_t) 1) - 1) + sizeof (PeakData)) < 0) {
+					return -1;
+				}
 
-			err_flag = UnmapViewOfFile (view_handle);
-			err_flag = CloseHandle(map_handle);
-			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
-				return -1;
-			}
-#else
-			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
-			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
-				return -1;
+				/* levels are not contiguous in the sidecar */
+				partial_staging.reset (new PeakData[chunksize]);
+				_peak_levels_map->copy_level (partial_staging.get(), level, first, chunksize);
+				staging = partial_staging.get();
+
+			} else {
+
+				if (map_peakfile (map_off + raw_map_length) < 0) {
+					return -1;
+				}
+
+				if ((staging = _peak_map->peaks (map_off, chunksize)) == 0) {
+					/* not all written yet */
+					partial_staging.reset (new PeakData[chunksize]);
+					_peak_map->copy (partial_staging.get(), map_off, chunksize);
+					staging = partial_staging.get();
+				}
 			}
 
-			memcpy ((void*)staging.get(), (void*)(addr + map_delta), raw_map_length);
-			munmap (addr, map_length);
-#endif
 			while (nvisual_peaks < read_npeaks) {
 
 				xmax = -1.0;
@@ -596,7 +869,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 				peak_cache[nvisual_peaks].min = xmin;
 				++nvisual_peaks;
 				next_visual_peak_frame =  min ((double) start + cnt, (next_visual_peak_frame + samples_per_visual_peak));
-				stored_peak_before_next_visual_peak = (uint32_t) next_visual_peak_frame / samples_per_file_peak;
+				stored_peak_before_next_visual_peak = (uint32_t) next_visual_peak_frame / fpp;
 			}
 
 			if (zero_fill) {
@@ -615,6 +888,9 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, framecnt_t npeaks, framepos_t
 	} else {
 		DEBUG_TRACE (DEBUG::Peaks, "UPSAMPLE\n");
 
+		pm.release ();
+		Glib::Threads::Mutex::Lock lm (_lock);
+
 		/* the caller wants
 
 		     - less frames-per-peak (more resolution)
@@ -757,18 +1033,195 @@ AudioSource::build_peaks_from_scratch ()
 	if (ret) {
 		DEBUG_TRACE (DEBUG::Peaks, string_compose("Could not write peak data, attempting to remove peakfile %1\n", peakpath));
 		::g_unlink (peakpath.c_str());
+		::g_unlink (peak_levels_path().c_str());
 	}
 
 	return ret;
 }
 
+/** Map the peakfile, if it is not already, making sure that at least
+ *  @param bytes of it are mapped if the file is that long.
+ *  _peak_map_lock MUST be held by caller.
+ *  @return number of bytes mapped, or -1 on error.
+ */
+off_t
+AudioSource::map_peakfile (off_t bytes) const
+{
+	if (!_peak_map) {
+		_peak_map = new PeakFileMap (peakpath);
+	}
+
+	return _peak_map->map (bytes);
+}
+
+/** Forget any mapping of the peakfile; must be called before the file
+ *  is shrunk, renamed, removed or recreated.
+ */
+void
+AudioSource::drop_peakfile_map ()
+{
+	Glib::Threads::Mutex::Lock pm (_peak_map_lock);
+
+	delete _peak_map;
+	_peak_map = 0;
+	delete _peak_levels_map;
+	_peak_levels_map = 0;
+	_peak_levels_failed = false;
+	_first_run = true;
+}
+
+string
+AudioSource::peak_levels_path () const
+{
+	return peakpath + peakfile_levels_suffix;
+}
+
+/** As map_peakfile(), for the peakfile levels sidecar */
+off_t
+AudioSource::map_peak_levels (off_t bytes) const
+{
+	if (!_peak_levels_map) {
+		_peak_levels_map = new PeakFileMap (peak_levels_path ());
+	}
+
+	return _peak_levels_map->map (bytes);
+}
+
+/** Build the peakfile levels from the (mapped) peakfile, for peakfiles
+ *  that were written without them. _peak_map_lock MUST be held by caller.
+ *  @return true if the levels are now usable.
+ */
+bool
+AudioSource::build_peak_levels () const
+{
+	const framecnt_t npeaks = _peak_map ? _peak_map->length() / sizeof (PeakData) : 0;
+
+	if (npeaks == 0) {
+		return false;
+	}
+
+	DEBUG_TRACE (DEBUG::Peaks, string_compose ("Building peak levels for %1\n", peakpath));
+
+	const string path = peak_levels_path ();
+	int fd;
+
+	if ((fd = ::open (path.c_str(), O_CREAT|O_RDWR|O_TRUNC, 0664)) < 0) {
+		error << string_compose (_("AudioSource: cannot open peak levels \"%1\" (%2)"), path, strerror (errno)) << endmsg;
+		_peak_levels_failed = true;
+		return false;
+	}
+
+	/* work in whole blocks, so that each chunk of the peakfile yields
+	   whole blocks of the sidecar.
+	*/
+
+	const framecnt_t chunksize = level_block_peaks (0) * 64;
+	boost::scoped_array<PeakData> src (new PeakData[chunksize]);
+	boost::scoped_array<PeakData> dst (new PeakData[chunksize]);
+
+	for (framepos_t first = 0; first < npeaks; first += chunksize) {
+
+		framecnt_t n = min (chunksize, npeaks - first);
+		framepos_t p = first;
+
+		_peak_map->copy (src.get(), first * sizeof (PeakData), n);
+
+		for (uint32_t level = 1; level <= peak_levels; ++level) {
+
+			reduce_peaks (src.get(), n, dst.get());
+
+			p >>= peak_level_bits;
+			n = (n + (1 << peak_level_bits) - 1) >> peak_level_bits;
+
+			if (level_io (fd, level, p, dst.get(), n, true)) {
+				error << string_compose (_("%1: could not write peak levels (%2)"), _name, strerror (errno)) << endmsg;
+				::close (fd);
+				::g_unlink (path.c_str());
+				_peak_levels_failed = true;
+				return false;
+			}
+
+			src.swap (dst);
+		}
+	}
+
+	::close (fd);
+
+	delete _peak_levels_map;
+	_peak_levels_map = 0;
+	_peak_levels_valid = true;
+
+	return true;
+}
+
+/** Update the peakfile levels for @param npeaks peaks of the peakfile,
+ *  starting at @param first, which have just been written.
+ *  _lock MUST be held by caller.
+ */
+int
+AudioSource::write_peak_levels (framepos_t first, framecnt_t npeaks)
+{
+	if (_peak_levels_fd < 0) {
+		return 0;
+	}
+
+	int fd = _peakfile_fd;
+
+	for (uint32_t level = 1; npeaks && level <= peak_levels; ++level) {
+
+		/* recompute every peak of this level which covers the new
+		   data, including any partial one left by the last write.
+		*/
+
+		const framepos_t src_first = (first >> peak_level_bits) << peak_level_bits;
+		const framecnt_t src_cnt = first + npeaks - src_first;
+		const framepos_t dst_first = first >> peak_level_bits;
+		const framecnt_t dst_cnt = (src_cnt + (1 << peak_level_bits) - 1) >> peak_level_bits;
+
+		boost::scoped_array<PeakData> src (new PeakData[src_cnt]);
+		boost::scoped_array<PeakData> dst (new PeakData[dst_cnt]);
+
+		if (level_io (fd, level - 1, src_first, src.get(), src_cnt, false)) {
+			error << string_compose(_("%1: could not read peak data for peak levels (%2)"), _name, strerror (errno)) << endmsg;
+			return -1;
+		}
+
+		reduce_peaks (src.get(), src_cnt, dst.get());
+
+		if (level_io (_peak_levels_fd, level, dst_first, dst.get(), dst_cnt, true)) {
+			error << string_compose(_("%1: could not write peak levels (%2)"), _name, strerror (errno)) << endmsg;
+			return -1;
+		}
+
+		_peak_levels_byte_max = max (_peak_levels_byte_max, (off_t) (level_peak_byte (level, dst_first + dst_cnt - 1) + sizeof (PeakData)));
+
+		fd = _peak_levels_fd;
+		first = dst_first;
+		npeaks = dst_cnt;
+	}
+
+	return 0;
+}
+
 int
 AudioSource::prepare_for_peakfile_writes ()
 {
+	drop_peakfile_map ();
+
 	if ((_peakfile_fd = open (peakpath.c_str(), O_CREAT|O_RDWR, 0664)) < 0) {
 		error << string_compose(_("AudioSource: cannot open peakpath (c) \"%1\" (%2)"), peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
+
+	/* the levels are written along with the peaks; without them, reads
+	   just fall back to the peakfile itself.
+	*/
+
+	_peak_levels_fd = open (peak_levels_path().c_str(), O_CREAT|O_RDWR, 0664);
+
+	Glib::Threads::Mutex::Lock pm (_peak_map_lock);
+	_peak_levels_valid = (_peak_levels_fd >= 0);
+
 	return 0;
 }
 
@@ -787,6 +1240,11 @@ AudioSource::done_with_peakfile_writes (bool done)
 
 	close (_peakfile_fd);
 	_peakfile_fd = -1;
+
+	if (_peak_levels_fd >= 0) {
+		close (_peak_levels_fd);
+		_peak_levels_fd = -1;
+	}
 }
 
 /** @param first_frame Offset from the source start of the first frame to
@@ -848,6 +1306,10 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 			_peak_byte_max = max (_peak_byte_max, (off_t) (byte + sizeof(PeakData)));
 
+			if (write_peak_levels (peak_leftover_frame / fpp, 1)) {
+				return -1;
+			}
+
 			{
 				Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 				PeakRangeReady (peak_leftover_frame, peak_leftover_cnt); /* EMIT SIGNAL */
@@ -974,6 +1436,10 @@ AudioSource::compute_and_write_peaks (Sample* buf, framecnt_t first_frame, frame
 
 	_peak_byte_max = max (_peak_byte_max, (off_t) (first_peak_byte + bytes_to_write));
 
+	if (write_peak_levels (first_peak_byte / sizeof (PeakData), peaks_computed)) {
+		return -1;
+	}
+
 	if (frames_done) {
 		Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
 		PeakRangeReady (first_frame, frames_done); /* EMIT SIGNAL */
@@ -1000,11 +1466,19 @@ AudioSource::truncate_peakfile ()
 
 	if (end > _peak_byte_max) {
 		DEBUG_TRACE(DEBUG::Peaks, string_compose ("Truncating Peakfile  %1\n", peakpath));
+		drop_peakfile_map ();
 		if (ftruncate (_peakfile_fd, _peak_byte_max)) {
 			error << string_compose (_("could not truncate peakfile %1 to %2 (error: %3)"),
 						 peakpath, _peak_byte_max, errno) << endmsg;
 		}
 	}
+
+	if (_peak_levels_fd >= 0 && lseek (_peak_levels_fd, 0, SEEK_END) > _peak_levels_byte_max) {
+		drop_peakfile_map ();
+		if (ftruncate (_peak_levels_fd, _peak_levels_byte_max)) {
+			/* leftover zeroes after the last block are harmless */
+		}
+	}
 }
 
 framecnt_t
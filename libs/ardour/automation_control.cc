@@ -71,6 +71,7 @@ void
 AutomationControl::set_list (boost::shared_ptr<Evoral::ControlList> list)
 {
 	Control::set_list (list);
+	ListReplaced (); /* EMIT SIGNAL */
 	Changed();  /* EMIT SIGNAL */
 }
 
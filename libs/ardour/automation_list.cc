@@ -23,6 +23,11 @@
 #include <cmath>
 #include <sstream>
 #include <algorithm>
+
+#include <glib.h>
+
+#include <boost/bind.hpp>
+
 #include "ardour/automation_list.h"
 #include "ardour/event_type_map.h"
 #include "ardour/parameter_descriptor.h"
@@ -50,12 +55,15 @@ static void dumpit (const AutomationList& al, string prefix = "")
 #endif
 AutomationList::AutomationList (const Evoral::Parameter& id, const Evoral::ParameterDescriptor& desc)
 	: ControlList(id, desc)
+	, _events_state (0)
+	, _events_state_generation (0)
 {
 	_state = Off;
 	_style = Absolute;
 	g_atomic_int_set (&_touching, 0);
 
 	create_curve_if_necessary();
+	listen_for_changes ();
 
 	assert(_parameter.type() != NullAutomation);
 	AutomationListCreated(this);
@@ -63,12 +71,15 @@ AutomationList::AutomationList (const Evoral::Parameter& id, const Evoral::Param
 
 AutomationList::AutomationList (const Evoral::Parameter& id)
 	: ControlList(id, ARDOUR::ParameterDescriptor(id))
+	, _events_state (0)
+	, _events_state_generation (0)
 {
 	_state = Off;
 	_style = Absolute;
 	g_atomic_int_set (&_touching, 0);
 
 	create_curve_if_necessary();
+	listen_for_changes ();
 
 	assert(_parameter.type() != NullAutomation);
 	AutomationListCreated(this);
@@ -77,12 +88,15 @@ AutomationList::AutomationList (const Evoral::Parameter& id)
 AutomationList::AutomationList (const AutomationList& other)
 	: StatefulDestructible()
 	, ControlList(other)
+	, _events_state (0)
+	, _events_state_generation (0)
 {
 	_style = other._style;
 	_state = other._state;
 	g_atomic_int_set (&_touching, other.touching());
 
 	create_curve_if_necessary();
+	listen_for_changes ();
 
 	assert(_parameter.type() != NullAutomation);
 	AutomationListCreated(this);
@@ -90,12 +104,15 @@ AutomationList::AutomationList (const AutomationList& other)
 
 AutomationList::AutomationList (const AutomationList& other, double start, double end)
 	: ControlList(other, start, end)
+	, _events_state (0)
+	, _events_state_generation (0)
 {
 	_style = other._style;
 	_state = other._state;
 	g_atomic_int_set (&_touching, other.touching());
 
 	create_curve_if_necessary();
+	listen_for_changes ();
 
 	assert(_parameter.type() != NullAutomation);
 	AutomationListCreated(this);
@@ -106,6 +123,8 @@ AutomationList::AutomationList (const AutomationList& other, double start, doubl
  */
 AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
 	: ControlList(id, ARDOUR::ParameterDescriptor(id))
+	, _events_state (0)
+	, _events_state_generation (0)
 {
 	g_atomic_int_set (&_touching, 0);
 	_state = Off;
@@ -118,6 +137,7 @@ AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
 	}
 
 	create_curve_if_necessary();
+	listen_for_changes ();
 
 	assert(_parameter.type() != NullAutomation);
 	AutomationListCreated(this);
@@ -125,6 +145,7 @@ AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
 
 AutomationList::~AutomationList()
 {
+	delete _events_state;
 }
 
 boost::shared_ptr<Evoral::ControlList>
@@ -171,6 +192,13 @@ AutomationList::operator= (const AutomationList& other)
 	return *this;
 }
 
+void
+AutomationList::listen_for_changes ()
+{
+	/* every change to the events goes through mark_dirty() */
+	Dirty.connect_same_thread (_dirty_connection, boost::bind (&AutomationList::bump_state_generation, this));
+}
+
 void
 AutomationList::maybe_signal_changed ()
 {
@@ -186,6 +214,7 @@ AutomationList::set_automation_state (AutoState s)
 {
 	if (s != _state) {
 		_state = s;
+		bump_state_generation ();
 		automation_state_changed (s); /* EMIT SIGNAL */
 	}
 }
@@ -195,6 +224,7 @@ AutomationList::set_automation_style (AutoStyle s)
 {
 	if (s != _style) {
 		_style = s;
+		bump_state_generation ();
 		automation_style_changed (); /* EMIT SIGNAL */
 	}
 }
@@ -286,12 +316,31 @@ AutomationList::state (bool full)
 	root->add_property ("style", auto_style_to_string (_style));
 
 	if (!_events.empty()) {
-		root->add_child_nocopy (serialize_events());
+		root->add_child_copy (cached_events ());
 	}
 
 	return *root;
 }
 
+XMLNode const &
+AutomationList::cached_events ()
+{
+	Glib::Threads::Mutex::Lock lm (_events_state_lock);
+
+	/* read this first, so that changes made while we serialize
+	   will be picked up next time.
+	*/
+	const uint32_t generation = state_generation ();
+
+	if (!_events_state || _events_state_generation != generation) {
+		delete _events_state;
+		_events_state = &serialize_events ();
+		_events_state_generation = generation;
+	}
+
+	return *_events_state;
+}
+
 XMLNode&
 AutomationList::serialize_events ()
 {
@@ -333,22 +382,28 @@ AutomationList::deserialize_events (const XMLNode& node)
         ControlList::freeze ();
 	clear ();
 
-	stringstream str (content_node->content());
+	/* lists can hold a great many points, so parse them straight out
+	   of the content rather than via a stream.
+	*/
 
+	const char* p = content_node->content().c_str();
+	char* end;
 	double x;
 	double y;
 	bool ok = true;
 
-	while (str) {
-		str >> x;
-		if (!str) {
+	while (true) {
+		x = g_ascii_strtod (p, &end);
+		if (end == p) {
 			break;
 		}
-		str >> y;
-		if (!str) {
+		p = end;
+		y = g_ascii_strtod (p, &end);
+		if (end == p) {
 			ok = false;
 			break;
 		}
+		p = end;
 		fast_simple_add (x, y);
 	}
 
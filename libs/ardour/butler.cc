@@ -17,23 +17,29 @@
 
 */
 
+#include <algorithm>
+
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #ifndef PLATFORM_WINDOWS
 #include <poll.h>
 #endif
 
+#include "pbd/cpus.h"
 #include "pbd/error.h"
 #include "pbd/pthread_utils.h"
 #include "ardour/debug.h"
 #include "ardour/butler.h"
 #include "ardour/io.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/midi_diskstream.h"
 #include "ardour/session.h"
 #include "ardour/track.h"
 #include "ardour/auditioner.h"
+#include "ardour/utils.h"
 
 #include "i18n.h"
 
@@ -50,6 +56,12 @@ Butler::Butler(Session& s)
 	, midi_dstream_buffer_size(0)
 	, pool_trash(16)
 	, _xthread (true)
+	, _pass (RefillPass)
+	, _next_queue (0)
+	, _jobs_pending (0)
+	, _pass_outstanding (false)
+	, _pass_err (0)
+	, _workers_quit (false)
 {
 	g_atomic_int_set(&should_do_transport_work, 0);
 	SessionEvent::pool->set_trash (&pool_trash);
@@ -136,6 +148,11 @@ Butler::start_thread()
 
 	//pthread_detach (thread);
 	have_thread = true;
+
+	if (start_workers ()) {
+		/* not fatal: the butler thread does all disk work itself */
+		terminate_workers ();
+	}
     
 	// we are ready to request buffer adjustments
 	_session.adjust_capture_buffering ();
@@ -153,6 +170,78 @@ Butler::terminate_thread ()
 		queue_request (Request::Quit);
 		pthread_join (thread, &status);
 	}
+
+	terminate_workers ();
+}
+
+int
+Butler::start_workers ()
+{
+	/* the pool size is read only when the butler starts */
+
+	uint32_t const n = Config->get_butler_worker_threads ();
+
+	_workers_quit = false;
+
+	for (uint32_t i = 0; i < n; ++i) {
+
+		Worker* w = new Worker (*this);
+
+		/* see AudioDiskstream::allocate_working_buffers() */
+		w->mixdown_buffer = new Sample[2*1048576];
+		w->gain_buffer = new gain_t[2*1048576];
+
+		if (pthread_create_and_store (string_compose ("butler worker %1", i), &w->thread, _worker_thread_work, w)) {
+			error << _("Session: could not create butler worker thread") << endmsg;
+			delete [] w->mixdown_buffer;
+			delete [] w->gain_buffer;
+			delete w;
+			return -1;
+		}
+
+		_workers.push_back (w);
+	}
+
+	DEBUG_TRACE (DEBUG::Butler, string_compose ("butler started %1 disk workers\n", _workers.size()));
+
+	return 0;
+}
+
+void
+Butler::terminate_workers ()
+{
+	if (_workers.empty()) {
+		return;
+	}
+
+	{
+		Glib::Threads::Mutex::Lock lm (_worker_lock);
+		_workers_quit = true;
+		_worker_cond.broadcast ();
+	}
+
+	for (std::vector<Worker*>::iterator w = _workers.begin(); w != _workers.end(); ++w) {
+		void* status;
+		pthread_join ((*w)->thread, &status);
+		delete [] (*w)->mixdown_buffer;
+		delete [] (*w)->gain_buffer;
+		delete *w;
+	}
+
+	_workers.clear ();
+}
+
+/** Keep the calling thread off the CPUs that the process threads have been
+ *  given, if they have been given any.
+ */
+void
+Butler::keep_off_process_cpus ()
+{
+	std::vector<uint32_t> const cpus = non_process_thread_cpus ();
+
+	if (!cpus.empty () && set_thread_cpus (cpus)) {
+		warning << _("Butler: could not set CPU affinity") << endmsg;
+	}
 }
 
 void *
@@ -160,6 +249,7 @@ Butler::_thread_work (void* arg)
 {
 	SessionEvent::create_per_thread_pool ("butler events", 4096);
 	pthread_set_name (X_("butler"));
+	keep_off_process_cpus ();
 	return ((Butler *) arg)->thread_work ();
 }
 
@@ -230,6 +320,39 @@ Butler::thread_work ()
 		RouteList rl_with_auditioner = *rl;
 		rl_with_auditioner.push_back (_session.the_auditioner());
 
+		if (!_workers.empty()) {
+
+			if (!should_run) {
+				/* paused: as the serial passes below, do nothing */
+				goto disk_work_done;
+			}
+
+			if (run_disk_pass (RefillPass, rl_with_auditioner, err)) {
+				disk_work_outstanding = true;
+			}
+
+			if (!err && transport_work_requested()) {
+				DEBUG_TRACE (DEBUG::Butler, "transport work requested during refill, back to restart\n");
+				goto restart;
+			}
+
+			if (run_disk_pass (FlushPass, *rl, err)) {
+				disk_work_outstanding = true;
+			}
+
+			if (err && _session.actively_recording()) {
+				DEBUG_TRACE (DEBUG::Butler, "error occurred during recording - stop transport\n");
+				_session.request_stop ();
+			}
+
+			if (!err && transport_work_requested()) {
+				DEBUG_TRACE (DEBUG::Butler, "transport work requested during flush, back to restart\n");
+				goto restart;
+			}
+
+			goto disk_work_done;
+		}
+
 		for (i = rl_with_auditioner.begin(); !transport_work_requested() && should_run && i != rl_with_auditioner.end(); ++i) {
 
 			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
@@ -332,6 +455,7 @@ Butler::thread_work ()
 			goto restart;
 		}
 
+	  disk_work_done:
 		if (!disk_work_outstanding) {
 			_session.refresh_disk_space ();
 		}
@@ -357,6 +481,250 @@ Butler::thread_work ()
 	return (0);
 }
 
+/** @return the device that @param tr reads from (for a refill) or writes
+ *  to (for a flush); a track may play back files on one disk while it
+ *  captures to another.
+ */
+dev_t
+Butler::device_for (boost::shared_ptr<Track> tr, DiskPass pass)
+{
+	std::pair<PBD::ID, DiskPass> const key (tr->id(), pass);
+	std::map<std::pair<PBD::ID, DiskPass>, dev_t>::iterator d = _device_cache.find (key);
+
+	if (d != _device_cache.end()) {
+		return d->second;
+	}
+
+	dev_t dev = 0;
+	std::string const path = (pass == RefillPass ? tr->disk_read_path () : tr->disk_write_path ());
+	struct stat statbuf;
+
+	if (!path.empty() && stat (path.c_str(), &statbuf) == 0) {
+		dev = statbuf.st_dev;
+	}
+
+	_device_cache.insert (std::make_pair (key, dev));
+
+	return dev;
+}
+
+/** Run one refill or flush pass over @param routes using the worker pool.
+ *  Jobs are queued per device, each queue ordered by buffer load, and the
+ *  workers take the most urgent job from each device in turn.
+ *  @return true if some tracks still have disk work outstanding.
+ */
+bool
+Butler::run_disk_pass (DiskPass pass, RouteList const & routes, uint32_t& err)
+{
+	boost::shared_ptr<RouteList> rl = _session.get_routes ();
+
+	if (rl != _device_cache_routes || transport_work_requested ()) {
+		/* tracks or their files may have changed */
+		_device_cache.clear ();
+		_device_cache_routes = rl;
+	}
+
+	std::map<dev_t,size_t> queue_index;
+	std::vector<DiskQueue> queues;
+
+	for (RouteList::const_iterator i = routes.begin(); i != routes.end(); ++i) {
+
+		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
+
+		if (!tr) {
+			continue;
+		}
+
+		float load;
+
+		if (pass == RefillPass) {
+			boost::shared_ptr<IO> io = tr->input ();
+
+			if (io && !io->active()) {
+				/* don't read inactive tracks */
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("butler skips inactive track %1\n", tr->name()));
+				continue;
+			}
+			load = tr->playback_buffer_load ();
+		} else {
+			/* note that we still try to flush diskstreams attached to inactive routes
+			 */
+			load = tr->capture_buffer_load ();
+		}
+
+		dev_t const dev = device_for (tr, pass);
+		std::map<dev_t,size_t>::iterator q = queue_index.find (dev);
+
+		if (q == queue_index.end()) {
+			q = queue_index.insert (std::make_pair (dev, queues.size())).first;
+			queues.push_back (DiskQueue ());
+		}
+
+		queues[q->second].push_back (DiskJob (tr, load));
+	}
+
+	uint32_t njobs = 0;
+
+	for (std::vector<DiskQueue>::iterator q = queues.begin(); q != queues.end(); ++q) {
+		std::sort (q->begin(), q->end());
+		njobs += q->size();
+	}
+
+	if (njobs == 0) {
+		return false;
+	}
+
+	DEBUG_TRACE (DEBUG::Butler, string_compose ("butler hands %1 %2 jobs on %3 devices to workers\n",
+	                                            njobs, (pass == RefillPass ? "refill" : "flush"), queues.size()));
+
+	Glib::Threads::Mutex::Lock lm (_worker_lock);
+
+	_disk_queues.swap (queues);
+	_pass = pass;
+	_next_queue = 0;
+	_jobs_pending = njobs;
+	_pass_outstanding = false;
+	_pass_err = 0;
+
+	_worker_cond.broadcast ();
+
+	while (_jobs_pending) {
+		_pass_done.wait (_worker_lock);
+	}
+
+	_disk_queues.clear ();
+	err += _pass_err;
+
+	return _pass_outstanding;
+}
+
+/** Called with _worker_lock held */
+bool
+Butler::next_disk_job (DiskJob& job)
+{
+	size_t const nqueues = _disk_queues.size();
+
+	for (size_t n = 0; n < nqueues; ++n) {
+
+		DiskQueue& q (_disk_queues[_next_queue]);
+		_next_queue = (_next_queue + 1) % nqueues;
+
+		if (!q.empty()) {
+			job = q.back ();
+			q.pop_back ();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void *
+Butler::_worker_thread_work (void* arg)
+{
+	Worker* w = (Worker*) arg;
+	SessionEvent::create_per_thread_pool ("butler worker events", 64);
+	pthread_set_name (X_("butler worker"));
+	keep_off_process_cpus ();
+	w->butler.worker_thread_work (w);
+	return 0;
+}
+
+void
+Butler::worker_thread_work (Worker* w)
+{
+	Glib::Threads::Mutex::Lock lm (_worker_lock);
+
+	while (true) {
+
+		DiskJob job (boost::shared_ptr<Track>(), 0);
+
+		while (!_workers_quit && !next_disk_job (job)) {
+			_worker_cond.wait (_worker_lock);
+		}
+
+		if (_workers_quit) {
+			return;
+		}
+
+		DiskPass const pass = _pass;
+		bool outstanding = false;
+		bool failed = false;
+
+		lm.release ();
+
+		boost::shared_ptr<Track> tr = job.track;
+
+		if (transport_work_requested()) {
+			/* leave it for the next pass */
+			outstanding = true;
+
+		} else if (!should_run) {
+			/* paused part way through a pass; the butler will start a
+			   new one when it is asked to run again, so this is not
+			   outstanding work.
+			*/
+
+		} else if (pass == RefillPass) {
+
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler worker refills %1, playback load = %2\n", tr->name(), job.load));
+
+			switch (tr->do_refill_with_buffers (w->mixdown_buffer, w->gain_buffer)) {
+			case 0:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
+				outstanding = true;
+				break;
+
+			default:
+				error << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << endmsg;
+				std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << std::endl;
+				break;
+			}
+
+		} else {
+
+			DEBUG_TRACE (DEBUG::Butler, string_compose ("butler worker flushes track %1 capture load %2\n", tr->name(), job.load));
+
+			switch (tr->do_flush (ButlerContext)) {
+			case 0:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1\n", tr->name()));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1\n", tr->name()));
+				outstanding = true;
+				break;
+
+			default:
+				failed = true;
+				error << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << endmsg;
+				std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << std::endl;
+				break;
+			}
+		}
+
+		/* drop our reference before we go back to sleep */
+		tr.reset ();
+		job.track.reset ();
+
+		lm.acquire ();
+
+		if (outstanding) {
+			_pass_outstanding = true;
+		}
+		if (failed) {
+			++_pass_err;
+		}
+		if (--_jobs_pending == 0) {
+			_pass_done.signal ();
+		}
+	}
+}
+
 void
 Butler::schedule_transport_work ()
 {
@@ -40,10 +40,12 @@
 
 #include "ardour/debug.h"
 #include "ardour/diskstream.h"
+#include "ardour/file_source.h"
 #include "ardour/io.h"
 #include "ardour/pannable.h"
 #include "ardour/profile.h"
 #include "ardour/playlist.h"
+#include "ardour/region.h"
 #include "ardour/session.h"
 #include "ardour/track.h"
 
@@ -412,6 +414,40 @@ Diskstream::playlist_changed (const PropertyChange&)
 	playlist_modified ();
 }
 
+static void
+first_file_source_path (boost::shared_ptr<Region> r, std::string* path)
+{
+	if (!path->empty()) {
+		return;
+	}
+
+	for (uint32_t n = 0; n < r->n_channels(); ++n) {
+		boost::shared_ptr<FileSource> fs = boost::dynamic_pointer_cast<FileSource> (r->source (n));
+		if (fs) {
+			*path = fs->path ();
+			return;
+		}
+	}
+}
+
+string
+Diskstream::disk_read_path () const
+{
+	string path;
+
+	if (_playlist) {
+		_playlist->foreach_region (boost::bind (first_file_source_path, _1, &path));
+	}
+
+	return path;
+}
+
+string
+Diskstream::disk_write_path () const
+{
+	return disk_read_path ();
+}
+
 void
 Diskstream::playlist_modified ()
 {
@@ -0,0 +1,123 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include "ardour/dsp_profiler.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+bool DSPProfiler::_enabled = false;
+
+DSPTimings::DSPTimings ()
+{
+	for (int i = 0; i < bucket_count; ++i) {
+		_buckets[i] = 0;
+	}
+	_count = 0;
+	_total = 0;
+	_min = 0;
+	_max = 0;
+	g_atomic_int_set (&_reset, 0);
+}
+
+/** @return the bucket for a time; times below 4us get a bucket each, and
+ *  above that each power of two is split into four.
+ */
+int
+DSPTimings::bucket (microseconds_t t)
+{
+	if (t < 4) {
+		return t;
+	}
+
+	int e = 2;
+	while (e < 63 && (t >> (e + 1)) != 0) {
+		++e;
+	}
+
+	int const b = 4 * (e - 1) + ((t >> (e - 2)) & 3);
+	return min (b, bucket_count - 1);
+}
+
+/** @return the largest time which goes in bucket @a b */
+microseconds_t
+DSPTimings::bucket_top (int b)
+{
+	if (b < 4) {
+		return b;
+	}
+
+	int const e = b / 4 + 1;
+	return ((microseconds_t) (4 + b % 4 + 1) << (e - 2)) - 1;
+}
+
+void
+DSPTimings::add (microseconds_t t)
+{
+	if (g_atomic_int_get (&_reset)) {
+		for (int i = 0; i < bucket_count; ++i) {
+			_buckets[i] = 0;
+		}
+		_count = 0;
+		_total = 0;
+		g_atomic_int_set (&_reset, 0);
+	}
+
+	if (_count == 0 || t < _min) {
+		_min = t;
+	}
+	if (_count == 0 || t > _max) {
+		_max = t;
+	}
+
+	++_buckets[bucket (t)];
+	_total += t;
+	++_count;
+}
+
+DSPTimingStats
+DSPTimings::stats () const
+{
+	DSPTimingStats s;
+
+	if (g_atomic_int_get (&_reset) || _count == 0) {
+		return s;
+	}
+
+	s.count = _count;
+	s.min = _min;
+	s.max = _max;
+	s.avg = _total / _count;
+
+	/* the top of the bucket holding the 99th percentile */
+	uint64_t const p99 = _count - _count / 100;
+	uint64_t n = 0;
+
+	for (int i = 0; i < bucket_count; ++i) {
+		n += _buckets[i];
+		if (n >= p99) {
+			s.p99 = min (bucket_top (i), s.max);
+			break;
+		}
+	}
+
+	return s;
+}
@@ -33,6 +33,7 @@
 #include "audiographer/general/sr_converter.h"
 #include "audiographer/general/silence_trimmer.h"
 #include "audiographer/general/threader.h"
+#include "audiographer/general/tmp_buffer.h"
 #include "audiographer/sndfile/tmp_file.h"
 #include "audiographer/sndfile/sndfile_writer.h"
 
@@ -41,6 +42,7 @@
 #include "ardour/export_filename.h"
 #include "ardour/export_format_specification.h"
 #include "ardour/export_timespan.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/session_directory.h"
 #include "ardour/sndfile_helpers.h"
 
@@ -55,6 +57,8 @@ namespace ARDOUR {
 ExportGraphBuilder::ExportGraphBuilder (Session const & session)
 	: session (session)
 	, thread_pool (hardware_concurrency())
+	, normalize_pool (hardware_concurrency())
+	, jobs_running (0)
 {
 	process_buffer_frames = session.engine().samples_per_cycle();
 }
@@ -68,12 +72,19 @@ ExportGraphBuilder::process (framecnt_t frames, bool last_cycle)
 {
 	assert(frames <= process_buffer_frames);
 
+	/* Read every channel once, before any of the channel configs which
+	   share them run; each channel's data stays put until the next cycle.
+	*/
 	for (ChannelMap::iterator it = channels.begin(); it != channels.end(); ++it) {
-		Sample const * process_buffer = 0;
-		it->first->read (process_buffer, frames);
-		ConstProcessContext<Sample> context(process_buffer, frames, 1);
-		if (last_cycle) { context().set_flag (ProcessContext<Sample>::EndOfInput); }
-		it->second->process (context);
+		it->first->read (it->second, frames);
+	}
+
+	if (channel_configs.size() > 1 && Config->get_parallel_export_stems()) {
+		run_channel_configs (frames, last_cycle);
+	} else {
+		for (ChannelConfigList::iterator it = channel_configs.begin(); it != channel_configs.end(); ++it) {
+			it->process (frames, last_cycle);
+		}
 	}
 
 	return 0;
@@ -82,8 +93,16 @@ ExportGraphBuilder::process (framecnt_t frames, bool last_cycle)
 bool
 ExportGraphBuilder::process_normalize ()
 {
+	if (normalizers.size() > 1 && Config->get_parallel_export_normalize()) {
+		run_normalizers ();
+	} else {
+		for (std::list<Normalizer *>::iterator it = normalizers.begin(); it != normalizers.end(); ++it) {
+			(*it)->process();
+		}
+	}
+
 	for (std::list<Normalizer *>::iterator it = normalizers.begin(); it != normalizers.end(); /* ++ in loop */) {
-		if ((*it)->process()) {
+		if ((*it)->finished()) {
 			it = normalizers.erase (it);
 		} else {
 			++it;
@@ -93,6 +112,99 @@ ExportGraphBuilder::process_normalize ()
 	return normalizers.empty();
 }
 
+/** Run every channel config (for a stem export, every stem) at once,
+ *  and wait for them all.
+ */
+void
+ExportGraphBuilder::run_channel_configs (framecnt_t frames, bool last_cycle)
+{
+	start_jobs (channel_configs.size());
+
+	for (ChannelConfigList::iterator it = channel_configs.begin(); it != channel_configs.end(); ++it) {
+		thread_pool.push (sigc::bind (sigc::mem_fun (*this, &ExportGraphBuilder::run_channel_config), &*it, frames, last_cycle));
+	}
+
+	wait_for_jobs ();
+}
+
+void
+ExportGraphBuilder::run_channel_config (ChannelConfig* c, framecnt_t frames, bool last_cycle)
+{
+	try {
+		c->process (frames, last_cycle);
+	} catch (std::exception const & e) {
+		job_failed (e);
+	}
+
+	job_done ();
+}
+
+/** Run one cycle of every normalizer at once, and wait for them all */
+void
+ExportGraphBuilder::run_normalizers ()
+{
+	start_jobs (normalizers.size());
+
+	for (std::list<Normalizer *>::iterator it = normalizers.begin(); it != normalizers.end(); ++it) {
+		normalize_pool.push (sigc::bind (sigc::mem_fun (*this, &ExportGraphBuilder::run_normalizer), *it));
+	}
+
+	wait_for_jobs ();
+}
+
+void
+ExportGraphBuilder::run_normalizer (Normalizer* n)
+{
+	try {
+		n->process ();
+	} catch (std::exception const & e) {
+		job_failed (e);
+	}
+
+	job_done ();
+}
+
+void
+ExportGraphBuilder::start_jobs (unsigned n)
+{
+	jobs_exception.reset ();
+	g_atomic_int_set (&jobs_running, n);
+}
+
+void
+ExportGraphBuilder::job_failed (std::exception const & e)
+{
+	// Only the first exception is passed on, as Threader does
+	Glib::Threads::Mutex::Lock lm (jobs_mutex);
+	if (!jobs_exception) {
+		jobs_exception.reset (new ThreaderException (*this, e));
+	}
+}
+
+void
+ExportGraphBuilder::job_done ()
+{
+	if (g_atomic_int_dec_and_test (&jobs_running)) {
+		Glib::Threads::Mutex::Lock lm (jobs_mutex);
+		jobs_cond.signal ();
+	}
+}
+
+void
+ExportGraphBuilder::wait_for_jobs ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (jobs_mutex);
+		while (g_atomic_int_get (&jobs_running) != 0) {
+			jobs_cond.wait (jobs_mutex);
+		}
+	}
+
+	if (jobs_exception) {
+		throw *jobs_exception;
+	}
+}
+
 unsigned
 ExportGraphBuilder::get_normalize_cycle_count() const
 {
@@ -364,37 +476,58 @@ ExportGraphBuilder::SFC::operator== (FileSpec const & other_config) const
 	return config.format->sample_format() == other_config.format->sample_format();
 }
 
+float
+ExportGraphBuilder::SFC::normalize_target () const
+{
+	return config.format->normalize_target();
+}
+
 /* Normalizer */
 
 ExportGraphBuilder::Normalizer::Normalizer (ExportGraphBuilder & parent, FileSpec const & new_config, framecnt_t /*max_frames*/)
 	: parent (parent)
+	, _finished (false)
 {
-	std::string tmpfile_path = parent.session.session_directory().export_path();
-	tmpfile_path = Glib::build_filename(tmpfile_path, "XXXXXX");
-	std::vector<char> tmpfile_path_buf(tmpfile_path.size() + 1);
-	std::copy(tmpfile_path.begin(), tmpfile_path.end(), tmpfile_path_buf.begin());
-	tmpfile_path_buf[tmpfile_path.size()] = '\0';
-
 	config = new_config;
 	uint32_t const channels = config.channel_config->get_n_chans();
 	max_frames_out = 4086 - (4086 % channels); // TODO good chunk size
 	
 	buffer.reset (new AllocatingProcessContext<Sample> (max_frames_out, channels));
 	peak_reader.reset (new PeakReader ());
-	normalizer.reset (new AudioGrapher::Normalizer (config.format->normalize_target()));
 	threader.reset (new Threader<Sample> (parent.thread_pool));
 
-	normalizer->alloc_buffer (max_frames_out);
-	normalizer->add_output (threader);
+	/* How much we will be given, in samples: the timespan and any
+	   silence added to it, at the export's rate.
+	*/
+	framecnt_t const session_rate = parent.session.nominal_frame_rate();
+	framecnt_t const in = parent.timespan->get_length()
+		+ config.format->silence_beginning_at (parent.timespan->get_start(), session_rate)
+		+ config.format->silence_end_at (parent.timespan->get_end(), session_rate);
+	framecnt_t const samples = (framecnt_t) std::ceil ((double) in * config.format->sample_rate() / session_rate) * channels;
 
-	int format = ExportFormatBase::F_RAW | ExportFormatBase::SF_Float;
-	tmp_file.reset (new TmpFile<float> (&tmpfile_path_buf[0], format, channels, config.format->sample_rate()));
-	tmp_file->FileWritten.connect_same_thread (post_processing_connection,
-	                                           boost::bind (&Normalizer::start_post_processing, this));
+	if (samples * sizeof (Sample) <= (uint64_t) Config->get_export_normalize_memory() * 1048576) {
 
-	add_child (new_config);
+		tmp_buffer.reset (new TmpBuffer<Sample> (channels, samples));
+		tmp_buffer->BufferWritten.connect_same_thread (post_processing_connection,
+		                                               boost::bind (&Normalizer::start_post_processing, this));
+		peak_reader->add_output (tmp_buffer);
+
+	} else {
 
-	peak_reader->add_output (tmp_file);
+		std::string tmpfile_path = parent.session.session_directory().export_path();
+		tmpfile_path = Glib::build_filename(tmpfile_path, "XXXXXX");
+		std::vector<char> tmpfile_path_buf(tmpfile_path.size() + 1);
+		std::copy(tmpfile_path.begin(), tmpfile_path.end(), tmpfile_path_buf.begin());
+		tmpfile_path_buf[tmpfile_path.size()] = '\0';
+
+		int format = ExportFormatBase::F_RAW | ExportFormatBase::SF_Float;
+		tmp_file.reset (new TmpFile<float> (&tmpfile_path_buf[0], format, channels, config.format->sample_rate()));
+		tmp_file->FileWritten.connect_same_thread (post_processing_connection,
+		                                           boost::bind (&Normalizer::start_post_processing, this));
+		peak_reader->add_output (tmp_file);
+	}
+
+	add_child (new_config);
 }
 
 ExportGraphBuilder::FloatSinkPtr
@@ -407,14 +540,23 @@ void
 ExportGraphBuilder::Normalizer::add_child (FileSpec const & new_config)
 {
 	for (boost::ptr_list<SFC>::iterator it = children.begin(); it != children.end(); ++it) {
-		if (*it == new_config) {
+		if (*it == new_config && it->normalize_target() == new_config.format->normalize_target()) {
 			it->add_child (new_config);
 			return;
 		}
 	}
 
+	/* Each child gets its own gain, rather than each target, so that the
+	   threader can give every format a thread of its own.
+	*/
 	children.push_back (new SFC (parent, new_config, max_frames_out));
-	threader->add_output (children.back().sink());
+
+	NormalizerPtr normalizer (new AudioGrapher::Normalizer (new_config.format->normalize_target()));
+	normalizer->alloc_buffer (max_frames_out);
+	normalizer->add_output (children.back().sink());
+	normalizers.push_back (normalizer);
+
+	threader->add_output (normalizer);
 }
 
 void
@@ -426,35 +568,51 @@ ExportGraphBuilder::Normalizer::remove_children (bool remove_out_files)
 		iter->remove_children (remove_out_files);
 		iter = children.erase (iter);
 	}
+
+	threader->clear_outputs ();
+	normalizers.clear ();
 }
     
 bool
 ExportGraphBuilder::Normalizer::operator== (FileSpec const & other_config) const
 {
-	return config.format->normalize() == other_config.format->normalize() &&
-		config.format->normalize_target() == other_config.format->normalize_target();
+	/* one normalizer measures and stores the material for every target */
+	return config.format->normalize() == other_config.format->normalize();
 }
 
 unsigned
 ExportGraphBuilder::Normalizer::get_normalize_cycle_count() const
 {
-	return static_cast<unsigned>(std::ceil(static_cast<float>(tmp_file->get_frames_written()) /
-	                                       max_frames_out));
+	framecnt_t const written = tmp_buffer ? tmp_buffer->get_frames_written() : tmp_file->get_frames_written();
+	return static_cast<unsigned>(std::ceil(static_cast<float>(written) / max_frames_out));
 }
 
 bool
 ExportGraphBuilder::Normalizer::process()
 {
-	framecnt_t frames_read = tmp_file->read (*buffer);
-	return frames_read != buffer->frames();
+	framecnt_t frames_read = tmp_buffer ? tmp_buffer->read (*buffer) : tmp_file->read (*buffer);
+	_finished = (frames_read != buffer->frames());
+	return _finished;
 }
 
 void
 ExportGraphBuilder::Normalizer::start_post_processing()
 {
-	normalizer->set_peak (peak_reader->get_peak());
-	tmp_file->seek (0, SEEK_SET);
-	tmp_file->add_output (normalizer);
+	float const peak = peak_reader->get_peak();
+
+	for (std::list<NormalizerPtr>::iterator it = normalizers.begin(); it != normalizers.end(); ++it) {
+		(*it)->set_peak (peak);
+	}
+
+	if (tmp_buffer) {
+		tmp_buffer->rewind ();
+		tmp_buffer->add_output (threader);
+	} else {
+		tmp_file->seek (0, SEEK_SET);
+		tmp_file->add_output (threader);
+	}
+
+	Glib::Threads::Mutex::Lock lm (parent.jobs_mutex);
 	parent.normalizers.push_back (this);
 }
 
@@ -598,6 +756,7 @@ ExportGraphBuilder::SilenceHandler::operator== (FileSpec const & other_config) c
 
 ExportGraphBuilder::ChannelConfig::ChannelConfig (ExportGraphBuilder & parent, FileSpec const & new_config, ChannelMap & channel_map)
 	: parent (parent)
+	, channel_map (channel_map)
 {
 	typedef ExportChannelConfiguration::ChannelList ChannelList;
 
@@ -616,22 +775,32 @@ ExportGraphBuilder::ChannelConfig::ChannelConfig (ExportGraphBuilder & parent, F
 	chunker.reset (new Chunker<Sample> (max_frames_out));
 	interleaver->add_output(chunker);
 
+	// Channels shared with other configs are read only once
 	ChannelList const & channel_list = config.channel_config->get_channels();
-	unsigned chan = 0;
-	for (ChannelList::const_iterator it = channel_list.begin(); it != channel_list.end(); ++it, ++chan) {
-		ChannelMap::iterator map_it = channel_map.find (*it);
-		if (map_it == channel_map.end()) {
-			std::pair<ChannelMap::iterator, bool> result_pair =
-				channel_map.insert (std::make_pair (*it, IdentityVertexPtr (new IdentityVertex<Sample> ())));
-			assert (result_pair.second);
-			map_it = result_pair.first;
-		}
-		map_it->second->add_output (interleaver->input (chan));
+	for (ChannelList::const_iterator it = channel_list.begin(); it != channel_list.end(); ++it) {
+		channel_map.insert (std::make_pair (*it, (Sample const *) 0));
 	}
 
 	add_child (new_config);
 }
 
+void
+ExportGraphBuilder::ChannelConfig::process (framecnt_t frames, bool last_cycle)
+{
+	typedef ExportChannelConfiguration::ChannelList ChannelList;
+
+	ChannelList const & channel_list = config.channel_config->get_channels();
+	unsigned chan = 0;
+	for (ChannelList::const_iterator it = channel_list.begin(); it != channel_list.end(); ++it, ++chan) {
+		/* the map is shared with other configs, which may be running now; look, don't touch */
+		ChannelMap::const_iterator const c = channel_map.find (*it);
+		assert (c != channel_map.end());
+		ConstProcessContext<Sample> context (c->second, frames, 1);
+		if (last_cycle) { context().set_flag (ProcessContext<Sample>::EndOfInput); }
+		interleaver->input (chan)->process (context);
+	}
+}
+
 void
 ExportGraphBuilder::ChannelConfig::add_child (FileSpec const & new_config)
 {
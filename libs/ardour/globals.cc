@@ -134,6 +134,18 @@ apply_gain_to_buffer_t  ARDOUR::apply_gain_to_buffer = 0;
 mix_buffers_with_gain_t ARDOUR::mix_buffers_with_gain = 0;
 mix_buffers_no_gain_t   ARDOUR::mix_buffers_no_gain = 0;
 copy_vector_t			ARDOUR::copy_vector = 0;
+apply_gain_ramp_t              ARDOUR::apply_gain_ramp = 0;
+apply_gain_vector_t            ARDOUR::apply_gain_vector = 0;
+apply_gain_vector_t            ARDOUR::apply_inverse_gain_vector = 0;
+mix_buffers_with_gain_vector_t ARDOUR::mix_buffers_with_gain_vector = 0;
+interleave_t                   ARDOUR::interleave = 0;
+interleave_t                   ARDOUR::deinterleave = 0;
+float_to_int16_t               ARDOUR::float_to_int16 = 0;
+int16_to_float_t               ARDOUR::int16_to_float = 0;
+float_to_int32_t               ARDOUR::float_to_int24 = 0;
+int32_to_float_t               ARDOUR::int24_to_float = 0;
+float_to_int32_t               ARDOUR::float_to_int32 = 0;
+int32_to_float_t               ARDOUR::int32_to_float = 0;
 
 PBD::Signal1<void,std::string> ARDOUR::BootMessage;
 PBD::Signal3<void,std::string,std::string,bool> ARDOUR::PluginScanMessage;
@@ -152,17 +164,70 @@ extern void setup_enum_writer ();
 */
 PBD::PropertyChange ARDOUR::bounds_change;
 
+static void
+setup_generic_kernels ()
+{
+	apply_gain_ramp              = default_apply_gain_ramp;
+	apply_gain_vector            = default_apply_gain_vector;
+	apply_inverse_gain_vector    = default_apply_inverse_gain_vector;
+	mix_buffers_with_gain_vector = default_mix_buffers_with_gain_vector;
+	interleave                   = default_interleave;
+	deinterleave                 = default_deinterleave;
+	float_to_int16               = default_float_to_int16;
+	int16_to_float               = default_int16_to_float;
+	float_to_int24               = default_float_to_int24;
+	int24_to_float               = default_int24_to_float;
+	float_to_int32               = default_float_to_int32;
+	int32_to_float               = default_int32_to_float;
+}
+
 void
 setup_hardware_optimization (bool try_optimization)
 {
 	bool generic_mix_functions = true;
 
+	/* any kernel without an optimized version for the instruction set
+	   chosen below stays with its default.
+	*/
+	setup_generic_kernels ();
+
 	if (try_optimization) {
 
 		FPU fpu;
 
 #if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
 
+#ifdef BUILD_AVX2_OPTIMIZATIONS
+		if (fpu.has_avx2() && fpu.has_fma()) {
+
+			info << "Using AVX2/FMA optimized routines" << endmsg;
+
+			__current_fpu_optimization = AVX2;
+
+			// AVX2 SET
+			compute_peak                 = x86_avx2_compute_peak;
+			find_peaks                   = x86_avx2_find_peaks;
+			apply_gain_to_buffer         = x86_avx2_apply_gain_to_buffer;
+			mix_buffers_with_gain        = x86_avx2_mix_buffers_with_gain;
+			mix_buffers_no_gain          = x86_avx2_mix_buffers_no_gain;
+			copy_vector                  = default_copy_vector;
+			apply_gain_ramp              = x86_avx2_apply_gain_ramp;
+			apply_gain_vector            = x86_avx2_apply_gain_vector;
+			apply_inverse_gain_vector    = x86_avx2_apply_inverse_gain_vector;
+			mix_buffers_with_gain_vector = x86_avx2_mix_buffers_with_gain_vector;
+			interleave                   = x86_avx2_interleave;
+			deinterleave                 = x86_avx2_deinterleave;
+			float_to_int16               = x86_avx2_float_to_int16;
+			int16_to_float               = x86_avx2_int16_to_float;
+			float_to_int24               = x86_avx2_float_to_int24;
+			int24_to_float               = x86_avx2_int24_to_float;
+			float_to_int32               = x86_avx2_float_to_int32;
+			int32_to_float               = x86_avx2_int32_to_float;
+
+			generic_mix_functions = false;
+
+		} else
+#endif
 		if (fpu.has_avx()) {
 
 			info << "Using AVX optimized routines" << endmsg;
@@ -177,6 +242,12 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_no_gain   = x86_sse_avx_mix_buffers_no_gain;
 			copy_vector           = x86_sse_avx_copy_vector;
 
+			apply_gain_ramp              = x86_sse_apply_gain_ramp;
+			apply_gain_vector            = x86_sse_apply_gain_vector;
+			apply_inverse_gain_vector    = x86_sse_apply_inverse_gain_vector;
+			mix_buffers_with_gain_vector = x86_sse_mix_buffers_with_gain_vector;
+			deinterleave                 = x86_sse_deinterleave;
+
 			generic_mix_functions = false;
 
 		} else if (fpu.has_sse()) {
@@ -193,6 +264,12 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_no_gain   = x86_sse_mix_buffers_no_gain;
 			copy_vector           = default_copy_vector;
 
+			apply_gain_ramp              = x86_sse_apply_gain_ramp;
+			apply_gain_vector            = x86_sse_apply_gain_vector;
+			apply_inverse_gain_vector    = x86_sse_apply_inverse_gain_vector;
+			mix_buffers_with_gain_vector = x86_sse_mix_buffers_with_gain_vector;
+			deinterleave                 = x86_sse_deinterleave;
+
 			generic_mix_functions = false;
 
 		}
@@ -211,6 +288,9 @@ setup_hardware_optimization (bool try_optimization)
 			mix_buffers_no_gain    = veclib_mix_buffers_no_gain;
 			copy_vector            = default_copy_vector;
 
+			apply_gain_vector            = veclib_apply_gain_vector;
+			mix_buffers_with_gain_vector = veclib_mix_buffers_with_gain_vector;
+
 			generic_mix_functions = false;
 
 			info << "Apple VecLib H/W specific optimizations in use" << endmsg;
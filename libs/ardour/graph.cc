@@ -18,9 +18,11 @@
 
 */
 #include <stdio.h>
+#include <cassert>
 #include <cmath>
 
 #include "pbd/compose.h"
+#include "pbd/cpus.h"
 #include "pbd/debug_rt_alloc.h"
 #include "pbd/pthread_utils.h"
 
@@ -31,6 +33,7 @@
 #include "ardour/route.h"
 #include "ardour/process_thread.h"
 #include "ardour/audioengine.h"
+#include "ardour/utils.h"
 
 #include "i18n.h"
 
@@ -51,10 +54,128 @@ int alloc_allowed ()
 }
 #endif
 
+/** A fixed-size work-stealing deque of nodes that are ready to run
+ *  (after Chase & Lev, "Dynamic Circular Work-Stealing Deque").
+ *
+ *  Only the owning thread calls push() and pop(), at the bottom; any thread
+ *  may steal() from the top. Indices increase monotonically and are
+ *  compared by difference, so they may wrap.
+ */
+class Graph::WorkQueue
+{
+public:
+	WorkQueue (uint32_t size, uint32_t idx)
+		: index (idx)
+		, _mask (size - 1)
+		, _buf (new GraphNode*[size])
+	{
+		/* size must be a power of two */
+		assert ((size & _mask) == 0);
+		g_atomic_int_set (&_top, 0);
+		g_atomic_int_set (&_bottom, 0);
+	}
+
+	~WorkQueue () { delete [] _buf; }
+
+	/** @return false if the queue is full */
+	bool push (GraphNode* n) {
+		gint const b = g_atomic_int_get (&_bottom);
+		gint const t = g_atomic_int_get (&_top);
+
+		if (distance (t, b) > (gint) _mask) {
+			return false;
+		}
+
+		g_atomic_pointer_set (&_buf[b & _mask], n);
+		g_atomic_int_set (&_bottom, b + 1);
+		return true;
+	}
+
+	GraphNode* pop () {
+		gint const b = g_atomic_int_get (&_bottom) - 1;
+		g_atomic_int_set (&_bottom, b);
+		gint const t = g_atomic_int_get (&_top);
+
+		if (distance (t, b) < 0) {
+			/* empty */
+			g_atomic_int_set (&_bottom, b + 1);
+			return 0;
+		}
+
+		GraphNode* n = (GraphNode*) g_atomic_pointer_get (&_buf[b & _mask]);
+
+		if (t == b) {
+			/* last one: race any thieves for it */
+			if (!g_atomic_int_compare_and_exchange (&_top, t, t + 1)) {
+				n = 0;
+			}
+			g_atomic_int_set (&_bottom, b + 1);
+		}
+
+		return n;
+	}
+
+	/** @return a node, or 0 if the queue was empty or another thread got there first */
+	GraphNode* steal () {
+		gint const t = g_atomic_int_get (&_top);
+		gint const b = g_atomic_int_get (&_bottom);
+
+		if (distance (t, b) <= 0) {
+			return 0;
+		}
+
+		GraphNode* n = (GraphNode*) g_atomic_pointer_get (&_buf[t & _mask]);
+
+		if (!g_atomic_int_compare_and_exchange (&_top, t, t + 1)) {
+			return 0;
+		}
+
+		return n;
+	}
+
+	bool empty () const {
+		return distance (g_atomic_int_get (&_top), g_atomic_int_get (&_bottom)) <= 0;
+	}
+
+	uint32_t const index;
+
+private:
+	static gint distance (gint from, gint to) {
+		return (gint) ((guint) to - (guint) from);
+	}
+
+	guint const   _mask;
+	GraphNode**   _buf;
+	mutable gint  _top;
+	mutable gint  _bottom;
+};
+
+/* the queues are owned by the Graph, not the threads that use them */
+static void
+do_not_delete_the_work_queue (void*)
+{
+}
+
+/** The size of each thread's work queue; nodes that do not fit go to _trigger_queue */
+static const uint32_t work_queue_size = 8192;
+
+/** How many times an idle thread looks for work before it goes to sleep */
+static const uint32_t idle_spins = 512;
+
+static inline void
+spin_pause ()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__asm__ __volatile__ ("pause");
+#endif
+}
+
 Graph::Graph (Session & session)
         : SessionHandleRef (session)
         , _threads_active (false)
+	, _thread_work_queue (do_not_delete_the_work_queue)
 	, _execution_sem ("graph_execution", 0)
+	, _thread_start_sem ("graph_thread_start", 0)
 	, _callback_start_sem ("graph_start", 0)
 	, _callback_done_sem ("graph_done", 0)
 	, _cleanup_sem ("graph_cleanup", 0)
@@ -67,6 +188,13 @@ Graph::Graph (Session & session)
 	_trigger_queue.reserve (8192);
 
         _execution_tokens = 0;
+	_trigger_queue_size = 0;
+	_next_work_queue = 0;
+	_steal_count = 0;
+	_park_count = 0;
+	_wake_count = 0;
+	_cycle_start = 0;
+	_critical_path = 0;
 
         _current_chain = 0;
         _pending_chain = 0;
@@ -117,6 +245,30 @@ Graph::reset_thread_list ()
                 drop_threads ();
         }
 
+	/* one work queue for each thread; each thread claims one as it starts */
+
+	for (vector<WorkQueue*>::iterator q = _work_queues.begin(); q != _work_queues.end(); ++q) {
+		delete *q;
+	}
+	_work_queues.clear ();
+
+	for (uint32_t i = 0; i < num_threads; ++i) {
+		_work_queues.push_back (new WorkQueue (work_queue_size, i));
+	}
+
+	g_atomic_int_set (&_next_work_queue, 0);
+	g_atomic_int_set (&_steal_count, 0);
+	g_atomic_int_set (&_park_count, 0);
+	g_atomic_int_set (&_wake_count, 0);
+
+	_thread_busy.assign (num_threads, 0);
+	_thread_idle.assign (num_threads, DSPTimings ());
+
+	_thread_cpus = process_thread_cpus ();
+
+	/* Set before the threads start, as they go straight into run_one() */
+	_threads_active = true;
+
 	if (AudioEngine::instance()->create_process_thread (boost::bind (&Graph::main_thread, this)) != 0) {
 		throw failed_constructor ();
 	}
@@ -126,7 +278,14 @@ Graph::reset_thread_list ()
 			throw failed_constructor ();
 		}
         }
-        _threads_active = true;
+
+	/* Wait for the threads to set themselves up.  We hold the process
+	   lock meanwhile, so ThreadBuffers::ensure_buffers() cannot run while
+	   they move their buffers.
+	*/
+	for (uint32_t i = 0; i < num_threads; ++i) {
+		_thread_start_sem.wait ();
+	}
 }
 
 void
@@ -140,6 +299,12 @@ Graph::session_going_away()
         _init_trigger_list[0].clear();
         _init_trigger_list[1].clear();
         _trigger_queue.clear();
+	_trigger_queue_size = 0;
+
+	for (vector<WorkQueue*>::iterator q = _work_queues.begin(); q != _work_queues.end(); ++q) {
+		delete *q;
+	}
+	_work_queues.clear ();
 }
 
 void
@@ -210,21 +375,143 @@ Graph::prep()
         }
         _finished_refcount = _init_finished_refcount[chain];
 
+	g_atomic_int_set (&_critical_path, 0);
+	_cycle_start = DSPProfiler::enabled () ? get_microseconds () : 0;
+
 	/* Trigger the initial nodes for processing, which are the ones at the `input' end */
-	pthread_mutex_lock (&_trigger_mutex);
         for (i=_init_trigger_list[chain].begin(); i!=_init_trigger_list[chain].end(); i++) {
-		/* don't use ::trigger here, as we have already locked the mutex */
-                _trigger_queue.push_back (i->get ());
+                trigger (i->get ());
         }
-	pthread_mutex_unlock (&_trigger_mutex);
 }
 
+/** Queue a node which is ready to run; called from GraphNode::finish() and prep() */
 void
 Graph::trigger (GraphNode* n)
 {
-	pthread_mutex_lock (&_trigger_mutex);
-        _trigger_queue.push_back (n);
-	pthread_mutex_unlock (&_trigger_mutex);
+	WorkQueue* q = _thread_work_queue.get ();
+
+	if (!q || !q->push (n)) {
+		pthread_mutex_lock (&_trigger_mutex);
+		_trigger_queue.push_back (n);
+		g_atomic_int_inc (&_trigger_queue_size);
+		pthread_mutex_unlock (&_trigger_mutex);
+	}
+
+	wake_one ();
+}
+
+/** Wake one sleeping thread, if there are any */
+void
+Graph::wake_one ()
+{
+	gint tokens;
+
+	while ((tokens = g_atomic_int_get (&_execution_tokens)) > 0) {
+		if (g_atomic_int_compare_and_exchange (&_execution_tokens, tokens, tokens - 1)) {
+			g_atomic_int_inc (&_wake_count);
+			_execution_sem.signal ();
+			break;
+		}
+	}
+}
+
+/** @return true if there is a node waiting to run in any queue */
+bool
+Graph::work_available () const
+{
+	if (g_atomic_int_get (const_cast<gint*> (&_trigger_queue_size)) > 0) {
+		return true;
+	}
+
+	for (vector<WorkQueue*>::const_iterator q = _work_queues.begin(); q != _work_queues.end(); ++q) {
+		if (!(*q)->empty ()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Find a node to run: from our own queue if we can, otherwise by
+ *  stealing from another thread's, or from the shared trigger queue.
+ *  @param q The calling thread's queue.
+ */
+GraphNode*
+Graph::find_work (WorkQueue* q)
+{
+	GraphNode* n;
+
+	if ((n = q->pop ()) != 0) {
+		return n;
+	}
+
+	uint32_t const nqueues = _work_queues.size ();
+
+	for (uint32_t i = 1; i < nqueues; ++i) {
+		if ((n = _work_queues[(q->index + i) % nqueues]->steal ()) != 0) {
+			g_atomic_int_inc (&_steal_count);
+			return n;
+		}
+	}
+
+	if (g_atomic_int_get (&_trigger_queue_size) > 0) {
+		pthread_mutex_lock (&_trigger_mutex);
+		if (!_trigger_queue.empty ()) {
+			n = _trigger_queue.back ();
+			_trigger_queue.pop_back ();
+			g_atomic_int_dec_and_test (&_trigger_queue_size);
+		}
+		pthread_mutex_unlock (&_trigger_mutex);
+	}
+
+	return n;
+}
+
+void
+Graph::scheduler_counts (uint32_t& steals, uint32_t& parks, uint32_t& wakes) const
+{
+	steals = g_atomic_int_get (const_cast<gint*> (&_steal_count));
+	parks = g_atomic_int_get (const_cast<gint*> (&_park_count));
+	wakes = g_atomic_int_get (const_cast<gint*> (&_wake_count));
+}
+
+void
+Graph::thread_idle_stats (vector<DSPTimingStats>& stats)
+{
+	/* the process lock stops reset_thread_list() changing _thread_idle under our feet */
+	Glib::Threads::Mutex::Lock lm (_session.engine().process_lock());
+
+	stats.clear ();
+	for (vector<DSPTimings>::const_iterator i = _thread_idle.begin(); i != _thread_idle.end(); ++i) {
+		stats.push_back (i->stats ());
+	}
+}
+
+void
+Graph::reset_dsp_timings ()
+{
+	Glib::Threads::Mutex::Lock lm (_session.engine().process_lock());
+
+	_critical_path_timings.reset ();
+	for (vector<DSPTimings>::iterator i = _thread_idle.begin(); i != _thread_idle.end(); ++i) {
+		i->reset ();
+	}
+}
+
+/** Called by the thread which finishes the last node of a cycle, when the
+ *  cycle was started with DSP profiling enabled.
+ */
+void
+Graph::add_cycle_timings ()
+{
+	microseconds_t const cycle = get_microseconds () - _cycle_start;
+
+	_critical_path_timings.add (g_atomic_int_get (&_critical_path));
+
+	for (size_t i = 0; i < _thread_busy.size(); ++i) {
+		_thread_idle[i].add (cycle > _thread_busy[i] ? cycle - _thread_busy[i] : 0);
+		_thread_busy[i] = 0;
+	}
 }
 
 /** Called when a node at the `output' end of the chain (ie one that has no-one to feed)
@@ -239,6 +526,10 @@ Graph::dec_ref()
 		   the graph, so there is nothing more to do this time around.
 		*/
 
+		if (_cycle_start) {
+			add_cycle_timings ();
+		}
+
 		restart_cycle ();
         }
 }
@@ -246,6 +537,14 @@ Graph::dec_ref()
 void
 Graph::restart_cycle()
 {
+#ifndef NDEBUG
+	if (DEBUG_ENABLED (DEBUG::ProcessThreads)) {
+		uint32_t steals, parks, wakes;
+		scheduler_counts (steals, parks, wakes);
+		DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("graph cycle done, steals %1 parks %2 wakes %3\n", steals, parks, wakes));
+	}
+#endif
+
         // we are through. wakeup our caller.
 
   again:
@@ -348,50 +647,77 @@ Graph::rechain (boost::shared_ptr<RouteList> routelist, GraphEdges const & edges
 bool
 Graph::run_one()
 {
-        GraphNode* to_run;
+	WorkQueue* q = _thread_work_queue.get ();
+	GraphNode* to_run = find_work (q);
+	uint32_t spins = 0;
 
-        pthread_mutex_lock (&_trigger_mutex);
-        if (_trigger_queue.size()) {
-                to_run = _trigger_queue.back();
-                _trigger_queue.pop_back();
-        } else {
-                to_run = 0;
-        }
+	while (to_run == 0) {
 
-	/* the number of threads that are asleep */
-	int et = _execution_tokens;
-	/* the number of nodes that need to be run */
-	int ts = _trigger_queue.size();
+		/* _threads_active is only looked at once we have slept, as
+		   drop_threads() wakes every sleeper; a thread which is still
+		   starting up may spin here before it has been set.
+		*/
 
-	/* hence how many threads to wake up */
-        int wakeup = min (et, ts);
-	/* update the number of threads that will still be sleeping */
-        _execution_tokens -= wakeup;
+		if (++spins < idle_spins) {
+			spin_pause ();
+			to_run = find_work (q);
+			continue;
+		}
 
-        DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 signals %2\n", pthread_name(), wakeup));
+		/* nothing to do for a while: go to sleep. Register as a
+		   sleeper before looking once more, so that a node queued in
+		   the meantime is either seen here or wakes us.
+		*/
 
-        for (int i = 0; i < wakeup; i++) {
-                _execution_sem.signal ();
-        }
+		g_atomic_int_inc (&_execution_tokens);
 
-        while (to_run == 0) {
-                _execution_tokens += 1;
-                pthread_mutex_unlock (&_trigger_mutex);
+		if (work_available ()) {
+			/* take a token back; the CAS may fail only because another
+			   thread changed the count, so try again until we get one or
+			   there are none left.
+			*/
+			bool took = false;
+			gint tokens;
+			while ((tokens = g_atomic_int_get (&_execution_tokens)) > 0) {
+				if (g_atomic_int_compare_and_exchange (&_execution_tokens, tokens, tokens - 1)) {
+					took = true;
+					break;
+				}
+			}
+			if (took) {
+				/* nobody will signal on our behalf now */
+				spins = 0;
+				to_run = find_work (q);
+				continue;
+			}
+			/* somebody has already signalled on our behalf; the wait
+			   below will return at once.
+			*/
+		}
+
+		g_atomic_int_inc (&_park_count);
                 DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 goes to sleep\n", pthread_name()));
                 _execution_sem.wait ();
                 if (!_threads_active) {
                         return true;
                 }
                 DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 is awake\n", pthread_name()));
-                pthread_mutex_lock (&_trigger_mutex);
-                if (_trigger_queue.size()) {
-                        to_run = _trigger_queue.back();
-                        _trigger_queue.pop_back();
-                }
-        }
-        pthread_mutex_unlock (&_trigger_mutex);
 
-        to_run->process();
+		spins = 0;
+		to_run = find_work (q);
+	}
+
+	if (DSPProfiler::enabled ()) {
+		microseconds_t const start = get_microseconds ();
+		to_run->process ();
+		gint const busy = get_microseconds () - start;
+		/* nodes which feed this one have finished, so only we touch its path now */
+		g_atomic_int_add (&to_run->_path, busy);
+		_thread_busy[q->index] += busy;
+	} else {
+		to_run->process();
+	}
+
         to_run->finish (_current_chain);
 
         DEBUG_TRACE(DEBUG::ProcessThreads, string_compose ("%1 has finished run_one()\n", pthread_name()));
@@ -399,6 +725,44 @@ Graph::run_one()
         return false;
 }
 
+/** Give the calling process thread its own work queue.
+ *  @return the queue's index.
+ */
+uint32_t
+Graph::claim_work_queue ()
+{
+	gint const idx = g_atomic_int_add (&_next_work_queue, 1);
+	assert (idx < (gint) _work_queues.size ());
+	_thread_work_queue.set (_work_queues[idx]);
+	return idx;
+}
+
+/** Set up the calling process thread: give it its buffers and a work queue
+ *  and, if we have been given CPUs to use, pin it to one of them and move
+ *  its buffers onto the local NUMA node.
+ */
+void
+Graph::setup_thread (ProcessThread* pt)
+{
+        pt->get_buffers();
+	uint32_t const idx = claim_work_queue ();
+
+	if (!_thread_cpus.empty ()) {
+		uint32_t const cpu = _thread_cpus[idx % _thread_cpus.size()];
+
+		suspend_rt_malloc_checks ();
+		if (set_thread_cpus (vector<uint32_t> (1, cpu)) == 0) {
+			pt->reallocate_buffers ();
+			DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 pinned to CPU %2\n", pthread_name(), cpu));
+		} else {
+			DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 could not be pinned to CPU %2\n", pthread_name(), cpu));
+		}
+		resume_rt_malloc_checks ();
+	}
+
+	_thread_start_sem.signal ();
+}
+
 void
 Graph::helper_thread()
 {
@@ -406,7 +770,7 @@ Graph::helper_thread()
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
 
-        pt->get_buffers();
+	setup_thread (pt);
 
         while(1) {
                 if (run_one()) {
@@ -425,7 +789,7 @@ Graph::main_thread()
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
 
-        pt->get_buffers();
+	setup_thread (pt);
 
   again:
         _callback_start_sem.wait ();
@@ -570,6 +934,8 @@ Graph::process_one_route (Route* route)
 
         DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 runs route %2\n", pthread_name(), route->name()));
 
+	DSPTimer timer (route->dsp_timings ());
+
         if (_process_silent) {
                 retval = route->silent_roll (_process_nframes, _process_start_frame, _process_end_frame, need_butler);
         } else if (_process_noroll) {
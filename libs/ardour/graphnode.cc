@@ -27,6 +27,17 @@ using namespace ARDOUR;
 GraphNode::GraphNode (boost::shared_ptr<Graph> graph)
         : _graph(graph)
 {
+	g_atomic_int_set (&_path, 0);
+}
+
+/** Set *target to the larger of itself and v */
+static void
+atomic_max (volatile gint* target, gint v)
+{
+	gint old = g_atomic_int_get (target);
+	while (v > old && !g_atomic_int_compare_and_exchange (target, old, v)) {
+		old = g_atomic_int_get (target);
+	}
 }
 
 GraphNode::~GraphNode()
@@ -38,6 +49,7 @@ GraphNode::prep (int chain)
 {
 	/* This is the number of nodes that directly feed us */
         _refcount = _init_refcount[chain];
+	g_atomic_int_set (&_path, 0);
 }
 
 /** Called by another node to tell us that one of the nodes that feed us
@@ -59,14 +71,23 @@ GraphNode::finish (int chain)
 {
         node_set_t::iterator i;
         bool feeds_somebody = false;
+	bool const profiling = DSPProfiler::enabled ();
+	gint const path = g_atomic_int_get (&_path);
 
 	/* Tell the nodes that we feed that we've finished */
         for (i=_activation_set[chain].begin(); i!=_activation_set[chain].end(); i++) {
+		if (profiling) {
+			/* before dec_ref(), which may start the node running */
+			atomic_max (&(*i)->_path, path);
+		}
                 (*i)->dec_ref();
                 feeds_somebody = true;
         }
 
         if (!feeds_somebody) {
+		if (profiling) {
+			atomic_max (&_graph->_critical_path, path);
+		}
 		/* This node does not feed anybody, so decrement the graph's finished count */
                 _graph->dec_ref();
         }
@@ -376,9 +376,7 @@ LadspaPlugin::set_state (const XMLNode& node, int version)
 	}
 
 #ifndef NO_PLUGIN_STATE
-	XMLNodeList nodes;
 	XMLProperty *prop;
-	XMLNodeConstIterator iter;
 	XMLNode *child;
 	const char *port;
 	const char *data;
@@ -393,9 +391,7 @@ LadspaPlugin::set_state (const XMLNode& node, int version)
 
 #ifndef NO_PLUGIN_STATE
 
-	nodes = node.children ("Port");
-
-	for (iter = nodes.begin(); iter != nodes.end(); ++iter) {
+	for (XMLNode::NamedChildIterator iter (node, X_("Port")); !iter.done(); ++iter) {
 
 		child = *iter;
 
@@ -426,9 +422,7 @@ int
 LadspaPlugin::set_state_2X (const XMLNode& node, int /* version */)
 {
 #ifndef NO_PLUGIN_STATE
-	XMLNodeList nodes;
 	XMLProperty *prop;
-	XMLNodeConstIterator iter;
 	XMLNode *child;
 	const char *port;
 	const char *data;
@@ -442,9 +436,7 @@ LadspaPlugin::set_state_2X (const XMLNode& node, int /* version */)
 	}
 
 #ifndef NO_PLUGIN_STATE
-	nodes = node.children ("port");
-
-	for(iter = nodes.begin(); iter != nodes.end(); ++iter){
+	for (XMLNode::NamedChildIterator iter (node, X_("port")); !iter.done(); ++iter) {
 
 		child = *iter;
 
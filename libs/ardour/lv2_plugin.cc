@@ -1560,9 +1560,7 @@ LV2Plugin::set_insert_id(PBD::ID id)
 int
 LV2Plugin::set_state(const XMLNode& node, int version)
 {
-	XMLNodeList          nodes;
 	const XMLProperty*   prop;
-	XMLNodeConstIterator iter;
 	XMLNode*             child;
 	const char*          sym;
 	const char*          value;
@@ -1576,13 +1574,7 @@ LV2Plugin::set_state(const XMLNode& node, int version)
 
 #ifndef NO_PLUGIN_STATE
 
-	if (version < 3000) {
-		nodes = node.children("port");
-	} else {
-		nodes = node.children("Port");
-	}
-
-	for (iter = nodes.begin(); iter != nodes.end(); ++iter) {
+	for (XMLNode::NamedChildIterator iter (node, version < 3000 ? X_("port") : X_("Port")); !iter.done(); ++iter) {
 
 		child = *iter;
 
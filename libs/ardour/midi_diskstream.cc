@@ -1405,6 +1405,16 @@ MidiDiskstream::capture_buffer_load () const
 	return 1;
 }
 
+std::string
+MidiDiskstream::disk_write_path () const
+{
+	if (_write_source) {
+		return _write_source->path ();
+	}
+
+	return Diskstream::disk_write_path ();
+}
+
 int
 MidiDiskstream::use_pending_capture_data (XMLNode& /*node*/)
 {
@@ -1629,7 +1629,9 @@ MidiModel::edit_lock()
 		               ms->session().transport_rolling() ? &_active_notes : NULL);
 	}
 
-	return WriteLock(new WriteLockImpl(source_lock, _lock, _control_lock));
+	WriteLock lock (new WriteLockImpl(source_lock, _lock, _control_lock));
+	mark_timeline_dirty ();
+	return lock;
 }
 
 int
@@ -1663,6 +1665,11 @@ MidiModel::resolve_overlaps_unlocked (const NotePtr note, void* arg)
 		TimeType eb = (*i)->end_time();
 		OverlapType overlap = OverlapNone;
 
+		if (sb > ea) {
+			/* pitches are in time order, so no later note can overlap either */
+			break;
+		}
+
 		if ((sb > sa) && (eb <= ea)) {
 			overlap = OverlapInternal;
 		} else if ((eb >= sa) && (eb <= ea)) {
@@ -142,6 +142,114 @@ default_copy_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pframes_t
 	memcpy(dst, src, nframes*sizeof(ARDOUR::Sample));
 }
 
+gain_t
+default_apply_gain_ramp (ARDOUR::Sample * buf, pframes_t nframes, gain_t initial, gain_t target, gain_t coefficient)
+{
+	double lpf = initial;
+
+	for (pframes_t i = 0; i < nframes; ++i) {
+		buf[i] *= lpf;
+		lpf += coefficient * (target - lpf);
+	}
+
+	return lpf;
+}
+
+void
+default_apply_gain_vector (ARDOUR::Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		buf[i] *= gain[i];
+	}
+}
+
+void
+default_apply_inverse_gain_vector (ARDOUR::Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		buf[i] *= 1 - gain[i];
+	}
+}
+
+void
+default_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const gain_t * gain, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		dst[i] += src[i] * gain[i];
+	}
+}
+
+void
+default_interleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pframes_t nframes, uint32_t nchannels)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		*dst = src[i];
+		dst += nchannels;
+	}
+}
+
+void
+default_deinterleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pframes_t nframes, uint32_t nchannels)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		dst[i] = *src;
+		src += nchannels;
+	}
+}
+
+void
+default_float_to_int16 (int16_t * dst, const ARDOUR::Sample * src, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		const float s = min (1.0f, max (-1.0f, src[i]));
+		dst[i] = (int16_t) (32767.0f * s);
+	}
+}
+
+void
+default_int16_to_float (ARDOUR::Sample * dst, const int16_t * src, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		dst[i] = src[i] * (1.0f / 32767.0f);
+	}
+}
+
+void
+default_float_to_int24 (int32_t * dst, const ARDOUR::Sample * src, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		const float s = min (1.0f, max (-1.0f, src[i]));
+		dst[i] = (int32_t) (8388607.0f * s);
+	}
+}
+
+void
+default_int24_to_float (ARDOUR::Sample * dst, const int32_t * src, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		dst[i] = src[i] * (1.0f / 8388607.0f);
+	}
+}
+
+/* a float cannot hold 2^31 - 1, so these go through double */
+
+void
+default_float_to_int32 (int32_t * dst, const ARDOUR::Sample * src, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		const double s = min (1.0f, max (-1.0f, src[i]));
+		dst[i] = (int32_t) (2147483647.0 * s);
+	}
+}
+
+void
+default_int32_to_float (ARDOUR::Sample * dst, const int32_t * src, pframes_t nframes)
+{
+	for (pframes_t i = 0; i < nframes; ++i) {
+		dst[i] = (float) (src[i] * (1.0 / 2147483647.0));
+	}
+}
+
 #if defined (__APPLE__) && defined (BUILD_VECLIB_OPTIMIZATIONS)
 #include <Accelerate/Accelerate.h>
 
@@ -180,6 +288,18 @@ veclib_mix_buffers_no_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, pf
 	vDSP_vsma(src, 1, &gain, dst, 1, dst, 1, nframes);
 }
 
+void
+veclib_apply_gain_vector (ARDOUR::Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	vDSP_vmul(buf, 1, gain, 1, buf, 1, nframes);
+}
+
+void
+veclib_mix_buffers_with_gain_vector (ARDOUR::Sample * dst, const ARDOUR::Sample * src, const gain_t * gain, pframes_t nframes)
+{
+	vDSP_vma(src, 1, gain, 1, dst, 1, dst, 1, nframes);
+}
+
 #endif
 
 
@@ -33,6 +33,7 @@
 #include "ardour/session.h"
 #include "ardour/region.h"
 #include "ardour/region_factory.h"
+#include "ardour/region_index.h"
 #include "ardour/region_sorters.h"
 #include "ardour/playlist_factory.h"
 #include "ardour/playlist_source.h"
@@ -320,6 +321,11 @@ Playlist::init (bool hide)
 	_capture_insertion_underway = false;
 	_combine_ops = 0;
 	_end_space = 0;
+	g_atomic_int_set (&_region_index_generation, 0);
+	g_atomic_int_set (&_region_index_built, -1);
+	_state_cache = 0;
+	_state_cache_generation = 0;
+	_state_cache_region_generations = 0;
 
 	_session.history().BeginUndoRedo.connect_same_thread (*this, boost::bind (&Playlist::begin_undo, this));
 	_session.history().EndUndoRedo.connect_same_thread (*this, boost::bind (&Playlist::end_undo, this));
@@ -339,6 +345,8 @@ Playlist::~Playlist ()
 		}
 	}
 
+	delete _state_cache;
+
 	/* GoingAway must be emitted by derived classes */
 }
 
@@ -751,6 +759,7 @@ Playlist::flush_notifications (bool from_undo)
 
 	 regions.insert (upper_bound (regions.begin(), regions.end(), region, cmp), region);
 	 all_regions.insert (region);
+	 invalidate_region_index ();
 
 	 possibly_splice_unlocked (position, region->length(), region);
 
@@ -811,6 +820,7 @@ Playlist::flush_notifications (bool from_undo)
 			 framecnt_t distance = (*i)->length();
 
 			 regions.erase (i);
+			 invalidate_region_index ();
 
 			 possibly_splice_unlocked (pos, -distance);
 
@@ -1613,6 +1623,14 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
 	 PropertyChange pos_and_length;
 	 bool save = false;
 
+	 if (what_changed.contains (Properties::position) ||
+	     what_changed.contains (Properties::length) ||
+	     what_changed.contains (Properties::start) ||
+	     what_changed.contains (Properties::sync_position)) {
+		 /* even if we ignore the change, our index of region bounds is now stale */
+		 invalidate_region_index ();
+	 }
+
 	 if (in_set_state || in_flush) {
 		 return false;
 	 }
@@ -1710,6 +1728,57 @@ Playlist::region_bounds_changed (const PropertyChange& what_changed, boost::shar
   FINDING THINGS
   **********************************************************************/
 
+/** Mark the region index as out of date.
+ *  @param rebuild true to also build a new index now (dropping the old
+ *  one, and its references to regions); only safe while holding the
+ *  region lock for writing.
+ */
+void
+Playlist::invalidate_region_index (bool rebuild)
+{
+	g_atomic_int_inc (&_region_index_generation);
+
+	if (rebuild) {
+		Glib::Threads::Mutex::Lock lm (_region_index_lock);
+		gint const generation = g_atomic_int_get (&_region_index_generation);
+		_region_index.reset (new RegionIndex (regions.begin(), regions.end()));
+		g_atomic_int_set (&_region_index_built, generation);
+	}
+}
+
+/** @return an index of the current regions. Caller must hold the region lock,
+ *  but may hold it for reading: the index is built under its own lock.
+ */
+boost::shared_ptr<RegionIndex const>
+Playlist::region_index () const
+{
+	Glib::Threads::Mutex::Lock lm (_region_index_lock);
+
+	gint const generation = g_atomic_int_get (&_region_index_generation);
+
+	if (!_region_index || g_atomic_int_get (&_region_index_built) != generation) {
+		_region_index.reset (new RegionIndex (regions.begin(), regions.end()));
+		g_atomic_int_set (&_region_index_built, generation);
+	}
+
+	return _region_index;
+}
+
+/** @return the region index if it is up to date, otherwise 0; never
+ *  builds one.  Caller must hold the region lock.
+ */
+boost::shared_ptr<RegionIndex const>
+Playlist::current_region_index () const
+{
+	Glib::Threads::Mutex::Lock lm (_region_index_lock);
+
+	if (g_atomic_int_get (&_region_index_built) != g_atomic_int_get (&_region_index_generation)) {
+		return boost::shared_ptr<RegionIndex const> ();
+	}
+
+	return _region_index;
+}
+
 boost::shared_ptr<RegionList>
 Playlist::regions_at (framepos_t frame)
 {
@@ -1721,15 +1790,7 @@ Playlist::regions_at (framepos_t frame)
  Playlist::count_regions_at (framepos_t frame) const
  {
 	 RegionReadLock rlock (const_cast<Playlist*>(this));
-	 uint32_t cnt = 0;
-
-	 for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
-		 if ((*i)->covers (frame)) {
-			 cnt++;
-		 }
-	 }
-
-	 return cnt;
+	 return region_index()->count_at (frame);
  }
 
  boost::shared_ptr<Region>
@@ -1785,13 +1846,7 @@ Playlist::find_regions_at (framepos_t frame)
 	/* Caller must hold lock */
 	
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-	
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->covers (frame)) {
-			rlist->push_back (*i);
-		}
-	}
-	
+	region_index()->at (frame, *rlist);
 	return rlist;
 }
 
@@ -1800,13 +1855,7 @@ Playlist::regions_with_start_within (Evoral::Range<framepos_t> range)
 {
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->first_frame() >= range.from && (*i)->first_frame() <= range.to) {
-			rlist->push_back (*i);
-		}
-	}
-
+	region_index()->with_start_within (range, *rlist);
 	return rlist;
 }
 
@@ -1815,13 +1864,7 @@ Playlist::regions_with_end_within (Evoral::Range<framepos_t> range)
 {
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->last_frame() >= range.from && (*i)->last_frame() <= range.to) {
-			rlist->push_back (*i);
-		}
-	}
-
+	region_index()->with_end_within (range, *rlist);
 	return rlist;
 }
 
@@ -1833,20 +1876,34 @@ boost::shared_ptr<RegionList>
 Playlist::regions_touched (framepos_t start, framepos_t end)
 {
 	RegionReadLock rlock (this);
-	return regions_touched_locked (start, end);
+	boost::shared_ptr<RegionList> rlist (new RegionList);
+	region_index()->touched (start, end, *rlist);
+	return rlist;
 }
 
 boost::shared_ptr<RegionList>
 Playlist::regions_touched_locked (framepos_t start, framepos_t end)
 {
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-	
+
+	/* this is on the butler's read path, so don't build an index here;
+	   one which is out of date (while a region is being dragged, say) is
+	   rebuilt by the next reader elsewhere or the next region write lock.
+	*/
+
+	boost::shared_ptr<RegionIndex const> index = current_region_index ();
+
+	if (index) {
+		index->touched (start, end, *rlist);
+		return rlist;
+	}
+
 	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
 		if ((*i)->coverage (start, end) != Evoral::OverlapNone) {
 			rlist->push_back (*i);
 		}
 	}
-	
+
 	return rlist;
 }
 
@@ -1914,60 +1971,7 @@ boost::shared_ptr<Region>
 Playlist::find_next_region (framepos_t frame, RegionPoint point, int dir)
 {
 	RegionReadLock rlock (this);
-	boost::shared_ptr<Region> ret;
-	framepos_t closest = max_framepos;
-	
-	bool end_iter = false;
-	
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		
-		if(end_iter) break;
-		
-		frameoffset_t distance;
-		boost::shared_ptr<Region> r = (*i);
-		framepos_t pos = 0;
-		
-		switch (point) {
-		case Start:
-			pos = r->first_frame ();
-			break;
-		case End:
-			pos = r->last_frame ();
-			break;
-		case SyncPoint:
-			pos = r->sync_position ();
-			break;
-		}
-		
-		switch (dir) {
-		case 1: /* forwards */
-			
-			if (pos > frame) {
-				if ((distance = pos - frame) < closest) {
-					closest = distance;
-					ret = r;
-					end_iter = true;
-				}
-			}
-			
-			break;
-			
-		default: /* backwards */
-			
-			if (pos < frame) {
-				if ((distance = frame - pos) < closest) {
-					closest = distance;
-					ret = r;
-				}
-			} else {
-				end_iter = true;
-			}
-			
-			break;
-		}
-	}
-	
-	return ret;
+	return region_index()->next (frame, point, dir);
 }
 
  framepos_t
@@ -2185,6 +2189,7 @@ Playlist::find_next_region (framepos_t frame, RegionPoint point, int dir)
 
 	in_set_state--;
 	first_set_state = false;
+	bump_state_generation ();
 
 	return ret;
 }
@@ -2206,6 +2211,45 @@ Playlist::get_template()
 XMLNode&
 Playlist::state (bool full_state)
 {
+	uint32_t generation = 0;
+	uint32_t region_generations = 0;
+	bool cacheable = full_state;
+
+	if (full_state) {
+
+		/* read these before building the state, so that changes made
+		   while we do so are picked up next time.
+		*/
+
+		generation = state_generation ();
+
+		{
+			RegionReadLock rlock (this);
+
+			for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
+				region_generations += (*i)->state_generation ();
+				/* the state of a compound region includes its nested
+				   playlists, whose changes we would not see, and a
+				   region's extra XML may change under us.
+				*/
+				if ((*i)->max_source_level() > 0 || (*i)->has_extra_xml()) {
+					cacheable = false;
+				}
+			}
+		}
+
+		Glib::Threads::Mutex::Lock lm (_state_cache_lock);
+
+		if (cacheable && _state_cache && _state_cache_generation == generation && _state_cache_region_generations == region_generations) {
+			XMLNode* node = new XMLNode (*_state_cache);
+			/* not cached, as it may be changed through extra_xml() */
+			if (_extra_xml) {
+				node->add_child_copy (*_extra_xml);
+			}
+			return *node;
+		}
+	}
+
 	XMLNode *node = new XMLNode (X_("Playlist"));
 	char buf[64];
 
@@ -2228,6 +2272,14 @@ Playlist::state (bool full_state)
 		}
 	}
 
+	if (cacheable) {
+		Glib::Threads::Mutex::Lock lm (_state_cache_lock);
+		delete _state_cache;
+		_state_cache = new XMLNode (*node);
+		_state_cache_generation = generation;
+		_state_cache_region_generations = region_generations;
+	}
+
 	if (_extra_xml) {
 		node->add_child_copy (*_extra_xml);
 	}
@@ -2689,6 +2741,7 @@ void
 Playlist::set_frozen (bool yn)
 {
 	_frozen = yn;
+	bump_state_generation ();
 }
 
 void
@@ -3027,6 +3080,7 @@ Playlist::combine (const RegionList& r)
 	add_region (compound_region, earliest_position);
 
 	_combine_ops++;
+	bump_state_generation ();
 
 	thaw ();
 
@@ -3224,6 +3278,7 @@ void
 Playlist::set_orig_track_id (const PBD::ID& id)
 {
 	_orig_track_id = id;
+	bump_state_generation ();
 }
 
 /** Take a list of ranges, coalesce any that can be coalesced, then call
@@ -21,6 +21,8 @@
 #include "libardour-config.h"
 #endif
 
+#include <cmath>
+#include <limits>
 #include <string>
 
 #include "pbd/failed_constructor.h"
@@ -67,7 +69,10 @@ PluginInsert::PluginInsert (Session& s, boost::shared_ptr<Plugin> plug)
 	: Processor (s, (plug ? plug->name() : string ("toBeRenamed")))
 	, _signal_analysis_collected_nframes(0)
 	, _signal_analysis_collect_nframes_max(0)
+	, _automation_granularity(1)
 {
+	resize_automation_timeline (s.get_block_size ());
+
 	/* the first is the master */
 
 	if (plug) {
@@ -286,10 +291,79 @@ PluginInsert::parameter_changed (uint32_t which, float val)
         }
 }
 
+void
+PluginInsert::add_control (boost::shared_ptr<Evoral::Control> c)
+{
+	Automatable::add_control (c);
+
+	boost::shared_ptr<AutomationControl> ac = boost::dynamic_pointer_cast<AutomationControl> (c);
+
+	if (!ac) {
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock lm (_automation_lock);
+
+	vector<AutomationSlot>::iterator i;
+
+	for (i = _automation.begin(); i != _automation.end(); ++i) {
+		if (i->control->parameter() == ac->parameter()) {
+			break;
+		}
+	}
+
+	if (i != _automation.end()) {
+		*i = AutomationSlot (ac);
+	} else {
+		_automation.push_back (AutomationSlot (ac));
+		_automation_values.resize (_automation_slices.size() * _automation.size());
+	}
+
+	ac->ListReplaced.connect_same_thread (*this, boost::bind (&PluginInsert::automation_list_replaced, this, boost::weak_ptr<AutomationControl> (ac)));
+}
+
+/** Give the slot of a control whose list has been replaced the new list.
+ *  Called from outside the process thread, so the old list is never
+ *  destroyed in it.
+ */
+void
+PluginInsert::automation_list_replaced (boost::weak_ptr<AutomationControl> wc)
+{
+	boost::shared_ptr<AutomationControl> ac = wc.lock ();
+
+	if (!ac) {
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock lm (_automation_lock);
+
+	for (vector<AutomationSlot>::iterator i = _automation.begin(); i != _automation.end(); ++i) {
+		if (i->control == ac) {
+			*i = AutomationSlot (ac);
+		}
+	}
+}
+
+/** Make room for the automation timeline of a cycle of @param nframes, which
+ *  is split into pieces no shorter than the plugin automation granularity.
+ */
+void
+PluginInsert::resize_automation_timeline (pframes_t nframes)
+{
+	Glib::Threads::Mutex::Lock lm (_automation_lock);
+
+	_automation_granularity = max ((framecnt_t) 1, (framecnt_t) Config->get_plugin_automation_granularity ());
+	_automation_slices.resize (nframes / _automation_granularity + 1);
+	_automation_values.resize (_automation_slices.size() * _automation.size());
+}
+
 int
 PluginInsert::set_block_size (pframes_t nframes)
 {
 	int ret = 0;
+
+	resize_automation_timeline (nframes);
+
 	for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
 		if ((*i)->set_block_size (nframes) != 0) {
 			ret = -1;
@@ -327,7 +401,7 @@ PluginInsert::flush ()
 }
 
 void
-PluginInsert::connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t offset, bool with_auto, framepos_t now)
+PluginInsert::connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t offset)
 {
 	// Calculate if, and how many frames we need to collect for analysis
 	framecnt_t collect_signal_nframes = (_signal_analysis_collect_nframes_max -
@@ -363,28 +437,6 @@ PluginInsert::connect_and_run (BufferSet& bufs, pframes_t nframes, framecnt_t of
 	   be able to handle in-place processing.
 	*/
 
-	if (with_auto) {
-
-		uint32_t n = 0;
-
-		for (Controls::iterator li = controls().begin(); li != controls().end(); ++li, ++n) {
-
-			boost::shared_ptr<AutomationControl> c
-				= boost::dynamic_pointer_cast<AutomationControl>(li->second);
-
-			if (c->list() && c->automation_playback()) {
-				bool valid;
-
-				const float val = c->list()->rt_safe_eval (now, valid);
-
-				if (valid) {
-					c->set_value(val);
-				}
-
-			}
-		}
-	}
-
 	if (collect_signal_nframes > 0) {
 		// collect input
 		//std::cerr << "collect input, bufs " << bufs.count().n_audio() << " count,  " << bufs.available().n_audio() << " available" << std::endl;
@@ -467,7 +519,7 @@ PluginInsert::run (BufferSet& bufs, framepos_t start_frame, framepos_t /*end_fra
 		if (_session.transport_rolling() || _session.bounce_processing()) {
 			automation_run (bufs, start_frame, nframes);
 		} else {
-			connect_and_run (bufs, nframes, 0, false);
+			connect_and_run (bufs, nframes, 0);
 		}
 
 	} else {
@@ -541,48 +593,128 @@ PluginInsert::get_parameter (Evoral::Parameter param)
 	}
 }
 
+/** @return the time of the first event in @param list after @param after,
+ *  or the largest double if there is none.  The list must be locked.
+ */
+static double
+next_automation_event (AutomationList const & list, size_t& cursor, double after)
+{
+	if (list.index_current ()) {
+		vector<double> const & when (list.index_when ());
+
+		cursor = list.index_seek (after, cursor);
+
+		while (cursor < when.size() && when[cursor] <= after) {
+			++cursor;
+		}
+
+		return cursor < when.size() ? when[cursor] : numeric_limits<double>::max();
+	}
+
+	Evoral::ControlEvent cp (after, 0.0f);
+	AutomationList::const_iterator i = upper_bound (list.begin(), list.end(), &cp, AutomationList::time_comparator);
+
+	return i != list.end() ? (*i)->when : numeric_limits<double>::max();
+}
+
 void
 PluginInsert::automation_run (BufferSet& bufs, framepos_t start, pframes_t nframes)
 {
-	Evoral::ControlEvent next_event (0, 0.0f);
-	framepos_t now = start;
-	framepos_t end = now + nframes;
-	framecnt_t offset = 0;
+	framepos_t const end = start + nframes;
 
 	Glib::Threads::Mutex::Lock lm (control_lock(), Glib::Threads::TRY_LOCK);
+	Glib::Threads::Mutex::Lock am (_automation_lock, Glib::Threads::TRY_LOCK);
 
-	if (!lm.locked()) {
-		connect_and_run (bufs, nframes, offset, false);
+	if (!lm.locked() || !am.locked()) {
+		connect_and_run (bufs, nframes, 0);
 		return;
 	}
 
-	if (!find_next_event (now, end, next_event) || requires_fixed_sized_buffers()) {
+	/* Lock the lists of the controls which are playing back, so that the
+	   whole of this cycle's timeline comes from one state of each. A list
+	   which is being edited just isn't played for this cycle.
+	*/
+
+	uint32_t const nslots = _automation.size();
+	uint32_t playing = 0;
 
-		/* no events have a time within the relevant range */
+	for (uint32_t s = 0; s < nslots; ++s) {
+		AutomationSlot& slot (_automation[s]);
 
-		connect_and_run (bufs, nframes, offset, true, now);
+		slot.playing = false;
+
+		if (slot.list && slot.list->automation_playback() && slot.list->lock().reader_trylock()) {
+			slot.playing = true;
+			++playing;
+		}
+	}
+
+	if (!playing) {
+		connect_and_run (bufs, nframes, 0);
 		return;
 	}
 
-	while (nframes) {
+	/* Split the cycle at automation events, but never into pieces shorter
+	   than the granularity; an event which falls inside a piece takes
+	   effect at the start of the next one.
+	*/
 
-		framecnt_t cnt = min (((framecnt_t) ceil (next_event.when) - now), (framecnt_t) nframes);
+	uint32_t nslices = 1;
+	_automation_slices[0] = start;
 
-		connect_and_run (bufs, cnt, offset, true, now);
+	if (!requires_fixed_sized_buffers()) {
 
-		nframes -= cnt;
-		offset += cnt;
-		now += cnt;
+		framepos_t now = start;
 
-		if (!find_next_event (now, end, next_event)) {
-			break;
+		while (nslices < _automation_slices.size()) {
+
+			double next = numeric_limits<double>::max();
+
+			for (uint32_t s = 0; s < nslots; ++s) {
+				AutomationSlot& slot (_automation[s]);
+				if (slot.playing) {
+					next = min (next, next_automation_event (*slot.list, slot.cursor, now + _automation_granularity - 1));
+				}
+			}
+
+			if (next > end - _automation_granularity) {
+				break;
+			}
+
+			now = (framepos_t) ceil (next);
+			_automation_slices[nslices++] = now;
 		}
 	}
 
-	/* cleanup anything that is left to do */
+	for (uint32_t s = 0; s < nslots; ++s) {
+		AutomationSlot& slot (_automation[s]);
+
+		if (!slot.playing) {
+			continue;
+		}
 
-	if (nframes) {
-		connect_and_run (bufs, nframes, offset, true, now);
+		for (uint32_t n = 0; n < nslices; ++n) {
+			_automation_values[n * nslots + s] = slot.list->unlocked_eval (_automation_slices[n]);
+		}
+
+		slot.list->lock().reader_unlock ();
+	}
+
+	/* Now run the plugin over each piece.  Values are only set once the
+	   lists are unlocked, since setting one may write to its list.
+	*/
+
+	for (uint32_t n = 0; n < nslices; ++n) {
+
+		for (uint32_t s = 0; s < nslots; ++s) {
+			if (_automation[s].playing) {
+				_automation[s].control->set_value (_automation_values[n * nslots + s]);
+			}
+		}
+
+		framepos_t const slice_end = (n + 1 < nslices) ? _automation_slices[n + 1] : end;
+
+		connect_and_run (bufs, slice_end - _automation_slices[n], _automation_slices[n] - start);
 	}
 }
 
@@ -1159,16 +1291,12 @@ PluginInsert::set_parameter_state_2X (const XMLNode& node, int version)
 			continue;
 		}
 
-		XMLNodeList cnodes;
 		XMLProperty *cprop;
-		XMLNodeConstIterator iter;
 		XMLNode *child;
 		const char *port;
 		uint32_t port_id;
 
-		cnodes = (*niter)->children ("port");
-
-		for (iter = cnodes.begin(); iter != cnodes.end(); ++iter){
+		for (XMLNode::NamedChildIterator iter (**niter, X_("port")); !iter.done(); ++iter) {
 
 			child = *iter;
 
@@ -1253,6 +1381,23 @@ PluginInsert::signal_latency() const
 	return _plugins[0]->signal_latency ();
 }
 
+ARDOUR::framecnt_t
+PluginInsert::tail_length () const
+{
+	/* generators and instruments can make sound from silence */
+	if (has_no_audio_inputs () || is_midi_instrument ()) {
+		return -1;
+	}
+
+	framecnt_t const tail = _plugins[0]->tail_length ();
+	if (tail >= 0) {
+		return tail;
+	}
+
+	/* the plugin doesn't say, so allow for a long reverb */
+	return Config->get_silent_plugin_tail () * _session.frame_rate ();
+}
+
 ARDOUR::PluginType
 PluginInsert::type ()
 {
@@ -68,6 +68,17 @@ ProcessThread::drop_buffers ()
         _private_thread_buffers.set (0);
 }
 
+/** Allocate this thread's buffers afresh from this thread, so that they
+ *  are close to it; see ThreadBuffers::reallocate().
+ */
+void
+ProcessThread::reallocate_buffers ()
+{
+        ThreadBuffers* tb = _private_thread_buffers.get();
+        assert (tb);
+        tb->reallocate ();
+}
+
 BufferSet&
 ProcessThread::get_silent_buffers (ChanCount count)
 {
@@ -65,6 +65,7 @@ Processor::Processor(Session& session, const string& name)
 	, _ui_pointer (0)
 	, _window_proxy (0)
 	, _owner (0)
+	, _silent_input_frames (0)
 {
 }
 
@@ -82,9 +83,35 @@ Processor::Processor (const Processor& other)
 	, _ui_pointer (0)
 	, _window_proxy (0)
 	, _owner (0)
+	, _silent_input_frames (0)
 {
 }
 
+/** Called by our route before each run() when it is skipping processors
+ *  whose input is silent.
+ *  @param input_silent true if our input is silent for this cycle.
+ *  @return true if run() need not be called, because our input has been
+ *  silent for longer than our tail and latency, so our output is silent too.
+ */
+bool
+Processor::can_skip_run (bool input_silent, pframes_t nframes)
+{
+	framecnt_t const tail = tail_length ();
+
+	/* let run() see a pending activation or deactivation through */
+	if (!input_silent || tail < 0 || (bool) _pending_active != _active) {
+		_silent_input_frames = 0;
+		return false;
+	}
+
+	if (_silent_input_frames > tail + signal_latency ()) {
+		return true;
+	}
+
+	_silent_input_frames += nframes;
+	return false;
+}
+
 XMLNode&
 Processor::get_state (void)
 {
@@ -1129,7 +1129,10 @@ Region::lower_to_bottom ()
 void
 Region::set_layer (layer_t l)
 {
-	_layer = l;
+	if (_layer != l) {
+		_layer = l;
+		bump_state_generation ();
+	}
 }
 
 XMLNode&
@@ -1627,6 +1630,8 @@ Region::drop_sources ()
 	}
 
 	_master_sources.clear ();
+
+	bump_state_generation ();
 }
 
 void
@@ -1649,6 +1654,8 @@ Region::use_sources (SourceList const & s)
 			(*i)->DropReferences.connect_same_thread (*this, boost::bind (&Region::source_deleted, this, boost::weak_ptr<Source>(*i)));
 		}
 	}
+
+	bump_state_generation ();
 }
 
 Trimmable::CanTrim
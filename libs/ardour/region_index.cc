@@ -0,0 +1,242 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "ardour/region.h"
+#include "ardour/region_index.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+namespace {
+
+struct EntryFirstLess {
+	template<typename E>
+	bool operator() (E const & a, E const & b) const {
+		return a.first < b.first;
+	}
+};
+
+struct PointLess {
+	template<typename P>
+	bool operator() (P const & a, P const & b) const {
+		return a.pos < b.pos || (a.pos == b.pos && a.index < b.index);
+	}
+};
+
+struct PointPosLess {
+	template<typename P>
+	bool operator() (P const & a, framepos_t b) const {
+		return a.pos < b;
+	}
+	template<typename P>
+	bool operator() (framepos_t a, P const & b) const {
+		return a < b.pos;
+	}
+};
+
+struct IndexLess {
+	bool operator() (std::pair<size_t, boost::shared_ptr<Region> > const & a, std::pair<size_t, boost::shared_ptr<Region> > const & b) const {
+		return a.first < b.first;
+	}
+};
+
+}
+
+RegionIndex::RegionIndex (RegionList::const_iterator begin, RegionList::const_iterator end)
+{
+	for (RegionList::const_iterator i = begin; i != end; ++i) {
+		_by_start.push_back (Entry (*i, (*i)->first_frame(), (*i)->last_frame()));
+	}
+
+	/* the list is normally sorted by position already, but it is not
+	   guaranteed to be while a splice or shuffle is in progress. A stable
+	   sort keeps regions at the same position in list order.
+	*/
+
+	stable_sort (_by_start.begin(), _by_start.end(), EntryFirstLess ());
+
+	_max_last.resize (_by_start.size());
+	build (0, _by_start.size());
+
+	_by_first.reserve (_by_start.size());
+	_by_last.reserve (_by_start.size());
+	_by_sync.reserve (_by_start.size());
+
+	for (size_t n = 0; n < _by_start.size(); ++n) {
+		_by_first.push_back (Point (_by_start[n].first, n));
+		_by_last.push_back (Point (_by_start[n].last, n));
+		_by_sync.push_back (Point (_by_start[n].region->sync_position(), n));
+	}
+
+	sort (_by_last.begin(), _by_last.end(), PointLess ());
+	sort (_by_sync.begin(), _by_sync.end(), PointLess ());
+}
+
+/** Fill in _max_last for the subtree held in [lo, hi), whose root is at the midpoint.
+ *  @return the latest last frame in the subtree.
+ */
+framepos_t
+RegionIndex::build (size_t lo, size_t hi)
+{
+	if (lo >= hi) {
+		return numeric_limits<framepos_t>::min();
+	}
+
+	size_t const mid = lo + (hi - lo) / 2;
+
+	framepos_t m = _by_start[mid].last;
+	m = max (m, build (lo, mid));
+	m = max (m, build (mid + 1, hi));
+
+	_max_last[mid] = m;
+
+	return m;
+}
+
+void
+RegionIndex::touched (size_t lo, size_t hi, framepos_t start, framepos_t end, RegionList& result) const
+{
+	if (lo >= hi) {
+		return;
+	}
+
+	size_t const mid = lo + (hi - lo) / 2;
+
+	if (_max_last[mid] < start) {
+		/* everything in this subtree ends before the range */
+		return;
+	}
+
+	touched (lo, mid, start, end, result);
+
+	Entry const & e (_by_start[mid]);
+
+	if (e.first > end) {
+		/* this entry, and everything after it, starts after the range */
+		return;
+	}
+
+	/* same test as Region::coverage() != OverlapNone, which also
+	   rejects zero-length regions.
+	*/
+
+	if (e.first <= e.last && e.last >= start) {
+		result.push_back (e.region);
+	}
+
+	touched (mid + 1, hi, start, end, result);
+}
+
+void
+RegionIndex::touched (framepos_t start, framepos_t end, RegionList& result) const
+{
+	if (start > end) {
+		return;
+	}
+
+	touched (0, _by_start.size(), start, end, result);
+}
+
+uint32_t
+RegionIndex::count_at (framepos_t frame) const
+{
+	RegionList rl;
+	at (frame, rl);
+	return rl.size();
+}
+
+void
+RegionIndex::within (vector<Point> const & points, Evoral::Range<framepos_t> const & range, RegionList& result) const
+{
+	vector<Point>::const_iterator b = lower_bound (points.begin(), points.end(), range.from, PointPosLess ());
+	vector<Point>::const_iterator e = upper_bound (b, points.end(), range.to, PointPosLess ());
+
+	/* return the results in position order, as a scan of the playlist would */
+
+	vector<pair<size_t, boost::shared_ptr<Region> > > found;
+
+	for (vector<Point>::const_iterator i = b; i != e; ++i) {
+		found.push_back (make_pair (i->index, _by_start[i->index].region));
+	}
+
+	sort (found.begin(), found.end(), IndexLess ());
+
+	for (vector<pair<size_t, boost::shared_ptr<Region> > >::const_iterator i = found.begin(); i != found.end(); ++i) {
+		result.push_back (i->second);
+	}
+}
+
+void
+RegionIndex::with_start_within (Evoral::Range<framepos_t> range, RegionList& result) const
+{
+	within (_by_first, range, result);
+}
+
+void
+RegionIndex::with_end_within (Evoral::Range<framepos_t> range, RegionList& result) const
+{
+	within (_by_last, range, result);
+}
+
+boost::shared_ptr<Region>
+RegionIndex::next (framepos_t frame, RegionPoint point, int dir) const
+{
+	vector<Point> const * points;
+
+	switch (point) {
+	case Start:
+		points = &_by_first;
+		break;
+	case End:
+		points = &_by_last;
+		break;
+	default:
+		points = &_by_sync;
+		break;
+	}
+
+	if (dir == 1) {
+		/* forwards: the first point after frame */
+		vector<Point>::const_iterator i = upper_bound (points->begin(), points->end(), frame, PointPosLess ());
+
+		if (i == points->end()) {
+			return boost::shared_ptr<Region> ();
+		}
+
+		return _by_start[i->index].region;
+	}
+
+	/* backwards: the last point before frame, taking the earliest of any
+	   regions which share that point.
+	*/
+
+	vector<Point>::const_iterator i = lower_bound (points->begin(), points->end(), frame, PointPosLess ());
+
+	if (i == points->begin()) {
+		return boost::shared_ptr<Region> ();
+	}
+
+	--i;
+	i = lower_bound (points->begin(), i, i->pos, PointPosLess ());
+
+	return _by_start[i->index].region;
+}
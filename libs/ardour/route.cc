@@ -437,6 +437,28 @@ Route::set_trim (gain_t val, void * /* src */)
 	_trim->set_gain (val, 0);
 }
 
+/** @return true if the first @a nframes of each of the buffers in @a bufs
+ *  are silent.
+ */
+static bool
+buffers_silent (BufferSet& bufs, pframes_t nframes)
+{
+	for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
+		pframes_t n;
+		if (!i->silent () && !i->check_silence (nframes, n)) {
+			return false;
+		}
+	}
+
+	for (BufferSet::midi_iterator i = bufs.midi_begin(); i != bufs.midi_end(); ++i) {
+		if (!i->empty ()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void
 Route::maybe_declick (BufferSet&, framecnt_t, int)
 {
@@ -567,6 +589,12 @@ Route::process_output_buffers (BufferSet& bufs,
 	/* set this to be true if the meter will already have been ::run() earlier */
 	bool const meter_already_run = metering_state() == MeteringInput;
 
+	/* if we are skipping silence, whether bufs are silent: -1 if we have
+	   not looked since the last processor ran.
+	*/
+	bool const skip_silence = Config->get_skip_silent_plugins ();
+	int silent = -1;
+
 	framecnt_t latency = 0;
 
 	for (ProcessorList::const_iterator i = _processors.begin(); i != _processors.end(); ++i) {
@@ -598,7 +626,24 @@ Route::process_output_buffers (BufferSet& bufs,
 			boost::dynamic_pointer_cast<Send>(*i)->set_delay_in(_signal_latency - latency);
 		}
 
-		(*i)->run (bufs, start_frame - latency, end_frame - latency, nframes, *i != _processors.back());
+		bool skip = false;
+
+		if (skip_silence && (*i)->tail_length () >= 0) {
+			if (silent < 0) {
+				silent = buffers_silent (bufs, nframes);
+			}
+			skip = (*i)->can_skip_run (silent > 0, nframes);
+		}
+
+		if (skip) {
+			/* its output would be silent too, but there may be more of it */
+			bufs.set_count ((*i)->output_streams());
+			bufs.silence (nframes, 0);
+		} else {
+			DSPTimer timer ((*i)->dsp_timings ());
+			(*i)->run (bufs, start_frame - latency, end_frame - latency, nframes, *i != _processors.back());
+			silent = -1;
+		}
 		bufs.set_count ((*i)->output_streams());
 
 		if ((*i)->active ()) {
@@ -3208,6 +3253,31 @@ Route::direct_feeds_according_to_reality (boost::shared_ptr<Route> other, bool*
 	return false;
 }
 
+bool
+Route::has_port (boost::shared_ptr<Port> port) const
+{
+	if (_input->has_port (port) || _output->has_port (port)) {
+		return true;
+	}
+
+	Glib::Threads::RWLock::ReaderLock lm (_processor_lock);
+
+	for (ProcessorList::const_iterator i = _processors.begin(); i != _processors.end(); ++i) {
+
+		boost::shared_ptr<IOProcessor> iop = boost::dynamic_pointer_cast<IOProcessor> (*i);
+
+		if (!iop) {
+			continue;
+		}
+
+		if ((iop->input() && iop->input()->has_port (port)) || (iop->output() && iop->output()->has_port (port))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool
 Route::direct_feeds_according_to_graph (boost::shared_ptr<Route> other, bool* via_send_only)
 {
@@ -90,6 +90,18 @@ GraphEdges::from (GraphVertex r) const
 	return i->second;
 }
 
+/** @return the vertices that feed `r' */
+set<GraphVertex>
+GraphEdges::to (GraphVertex r) const
+{
+	EdgeMap::const_iterator i = _to_from.find (r);
+	if (i == _to_from.end ()) {
+		return set<GraphVertex> ();
+	}
+
+	return i->second;
+}
+
 void
 GraphEdges::remove (GraphVertex from, GraphVertex to)
 {
@@ -112,6 +124,51 @@ GraphEdges::remove (GraphVertex from, GraphVertex to)
 	_from_to_with_sends.erase (k);
 }
 
+/** Remove all edges to or from `v' */
+void
+GraphEdges::remove_vertex (GraphVertex v)
+{
+	set<GraphVertex> const f = from (v);
+	for (set<GraphVertex>::const_iterator i = f.begin(); i != f.end(); ++i) {
+		remove (v, *i);
+	}
+
+	set<GraphVertex> const t = to (v);
+	for (set<GraphVertex>::const_iterator i = t.begin(); i != t.end(); ++i) {
+		remove (*i, v);
+	}
+}
+
+/** Add `v', and every vertex connected to it by edges in either direction,
+ *  to `component'.
+ */
+void
+GraphEdges::add_component (GraphVertex v, set<GraphVertex>& component) const
+{
+	list<GraphVertex> queue;
+	queue.push_back (v);
+
+	while (!queue.empty ()) {
+		GraphVertex r = queue.front ();
+		queue.pop_front ();
+
+		if (!component.insert (r).second) {
+			/* already visited */
+			continue;
+		}
+
+		EdgeMap::const_iterator i = _from_to.find (r);
+		if (i != _from_to.end ()) {
+			queue.insert (queue.end(), i->second.begin(), i->second.end());
+		}
+
+		i = _to_from.find (r);
+		if (i != _to_from.end ()) {
+			queue.insert (queue.end(), i->second.begin(), i->second.end());
+		}
+	}
+}
+
 /** @param to `To' route.
  *  @return true if there are no edges going to `to'.
  */
@@ -216,6 +216,8 @@ Session::Session (AudioEngine &eng,
 	, _state_of_the_state (StateOfTheState(CannotSave|InitialConnecting|Loading))
 	, _suspend_save (0)
 	, _save_queued (false)
+	, _state_write_thread (0)
+	, _pending_file_generation (0)
     , _stop_marker_sentinel (max_framepos)
 	, _last_roll_location (0)
 	, _last_roll_or_reversal_location (0)
@@ -260,6 +262,7 @@ Session::Session (AudioEngine &eng,
 	, _tempo_map (0)
 	, _all_route_group (new RouteGroup (*this, "all"))
 	, routes (new RouteList)
+	, _route_lookup (new RouteLookup)
 	, _adding_routes_in_progress (false)
 	, _reconnecting_routes_in_progress (false)
 	, _route_deletion_in_progress (false)
@@ -294,6 +297,9 @@ Session::Session (AudioEngine &eng,
 	, _step_editors (0)
 	, _suspend_timecode_transmission (0)
 	,  _speakers (new Speakers)
+	, _route_graph_feedback (false)
+	, _route_graph_resort_deferred (false)
+	, _route_graph_batch (0)
 	, _order_hint (default_order_hint)
 	, ignore_route_processor_changes (false)
 	, _scene_changer (0)
@@ -391,6 +397,11 @@ Session::Session (AudioEngine &eng,
 	StartTimeChanged.connect_same_thread (*this, boost::bind (&Session::start_time_changed, this, _1));
 	EndTimeChanged.connect_same_thread (*this, boost::bind (&Session::end_time_changed, this, _1));
 
+	/* Emitted once for a change to one route's remote ID, or after a
+	   reordering has changed many; see also notify_remote_id_change().
+	*/
+	Route::RemoteControlIDChange.connect_same_thread (*this, boost::bind (&Session::rebuild_route_lookup, this));
+
 	emit_thread_start ();
 
 	/* hook us up to the engine since we are now completely constructed */
@@ -637,6 +648,12 @@ Session::destroy ()
 	_master_out.reset ();
 	_monitor_out.reset ();
 
+	/* and the route graphs' references to all of them */
+
+	_current_route_graph = GraphEdges ();
+	_route_graph_edges = GraphEdges ();
+	_route_graph_vertices.clear ();
+
 	{
 		RCUWriter<RouteList> writer (routes);
 		boost::shared_ptr<RouteList> r = writer.get_copy ();
@@ -650,6 +667,8 @@ Session::destroy ()
 		/* writer goes out of scope and updates master */
 	}
 	routes.flush ();
+	rebuild_route_lookup ();
+	_route_lookup.flush ();
 
 	{
 		DEBUG_TRACE (DEBUG::Destruction, "delete sources\n");
@@ -2135,6 +2154,15 @@ Session::resort_routes ()
 		return;
 	}
 
+	if (g_atomic_int_get (&_route_graph_batch)) {
+		/* we are in the middle of an operation which may change many
+		   connections; resort once when it is finished.
+		*/
+		Glib::Threads::Mutex::Lock lm (_route_graph_changes_lock);
+		_route_graph_resort_deferred = true;
+		return;
+	}
+
 	{
 		RCUWriter<RouteList> writer (routes);
 		boost::shared_ptr<RouteList> r = writer.get_copy ();
@@ -2160,6 +2188,141 @@ Session::resort_routes ()
 
 }
 
+void
+Session::resort_routes_if_deferred ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_route_graph_changes_lock);
+		if (!_route_graph_resort_deferred) {
+			return;
+		}
+		_route_graph_resort_deferred = false;
+	}
+
+	resort_routes ();
+}
+
+/** Note that a route's connections or sends may have changed, so that its
+ *  edges in the route graph must be found again at the next resort.
+ */
+void
+Session::route_graph_changed (boost::weak_ptr<Route> wr)
+{
+	Glib::Threads::Mutex::Lock lm (_route_graph_changes_lock);
+	_route_graph_changed_routes.insert (wr);
+}
+
+/** Handler for the engine's PortConnectedOrDisconnected; this may be called
+ *  from the backend's thread, so the ports are just noted here and their
+ *  routes found at the next resort.
+ */
+void
+Session::route_graph_ports_changed (boost::weak_ptr<Port> a, boost::weak_ptr<Port> b)
+{
+	Glib::Threads::Mutex::Lock lm (_route_graph_changes_lock);
+	_route_graph_changed_ports.push_back (a);
+	_route_graph_changed_ports.push_back (b);
+}
+
+/** Bring _route_graph_edges up to date with the routes in @param r, finding
+ *  the edges of routes which are new or have changed since the last call.
+ *  @param changed Filled in with the routes whose edges may have changed.
+ *
+ *  This is only called with a writer for the route list in scope, which
+ *  serialises access to the graph.
+ */
+void
+Session::update_route_graph_edges (boost::shared_ptr<RouteList> r, set<GraphVertex>& changed)
+{
+	set<boost::weak_ptr<Route> > changed_routes;
+	vector<boost::weak_ptr<Port> > changed_ports;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_route_graph_changes_lock);
+		changed_routes.swap (_route_graph_changed_routes);
+		changed_ports.swap (_route_graph_changed_ports);
+	}
+
+	set<GraphVertex> const current (r->begin(), r->end());
+
+	/* Forget routes which have gone away; whatever they were connected
+	   to has changed.
+	*/
+
+	for (set<GraphVertex>::iterator i = _route_graph_vertices.begin(); i != _route_graph_vertices.end(); ++i) {
+		if (current.find (*i) == current.end ()) {
+			set<GraphVertex> const f = _route_graph_edges.from (*i);
+			set<GraphVertex> const t = _route_graph_edges.to (*i);
+			changed.insert (f.begin(), f.end());
+			changed.insert (t.begin(), t.end());
+			_route_graph_edges.remove_vertex (*i);
+		}
+	}
+
+	/* Work out which routes need their edges finding again: new ones,
+	   those that told us they had changed, and the owners of any ports
+	   that have been connected or disconnected.
+	*/
+
+	set<GraphVertex> stale;
+
+	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
+		if (_route_graph_vertices.find (*i) == _route_graph_vertices.end () ||
+		    changed_routes.find (boost::weak_ptr<Route> (*i)) != changed_routes.end ()) {
+			stale.insert (*i);
+		}
+	}
+
+	for (vector<boost::weak_ptr<Port> >::iterator p = changed_ports.begin(); p != changed_ports.end(); ++p) {
+		boost::shared_ptr<Port> port = p->lock ();
+		if (!port) {
+			/* not ours, or gone; if it was ours, its IO will have
+			   told us about the change.
+			*/
+			continue;
+		}
+		for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
+			if ((*i)->has_port (port)) {
+				stale.insert (*i);
+				break;
+			}
+		}
+	}
+
+	_route_graph_vertices = current;
+
+	/* Drop the stale routes' edges in both directions ... */
+
+	for (set<GraphVertex>::iterator i = stale.begin(); i != stale.end(); ++i) {
+		set<GraphVertex> const f = _route_graph_edges.from (*i);
+		set<GraphVertex> const t = _route_graph_edges.to (*i);
+		changed.insert (f.begin(), f.end());
+		changed.insert (t.begin(), t.end());
+		changed.insert (*i);
+		_route_graph_edges.remove_vertex (*i);
+	}
+
+	/* ... and find them again from the current state of the connections
+	   and internal sends.  An edge between two stale routes is found
+	   from the stale route that it leaves.
+	*/
+
+	for (set<GraphVertex>::iterator i = stale.begin(); i != stale.end(); ++i) {
+		for (RouteList::iterator j = r->begin(); j != r->end(); ++j) {
+
+			bool via_sends_only;
+
+			if ((*i)->direct_feeds_according_to_reality (*j, &via_sends_only)) {
+				_route_graph_edges.add (*i, *j, via_sends_only);
+			}
+
+			if (stale.find (*j) == stale.end () && (*j)->direct_feeds_according_to_reality (*i, &via_sends_only)) {
+				_route_graph_edges.add (*j, *i, via_sends_only);
+			}
+		}
+	}
+}
+
 /** This is called whenever we need to rebuild the graph of how we will process
  *  routes.
  *  @param r List of routes, in any order.
@@ -2168,46 +2331,49 @@ Session::resort_routes ()
 void
 Session::resort_routes_using (boost::shared_ptr<RouteList> r)
 {
-	/* We are going to build a directed graph of our routes;
-	   this is where the edges of that graph are put.
+	/* Bring our directed graph of routes up to date.  Each of its edges is
+	   a pair of routes, one of which directly feeds the other either by a
+	   port connection or by an internal send.
 	*/
-	
-	GraphEdges edges;
 
-	/* Go through all routes doing two things:
-	 *
-	 * 1. Collect the edges of the route graph.  Each of these edges
-	 *    is a pair of routes, one of which directly feeds the other
-	 *    either by a JACK connection or by an internal send.
-	 *
-	 * 2. Begin the process of making routes aware of which other
-	 *    routes directly or indirectly feed them.  This information
-	 *    is used by the solo code.
+	set<GraphVertex> changed;
+	update_route_graph_edges (r, changed);
+
+	/* Begin the process of making routes aware of which other routes
+	 * directly or indirectly feed them.  This information is used by the
+	 * solo code.  Only routes connected (in either direction) to one whose
+	 * edges have changed can be affected, unless the last attempt found
+	 * feedback and so did not finish the job.
 	 */
-	   
-	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
+
+	set<GraphVertex> affected;
+
+	if (_route_graph_feedback) {
+		affected.insert (r->begin(), r->end());
+	} else {
+		for (set<GraphVertex>::iterator i = changed.begin(); i != changed.end(); ++i) {
+			if (_route_graph_vertices.find (*i) != _route_graph_vertices.end () && affected.find (*i) == affected.end ()) {
+				_route_graph_edges.add_component (*i, affected);
+			}
+		}
+	}
+
+	for (set<GraphVertex>::iterator i = affected.begin(); i != affected.end(); ++i) {
 
 		/* Clear out the route's list of direct or indirect feeds */
 		(*i)->clear_fed_by ();
 
-		for (RouteList::iterator j = r->begin(); j != r->end(); ++j) {
-
-			bool via_sends_only;
+		set<GraphVertex> const feeders = _route_graph_edges.to (*i);
 
-			/* See if this *j feeds *i according to the current state of the JACK
-			   connections and internal sends.
-			*/
-			if ((*j)->direct_feeds_according_to_reality (*i, &via_sends_only)) {
-				/* add the edge to the graph (part #1) */
-				edges.add (*j, *i, via_sends_only);
-				/* tell the route (for part #2) */
-				(*i)->add_fed_by (*j, via_sends_only);
-			}
+		for (set<GraphVertex>::const_iterator j = feeders.begin(); j != feeders.end(); ++j) {
+			bool via_sends_only = false;
+			_route_graph_edges.has (*j, *i, &via_sends_only);
+			(*i)->add_fed_by (*j, via_sends_only);
 		}
 	}
 
 	/* Attempt a topological sort of the route graph */
-	boost::shared_ptr<RouteList> sorted_routes = topological_sort (r, edges);
+	boost::shared_ptr<RouteList> sorted_routes = topological_sort (r, _route_graph_edges);
 	
 	if (sorted_routes) {
 		/* We got a satisfactory topological sort, so there is no feedback;
@@ -2217,16 +2383,19 @@ Session::resort_routes_using (boost::shared_ptr<RouteList> r)
 		   topologically-sorted list, but hey ho.
 		*/
 		if (_process_graph) {
-			_process_graph->rechain (sorted_routes, edges);
+			_process_graph->rechain (sorted_routes, _route_graph_edges);
 		}
 		
-		_current_route_graph = edges;
+		_current_route_graph = _route_graph_edges;
+		_route_graph_feedback = false;
 
 		/* Complete the building of the routes' lists of what directly
 		   or indirectly feeds them.
 		*/
 		for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
-			trace_terminal (*i, *i);
+			if (affected.find (*i) != affected.end ()) {
+				trace_terminal (*i, *i);
+			}
 		}
 
 		*r = *sorted_routes;
@@ -2250,6 +2419,8 @@ Session::resort_routes_using (boost::shared_ptr<RouteList> r)
 		   so the solo code will think that everything is still connected
 		   as it was before.
 		*/
+
+		_route_graph_feedback = true;
 		
 		FeedbackDetected (); /* EMIT SIGNAL */
 	}
@@ -2687,6 +2858,9 @@ Session::reconnect_existing_routes (bool withLock, bool reconnect_master, bool r
 		return;
 	}
     
+	/* declared before the lock, so that the resort happens after it is released */
+	RouteGraphBatch rgb (this);
+
 	Glib::Threads::Mutex::Lock lm (AudioEngine::instance()->process_lock (), Glib::Threads::NOT_LOCK);
     
 	if (withLock) {
@@ -3349,6 +3523,8 @@ Session::add_routes_inner (RouteList& new_routes, bool input_auto_connect, bool
 		}
 	}
 
+	rebuild_route_lookup ();
+
 	for (RouteList::iterator x = new_routes.begin(); x != new_routes.end(); ++x) {
 
 		boost::weak_ptr<Route> wpr (*x);
@@ -3359,7 +3535,10 @@ Session::add_routes_inner (RouteList& new_routes, bool input_auto_connect, bool
 		r->solo_isolated_changed.connect_same_thread (*this, boost::bind (&Session::route_solo_isolated_changed, this, _1, wpr));
 		r->mute_changed.connect_same_thread (*this, boost::bind (&Session::route_mute_changed, this, _1));
 		r->output()->changed.connect_same_thread (*this, boost::bind (&Session::set_worst_io_latencies_x, this, _1, _2));
-		r->processors_changed.connect_same_thread (*this, boost::bind (&Session::route_processors_changed, this, _1));
+		r->processors_changed.connect_same_thread (*this, boost::bind (&Session::route_processors_changed, this, _1, wpr));
+		r->input()->changed.connect_same_thread (*this, boost::bind (&Session::route_graph_changed, this, wpr));
+		r->output()->changed.connect_same_thread (*this, boost::bind (&Session::route_graph_changed, this, wpr));
+		r->PropertyChanged.connect_same_thread (*this, boost::bind (&Session::route_lookup_property_changed, this, _1));
 
 		if (r->is_master()) {
 			_master_out = r;
@@ -3578,6 +3757,8 @@ Session::remove_routes (boost::shared_ptr<RouteList> routes_to_remove)
 		/* writer goes out of scope, forces route list update */
 
 	} // end of RCU Writer scope
+
+	rebuild_route_lookup ();
     
 	update_latency_compensation ();
 	set_dirty();
@@ -3601,6 +3782,7 @@ Session::remove_routes (boost::shared_ptr<RouteList> routes_to_remove)
 	/* XXX i think this is unsafe as it currently stands, but i am not sure. (pd, october 2nd, 2006) */
     
 	routes.flush ();
+	_route_lookup.flush ();
     
 	/* try to cause everyone to drop their references
 	 * and unregister ports from the backend
@@ -4103,15 +4285,44 @@ Session::routes_using_input_from (const string& str, RouteList& rl)
 	}
 }
 
-boost::shared_ptr<Route>
-Session::route_by_name (string name)
+/** Rebuild the indexes used by route_by_id(), route_by_name() and
+ *  route_by_remote_id() from the current route list.
+ */
+void
+Session::rebuild_route_lookup ()
 {
 	boost::shared_ptr<RouteList> r = routes.reader ();
+	boost::shared_ptr<RouteLookup> l (new RouteLookup);
 
+	/* insert() leaves an existing entry alone, so where two routes share
+	   a name or remote ID the first in the list wins, as it would in a
+	   search of the list.
+	*/
 	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
-		if ((*i)->name() == name) {
-			return *i;
-		}
+		l->by_id.insert (make_pair ((*i)->id(), *i));
+		l->by_name.insert (make_pair ((*i)->name(), *i));
+		l->by_remote_id.insert (make_pair ((*i)->remote_control_id(), *i));
+	}
+
+	_route_lookup.replace (l);
+}
+
+void
+Session::route_lookup_property_changed (PropertyChange const & what_changed)
+{
+	if (what_changed.contains (Properties::name)) {
+		rebuild_route_lookup ();
+	}
+}
+
+boost::shared_ptr<Route>
+Session::route_by_name (string name)
+{
+	boost::shared_ptr<RouteLookup> l = _route_lookup.reader ();
+	RouteLookup::ByName::const_iterator i = l->by_name.find (name);
+
+	if (i != l->by_name.end()) {
+		return i->second;
 	}
 
 	return boost::shared_ptr<Route> ((Route*) 0);
@@ -4120,12 +4331,11 @@ Session::route_by_name (string name)
 boost::shared_ptr<Route>
 Session::route_by_id (PBD::ID id)
 {
-	boost::shared_ptr<RouteList> r = routes.reader ();
+	boost::shared_ptr<RouteLookup> l = _route_lookup.reader ();
+	RouteLookup::ByID::const_iterator i = l->by_id.find (id);
 
-	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
-		if ((*i)->id() == id) {
-			return *i;
-		}
+	if (i != l->by_id.end()) {
+		return i->second;
 	}
 
 	return boost::shared_ptr<Route> ((Route*) 0);
@@ -4149,12 +4359,11 @@ Session::track_by_diskstream_id (PBD::ID id)
 boost::shared_ptr<Route>
 Session::route_by_remote_id (uint32_t id)
 {
-	boost::shared_ptr<RouteList> r = routes.reader ();
+	boost::shared_ptr<RouteLookup> l = _route_lookup.reader ();
+	RouteLookup::ByRemoteID::const_iterator i = l->by_remote_id.find (id);
 
-	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
-		if ((*i)->remote_control_id() == id) {
-			return *i;
-		}
+	if (i != l->by_remote_id.end()) {
+		return i->second;
 	}
 
 	return boost::shared_ptr<Route> ((Route*) 0);
@@ -6234,6 +6443,48 @@ Session::set_worst_io_latencies ()
 	set_worst_capture_latency ();
 }
 
+DSPTimingStats
+Session::critical_path_stats () const
+{
+	if (_process_graph) {
+		return _process_graph->critical_path_stats ();
+	}
+	return DSPTimingStats ();
+}
+
+void
+Session::process_thread_idle_stats (vector<DSPTimingStats>& stats) const
+{
+	stats.clear ();
+	if (_process_graph) {
+		_process_graph->thread_idle_stats (stats);
+	}
+}
+
+static void
+reset_processor_dsp_timings (boost::weak_ptr<Processor> wp)
+{
+	boost::shared_ptr<Processor> p = wp.lock ();
+	if (p) {
+		p->dsp_timings().reset ();
+	}
+}
+
+void
+Session::reset_dsp_timings ()
+{
+	boost::shared_ptr<RouteList> r = routes.reader ();
+
+	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
+		(*i)->dsp_timings().reset ();
+		(*i)->foreach_processor (boost::bind (&reset_processor_dsp_timings, _1));
+	}
+
+	if (_process_graph) {
+		_process_graph->reset_dsp_timings ();
+	}
+}
+
 void
 Session::set_worst_playback_latency ()
 {
@@ -6371,6 +6622,8 @@ Session::notify_remote_id_change ()
 		Route::RemoteControlIDChange (); /* EMIT SIGNAL */
 		break;
 	default:
+		/* nobody else needs telling, but our lookup does */
+		rebuild_route_lookup ();
 		break;
 	}
 
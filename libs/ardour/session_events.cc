@@ -17,6 +17,7 @@
 
 */
 
+#include <algorithm>
 #include <cmath>
 #include <unistd.h>
 
@@ -178,6 +179,26 @@ SessionEventManager::dump_events () const
 	cerr << "END EVENT_DUMP" << endl;
 }
 
+/** Merge the events queued by other threads since the last call; called
+ *  by the process thread once per cycle.
+ */
+void
+SessionEventManager::merge_pending_events ()
+{
+	g_atomic_int_set (&_events_processed_last_cycle, _events_processed);
+	_events_processed = 0;
+
+	SessionEvent* ev;
+	gint n = 0;
+
+	while (pending_events.read (ev)) {
+		merge_event (ev);
+		++n;
+	}
+
+	g_atomic_int_set (&_events_queued_last_cycle, n);
+}
+
 void
 SessionEventManager::merge_event (SessionEvent* ev)
 {
@@ -233,8 +254,8 @@ SessionEventManager::merge_event (SessionEvent* ev)
 		}
 	}
 
-	events.insert (events.begin(), ev);
-	events.sort (SessionEvent::compare);
+	/* keep events in time order, with a new event ahead of others at the same time */
+	events.insert (lower_bound (events.begin(), events.end(), ev, SessionEvent::compare), ev);
 	next_event = events.begin();
 	set_next_event ();
 }
@@ -32,6 +32,7 @@
 #include "ardour/butler.h"
 #include "ardour/cycle_timer.h"
 #include "ardour/debug.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/graph.h"
 #include "ardour/port.h"
 #include "ardour/process_thread.h"
@@ -155,6 +156,8 @@ Session::no_roll (pframes_t nframes)
 
 			(*i)->set_pending_declick (declick);
 
+			DSPTimer timer ((*i)->dsp_timings ());
+
 			if ((*i)->no_roll (nframes, _transport_frame, end_frame, non_realtime_work_pending())) {
 				error << string_compose(_("Session: error in no roll for %1"), (*i)->name()) << endmsg;
 				ret = -1;
@@ -199,6 +202,7 @@ Session::process_routes (pframes_t nframes, bool& need_butler)
 			(*i)->set_pending_declick (declick);
 
 			bool b = false;
+			DSPTimer timer ((*i)->dsp_timings ());
 
 			if ((ret = (*i)->roll (nframes, start_frame, end_frame, declick, b)) < 0) {
 				stop_transport ();
@@ -237,6 +241,7 @@ Session::silent_process_routes (pframes_t nframes, bool& need_butler)
 			}
 
 			bool b = false;
+			DSPTimer timer ((*i)->dsp_timings ());
 
 			if ((ret = (*i)->silent_roll (nframes, start_frame, end_frame, b)) < 0) {
 				stop_transport ();
@@ -285,7 +290,6 @@ Session::process_with_events (pframes_t nframes)
 {
 	PT_TIMING_CHECK (3);
 	
-	SessionEvent*  ev;
 	pframes_t      this_nframes;
 	framepos_t     end_frame;
 	bool           session_needs_butler = false;
@@ -299,9 +303,7 @@ Session::process_with_events (pframes_t nframes)
 
 	/* handle any pending events */
 
-	while (pending_events.read (&ev, 1) == 1) {
-		merge_event (ev);
-	}
+	merge_pending_events ();
 
 	/* if we are not in the middle of a state change,
 	   and there are immediate events queued up,
@@ -954,7 +956,6 @@ Session::process_without_events (pframes_t nframes)
 void
 Session::process_audition (pframes_t nframes)
 {
-	SessionEvent* ev;
 	boost::shared_ptr<RouteList> r = routes.reader ();
 
 	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
@@ -977,9 +978,7 @@ Session::process_audition (pframes_t nframes)
 
 	/* handle pending events */
 
-	while (pending_events.read (&ev, 1) == 1) {
-		merge_event (ev);
-	}
+	merge_pending_events ();
 
 	/* if we are not in the middle of a state change,
 	   and there are immediate events queued up,
@@ -1052,7 +1051,11 @@ Session::queue_event (SessionEvent* ev)
 	} else if (_state_of_the_state & Loading) {
 		merge_event (ev);
 	} else {
-		pending_events.write (&ev, 1);
+		if (!pending_events.write (ev)) {
+			error << string_compose (_("Session: event queue full, %1 event dropped"), enum_2_string (ev->type)) << endmsg;
+			/* give it back to its pool */
+			delete ev;
+		}
 	}
 }
 
@@ -1109,6 +1112,8 @@ Session::process_event (SessionEvent* ev)
 
 	DEBUG_TRACE (DEBUG::SessionEvents, string_compose ("Processing event: %1 @ %2\n", enum_2_string (ev->type), _transport_frame));
 
+	++_events_processed;
+
 	switch (ev->type) {
 	case SessionEvent::SetLoop:
 		set_play_loop (ev->yes_or_no, ev->speed);
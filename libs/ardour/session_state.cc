@@ -49,6 +49,12 @@
 #include <sys/statvfs.h>
 #endif
 
+#include <fcntl.h>
+
+#ifdef PLATFORM_WINDOWS
+#include <io.h>
+#endif
+
 #include <glib.h>
 #include <glib/gstdio.h>
 
@@ -86,6 +92,7 @@
 #include "ardour/butler.h"
 #include "ardour/control_protocol_manager.h"
 #include "ardour/directory_names.h"
+#include "ardour/dsp_profiler.h"
 #include "ardour/filename_extensions.h"
 #include "ardour/graph.h"
 #include "ardour/location.h"
@@ -256,6 +263,7 @@ Session::post_engine_init ()
 
 		SndFileSource::setup_standard_crossfades (*this, frame_rate());
 		_engine.GraphReordered.connect_same_thread (*this, boost::bind (&Session::graph_reordered, this));
+		_engine.PortConnectedOrDisconnected.connect_same_thread (*this, boost::bind (&Session::route_graph_ports_changed, this, _1, _3));
 		
 		AudioDiskstream::allocate_working_buffers();
 		refresh_disk_space ();
@@ -667,6 +675,14 @@ Session::maybe_write_autosave()
 void
 Session::remove_pending_capture_state ()
 {
+	/* don't let a pending save still being written put the file back;
+	   this is called from the butler, so it must not wait for that save
+	   (or for save_state_lock) to finish.
+	*/
+
+	Glib::Threads::Mutex::Lock lm (_pending_file_lock);
+	++_pending_file_generation;
+
 	std::string pending_state_file_path(_session_dir->root_path());
 
 	pending_state_file_path = Glib::build_filename (pending_state_file_path, legalize_for_path (_current_snapshot_name) + pending_suffix);
@@ -679,6 +695,111 @@ Session::remove_pending_capture_state ()
 	}
 }
 
+namespace {
+
+/** Write @param tree to @param tmp_path.
+ *  @param sync_to_disk true to have the new file reach the disk before returning.
+ */
+int
+write_temp_state_file (XMLTree& tree, string const & tmp_path, bool sync_to_disk)
+{
+	cerr << "actually writing state to " << tmp_path << endl;
+
+	bool written = tree.write (tmp_path);
+
+	if (written && sync_to_disk) {
+		int fd = g_open (tmp_path.c_str(), O_RDWR, 0);
+		if (fd < 0) {
+			written = false;
+		} else {
+#ifdef PLATFORM_WINDOWS
+			written = (_commit (fd) == 0);
+#else
+			written = (fsync (fd) == 0);
+#endif
+			::close (fd);
+		}
+	}
+
+	if (!written) {
+		error << string_compose (_("state could not be saved to %1"), tmp_path) << endmsg;
+		if (g_remove (tmp_path.c_str()) != 0) {
+			error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
+					tmp_path, g_strerror (errno)) << endmsg;
+		}
+		return -1;
+	}
+
+	return 0;
+}
+
+/** Rename a state file written by write_temp_state_file() over @param xml_path */
+int
+rename_temp_state_file (string const & tmp_path, string const & xml_path)
+{
+	cerr << "renaming state to " << xml_path << endl;
+
+	if (::g_rename (tmp_path.c_str(), xml_path.c_str()) != 0) {
+		error << string_compose (_("could not rename temporary session file %1 to %2 (%3)"),
+				tmp_path, xml_path, g_strerror(errno)) << endmsg;
+		if (g_remove (tmp_path.c_str()) != 0) {
+			error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
+					tmp_path, g_strerror (errno)) << endmsg;
+		}
+		return -1;
+	}
+
+	return 0;
+}
+
+/** Write @param tree to @param tmp_path and then rename it over @param xml_path,
+ *  so that a failed write never leaves a truncated state file behind.
+ *  @param sync_to_disk true to have the new file reach the disk before the rename.
+ */
+int
+write_state_file (XMLTree& tree, string const & tmp_path, string const & xml_path, bool sync_to_disk)
+{
+	if (write_temp_state_file (tree, tmp_path, sync_to_disk)) {
+		return -1;
+	}
+
+	return rename_temp_state_file (tmp_path, xml_path);
+}
+
+}
+
+void
+Session::write_state_in_background (XMLTree* tree, string tmp_path, string xml_path, uint32_t pending_file_generation)
+{
+	pthread_set_name ("StateWriter");
+
+	if (write_temp_state_file (*tree, tmp_path, true) == 0) {
+
+		Glib::Threads::Mutex::Lock lm (_pending_file_lock);
+
+		if (_pending_file_generation == pending_file_generation) {
+			rename_temp_state_file (tmp_path, xml_path);
+		} else {
+			/* the pending file was removed while we were writing it */
+			g_remove (tmp_path.c_str());
+		}
+	}
+
+	delete tree;
+}
+
+/** Wait for a pending save being written by write_state_in_background() to finish.
+ *  Must be called with save_state_lock held.
+ */
+void
+Session::wait_for_state_write ()
+{
+	if (_state_write_thread) {
+		_state_write_thread->join ();
+		_state_write_thread = 0;
+	}
+}
+
 /** Rename a state file.
  *  @param old_name Old snapshot name.
  *  @param new_name New snapshot name.
@@ -742,6 +863,12 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 
 	Glib::Threads::Mutex::Lock lm (save_state_lock);
 
+	/* and let any pending save still being written finish first, so
+	   that it cannot overwrite this one.
+	*/
+
+	wait_for_state_write ();
+
 	if (!_writable || (_state_of_the_state & CannotSave)) {
 		return 1;
 	}
@@ -805,29 +932,36 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 	std::string tmp_path(_session_dir->root_path());
 	tmp_path = Glib::build_filename (tmp_path, legalize_for_path (snapshot_name) + temp_suffix);
 
-	cerr << "actually writing state to " << tmp_path << endl;
-	
-	if (!tree.write (tmp_path)) {
-		error << string_compose (_("state could not be saved to %1"), tmp_path) << endmsg;
-		if (g_remove (tmp_path.c_str()) != 0) {
-			error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
-					tmp_path, g_strerror (errno)) << endmsg;
-		}
-		return -1;
+	if (pending) {
 
-	} else {
+		/* the state has been collected; formatting it and getting it to
+		   disk can happen while the caller gets on with things.
+		*/
 
-		cerr << "renaming state to " << xml_path << endl;
-		
-		if (::g_rename (tmp_path.c_str(), xml_path.c_str()) != 0) {
-			error << string_compose (_("could not rename temporary session file %1 to %2 (%3)"),
-					tmp_path, xml_path, g_strerror(errno)) << endmsg;
-			if (g_remove (tmp_path.c_str()) != 0) {
-				error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
-						tmp_path, g_strerror (errno)) << endmsg;
-			}
-			return -1;
+		XMLTree* bg_tree = new XMLTree;
+		bg_tree->set_root (tree.root ());
+		tree.set_root (0);
+
+		uint32_t pending_file_generation;
+
+		{
+			Glib::Threads::Mutex::Lock lm (_pending_file_lock);
+			pending_file_generation = _pending_file_generation;
 		}
+
+		try {
+			_state_write_thread = Glib::Threads::Thread::create (sigc::bind (sigc::mem_fun (*this, &Session::write_state_in_background), bg_tree, tmp_path, xml_path, pending_file_generation));
+			return 0;
+		} catch (...) {
+			/* no thread; just write it here */
+			tree.set_root (bg_tree->root ());
+			bg_tree->set_root (0);
+			delete bg_tree;
+		}
+	}
+
+	if (write_state_file (tree, tmp_path, xml_path, false)) {
+		return -1;
 	}
 
 	if (!pending) {
@@ -3052,6 +3186,7 @@ Session::cleanup_sources (CleanupReport& rep)
 				::rename (newpath.c_str(), _path.c_str());
 				goto out;
 			}
+			::g_unlink ((peakpath + peakfile_levels_suffix).c_str());
 		}
 
 		rep.paths.push_back (*x);
@@ -3656,6 +3791,10 @@ Session::config_changed (std::string p, bool ours)
 		}
 	}  else if (p == "denormal-model") {
 		setup_fpu ();
+	} else if (p == "dsp-profiling") {
+		/* start from a clean slate rather than mixing in old timings */
+		reset_dsp_timings ();
+		DSPProfiler::set_enabled (Config->get_dsp_profiling ());
 	} else if (p == "history-depth") {
 		set_history_depth (Config->get_history_depth());
 	} else if (p == "remote-model") {
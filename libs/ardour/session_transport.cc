@@ -1943,8 +1943,16 @@ Session::xrun_recovery ()
 }
 
 void
-Session::route_processors_changed (RouteProcessorChange c)
+Session::route_processors_changed (RouteProcessorChange c, boost::weak_ptr<Route> wr)
 {
+	if (c.type == RouteProcessorChange::GeneralChange) {
+		/* sends may have come or gone; note that even if we are
+		   otherwise ignoring the change, so that the next resort
+		   finds them.
+		*/
+		route_graph_changed (wr);
+	}
+
 	if (ignore_route_processor_changes) {
 		return;
 	}
@@ -65,6 +65,8 @@ SMFSource::SMFSource (Session& s, const string& path, Source::Flag flags)
 	, _last_ev_time_frames(0)
 	, _smf_last_read_end (0)
 	, _smf_last_read_time (0)
+	, _read_buffer (0)
+	, _read_buffer_size (0)
 {
 	/* note that origin remains empty */
 
@@ -101,6 +103,8 @@ SMFSource::SMFSource (Session& s, const string& path)
 	, _last_ev_time_frames(0)
 	, _smf_last_read_end (0)
 	, _smf_last_read_time (0)
+	, _read_buffer (0)
+	, _read_buffer_size (0)
 {
 	/* note that origin remains empty */
 
@@ -133,6 +137,8 @@ SMFSource::SMFSource (Session& s, const XMLNode& node, bool must_exist)
 	, _last_ev_time_frames(0)
 	, _smf_last_read_end (0)
 	, _smf_last_read_time (0)
+	, _read_buffer (0)
+	, _read_buffer_size (0)
 {
 	if (set_state(node, Stateful::loading_state_version)) {
 		throw failed_constructor ();
@@ -190,6 +196,8 @@ SMFSource::~SMFSource ()
 	if (removable()) {
 		::g_unlink (_path.c_str());
 	}
+
+	free (_read_buffer);
 }
 
 int
@@ -231,29 +239,19 @@ SMFSource::read_unlocked (const Lock&                    lock,
 	// Output parameters for read_event (which will allocate scratch in buffer as needed)
 	uint32_t ev_delta_t = 0;
 	uint32_t ev_type    = 0;
-	uint32_t ev_size    = 0;
-	uint8_t* ev_buffer  = 0;
+	uint32_t ev_size    = _read_buffer_size;
+	uint8_t* ev_buffer  = _read_buffer;
 
-	size_t scratch_size = 0; // keep track of scratch to minimize reallocs
+	size_t scratch_size = _read_buffer_size; // keep track of scratch to minimize reallocs
 
 	BeatsFramesConverter converter(_session.tempo_map(), source_start);
 
-	const uint64_t start_ticks = converter.from(start).to_ticks();
+	const uint64_t start_ticks = converter.from(start).to_ticks(ppqn());
 	DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: start in ticks %1\n", start_ticks));
 
 	if (_smf_last_read_end == 0 || start != _smf_last_read_end) {
 		DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: seek to %1\n", start));
-		Evoral::SMF::seek_to_start();
-		while (time < start_ticks) {
-			gint ignored;
-
-			ret = read_event(&ev_delta_t, &ev_size, &ev_buffer, &ignored);
-			if (ret == -1) { // EOF
-				_smf_last_read_end = start + duration;
-				return duration;
-			}
-			time += ev_delta_t; // accumulate delta time
-		}
+		time = Evoral::SMF::seek_to_time(start_ticks);
 	} else {
 		DEBUG_TRACE (DEBUG::MidiSourceIO, string_compose ("SMF read_unlocked: set time to %1\n", _smf_last_read_time));
 		time = _smf_last_read_time;
@@ -305,6 +303,9 @@ SMFSource::read_unlocked (const Lock&                    lock,
 		ev_size = scratch_size; // ensure read_event only allocates if necessary
 	}
 
+	_read_buffer      = ev_buffer;
+	_read_buffer_size = max (scratch_size, (size_t) ev_size);
+
 	return duration;
 }
 
@@ -21,19 +21,27 @@
 #include "libardour-config.h"
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include <cerrno>
 #include <climits>
 #include <cstdarg>
 
+#include <map>
+
 #include <sys/stat.h>
 
+#include <boost/weak_ptr.hpp>
+
+#include <glibmm/threads.h>
 #ifdef PLATFORM_WINDOWS
 #include <glibmm/convert.h>
 #endif
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
+#include "ardour/diskstream.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/sndfilesource.h"
 #include "ardour/sndfile_helpers.h"
 #include "ardour/utils.h"
@@ -55,6 +63,109 @@ const Source::Flag SndFileSource::default_writable_flags = Source::Flag (
 		Source::RemovableIfEmpty |
 		Source::CanRename );
 
+class SndFileSource::InterleaveCache
+{
+  public:
+	/** @return the cache for the file at @param path, shared with any
+	 *  other source that has the file open.
+	 */
+	static boost::shared_ptr<InterleaveCache> get (string const & path, uint32_t channels);
+
+	~InterleaveCache ();
+
+	/** Held while reading into, or from, the cache */
+	Glib::Threads::Mutex lock;
+
+	/** Copy @param cnt frames of @param channel from @param start to @param dst,
+	 *  if they are all in the cache.
+	 *  @return true if they were.
+	 */
+	bool read (Sample* dst, uint32_t channel, framepos_t start, framecnt_t cnt) const {
+		if (start < _start || start + cnt > _start + _cnt) {
+			return false;
+		}
+		deinterleave (dst, _buf + (start - _start) * _channels + channel, cnt, _channels);
+		return true;
+	}
+
+	/** @return a buffer for @param cnt frames to be read from @param start,
+	 *  which replace the current contents of the cache.
+	 */
+	Sample* prepare (framepos_t start, framecnt_t cnt) {
+		framecnt_t const want = cnt * _channels;
+		/* the butler reads a chunk at a time; after a longer read, go
+		   back down to that rather than keep the space for good.
+		*/
+		framecnt_t const normal = Diskstream::disk_read_frames () * _channels;
+
+		if (_size < want || (_size > normal && want <= normal)) {
+			delete [] _buf;
+			_size = std::max (want, normal);
+			_buf = new Sample[_size];
+		}
+		_start = start;
+		_cnt = 0;
+		return _buf;
+	}
+
+	/** Mark @param cnt frames of the buffer from prepare() as valid */
+	void filled (framecnt_t cnt) {
+		_cnt = cnt;
+	}
+
+  private:
+	InterleaveCache (string const & path, uint32_t channels)
+		: _path (path), _channels (channels), _buf (0), _size (0), _start (0), _cnt (0) {}
+
+	string     _path;
+	uint32_t   _channels;
+	Sample*    _buf;
+	framecnt_t _size;
+	framepos_t _start;
+	framecnt_t _cnt;
+
+	typedef std::map<string, boost::weak_ptr<InterleaveCache> > Caches;
+	static Glib::Threads::Mutex _caches_lock;
+	static Caches _caches;
+};
+
+Glib::Threads::Mutex SndFileSource::InterleaveCache::_caches_lock;
+SndFileSource::InterleaveCache::Caches SndFileSource::InterleaveCache::_caches;
+
+boost::shared_ptr<SndFileSource::InterleaveCache>
+SndFileSource::InterleaveCache::get (string const & path, uint32_t channels)
+{
+	Glib::Threads::Mutex::Lock lm (_caches_lock);
+
+	boost::shared_ptr<InterleaveCache> c;
+	Caches::iterator i = _caches.find (path);
+
+	if (i != _caches.end()) {
+		c = i->second.lock ();
+	}
+
+	if (!c || c->_channels != channels) {
+		c.reset (new InterleaveCache (path, channels));
+		_caches[path] = c;
+	}
+
+	return c;
+}
+
+SndFileSource::InterleaveCache::~InterleaveCache ()
+{
+	{
+		Glib::Threads::Mutex::Lock lm (_caches_lock);
+		Caches::iterator i = _caches.find (_path);
+		/* it may already have been replaced by a new cache for the same file */
+		if (i != _caches.end() && i->second.expired()) {
+			_caches.erase (i);
+		}
+	}
+
+	delete [] _buf;
+}
+
 SndFileSource::SndFileSource (Session& s, const XMLNode& node)
 	: Source(s, node)
 	, AudioFileSource (s, node)
@@ -258,6 +369,7 @@ SndFileSource::close ()
 		sf_close (_sndfile);
 		last_snd_file_pos = 0;
 		_sndfile = 0;
+		_interleave_cache.reset ();
         
         file_closed ();
 	}
@@ -309,6 +421,10 @@ SndFileSource::open ()
 
 	_length = _info.frames;
 
+	if (_info.channels > 1 && !writable()) {
+		_interleave_cache = InterleaveCache::get (_path, _info.channels);
+	}
+
 #ifdef HAVE_RF64_RIFF
 	if (_file_is_new && _length == 0 && writable()) {
 		if (_flags & RF64_RIFF) {
@@ -440,6 +556,10 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 		memset (dst+file_cnt, 0, sizeof (Sample) * delta);
 	}
 
+	if (file_cnt && _interleave_cache) {
+		return read_interleaved (dst, start, file_cnt);
+	}
+
 	if (file_cnt) {
 
 		if (sf_seek (_sndfile, (sf_count_t) start, SEEK_SET|SFM_READ) != (sf_count_t) start) {
@@ -473,13 +593,40 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 	
 	last_snd_file_pos += nread;
 
-	/* stride through the interleaved data */
+	deinterleave (dst, ptr, nread, _info.channels);
+
+	return nread;
+}
+
+/** Read @param cnt frames of our channel of a multichannel file from
+ *  @param start, via the cache shared with the sources for the other
+ *  channels. The butler refills each channel of a track in turn from the
+ *  same position, so one read of the file serves all of them.
+ */
+framecnt_t
+SndFileSource::read_interleaved (Sample *dst, framepos_t start, framecnt_t cnt) const
+{
+	Glib::Threads::Mutex::Lock lm (_interleave_cache->lock);
+
+	if (_interleave_cache->read (dst, _channel, start, cnt)) {
+		return cnt;
+	}
 
-	for (framecnt_t n = 0; n < nread; ++n) {
-		dst[n] = *ptr;
-		ptr += _info.channels;
+	if (sf_seek (_sndfile, (sf_count_t) start, SEEK_SET|SFM_READ) != (sf_count_t) start) {
+		char errbuf[256];
+		sf_error_str (0, errbuf, sizeof (errbuf) - 1);
+		error << string_compose(_("SndFileSource: could not seek to frame %1 within %2 (%3)"), start, _name.val().substr (1), errbuf) << endmsg;
+		return 0;
 	}
 
+	Sample* interleave_buf = _interleave_cache->prepare (start, cnt);
+	framecnt_t nread = sf_read_float (_sndfile, interleave_buf, cnt * _info.channels) / _info.channels;
+
+	last_snd_file_pos = start + nread;
+
+	_interleave_cache->filled (nread);
+	_interleave_cache->read (dst, _channel, start, nread);
+
 	return nread;
 }
 
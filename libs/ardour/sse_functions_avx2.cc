@@ -0,0 +1,372 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with AVX2 and FMA code generation enabled, and
+ * nothing in it may be called unless the CPU has been found to support both
+ * (see setup_hardware_optimization()).
+ *
+ * Buffers are not assumed to be aligned; unaligned loads and stores cost
+ * nothing extra on the CPUs that have AVX2 when the data happens to be
+ * aligned anyway.
+ */
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "ardour/types.h"
+#include "ardour/mix.h"
+
+using namespace ARDOUR;
+
+static inline float
+horizontal_max (__m256 v)
+{
+	__m128 m = _mm_max_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	m = _mm_max_ps (m, _mm_movehl_ps (m, m));
+	m = _mm_max_ss (m, _mm_shuffle_ps (m, m, _MM_SHUFFLE (1, 1, 1, 1)));
+	return _mm_cvtss_f32 (m);
+}
+
+static inline float
+horizontal_min (__m256 v)
+{
+	__m128 m = _mm_min_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	m = _mm_min_ps (m, _mm_movehl_ps (m, m));
+	m = _mm_min_ss (m, _mm_shuffle_ps (m, m, _MM_SHUFFLE (1, 1, 1, 1)));
+	return _mm_cvtss_f32 (m);
+}
+
+static inline __m256
+clip (__m256 v)
+{
+	return _mm256_min_ps (_mm256_set1_ps (1.0f), _mm256_max_ps (_mm256_set1_ps (-1.0f), v));
+}
+
+float
+x86_avx2_compute_peak (const Sample * buf, pframes_t nframes, float current)
+{
+	const __m256 abs_mask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+	__m256 peak = _mm256_set1_ps (current);
+
+	while (nframes >= 8) {
+		peak = _mm256_max_ps (peak, _mm256_and_ps (abs_mask, _mm256_loadu_ps (buf)));
+		buf += 8;
+		nframes -= 8;
+	}
+
+	return default_compute_peak (buf, nframes, horizontal_max (peak));
+}
+
+void
+x86_avx2_find_peaks (const Sample * buf, pframes_t nframes, float *minf, float *maxf)
+{
+	__m256 lo = _mm256_set1_ps (*minf);
+	__m256 hi = _mm256_set1_ps (*maxf);
+
+	while (nframes >= 8) {
+		__m256 s = _mm256_loadu_ps (buf);
+		lo = _mm256_min_ps (lo, s);
+		hi = _mm256_max_ps (hi, s);
+		buf += 8;
+		nframes -= 8;
+	}
+
+	*minf = horizontal_min (lo);
+	*maxf = horizontal_max (hi);
+
+	default_find_peaks (buf, nframes, minf, maxf);
+}
+
+void
+x86_avx2_apply_gain_to_buffer (Sample * buf, pframes_t nframes, float gain)
+{
+	const __m256 g = _mm256_set1_ps (gain);
+
+	while (nframes >= 8) {
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), g));
+		buf += 8;
+		nframes -= 8;
+	}
+
+	default_apply_gain_to_buffer (buf, nframes, gain);
+}
+
+void
+x86_avx2_mix_buffers_with_gain (Sample * dst, const Sample * src, pframes_t nframes, float gain)
+{
+	const __m256 g = _mm256_set1_ps (gain);
+
+	while (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_fmadd_ps (_mm256_loadu_ps (src), g, _mm256_loadu_ps (dst)));
+		dst += 8;
+		src += 8;
+		nframes -= 8;
+	}
+
+	default_mix_buffers_with_gain (dst, src, nframes, gain);
+}
+
+void
+x86_avx2_mix_buffers_no_gain (Sample * dst, const Sample * src, pframes_t nframes)
+{
+	while (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_add_ps (_mm256_loadu_ps (dst), _mm256_loadu_ps (src)));
+		dst += 8;
+		src += 8;
+		nframes -= 8;
+	}
+
+	default_mix_buffers_no_gain (dst, src, nframes);
+}
+
+/* See x86_sse_apply_gain_ramp(); this is the same thing eight samples at a time. */
+gain_t
+x86_avx2_apply_gain_ramp (Sample * buf, pframes_t nframes, gain_t initial, gain_t target, gain_t coefficient)
+{
+	const double r = 1.0 - coefficient;
+	float p[8];
+	double rn = 1.0;
+
+	for (int n = 0; n < 8; ++n) {
+		p[n] = rn;
+		rn *= r;
+	}
+
+	const __m256 powers = _mm256_loadu_ps (p);
+	const __m256 t = _mm256_set1_ps (target);
+	double d = initial - target;
+
+	while (nframes >= 8) {
+		__m256 g = _mm256_fmadd_ps (_mm256_set1_ps (d), powers, t);
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), g));
+		d *= rn;
+		buf += 8;
+		nframes -= 8;
+	}
+
+	while (nframes > 0) {
+		*buf++ *= target + d;
+		d *= r;
+		--nframes;
+	}
+
+	return target + d;
+}
+
+void
+x86_avx2_apply_gain_vector (Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	while (nframes >= 8) {
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), _mm256_loadu_ps (gain)));
+		buf += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	default_apply_gain_vector (buf, gain, nframes);
+}
+
+void
+x86_avx2_apply_inverse_gain_vector (Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	const __m256 one = _mm256_set1_ps (1.0f);
+
+	while (nframes >= 8) {
+		__m256 g = _mm256_sub_ps (one, _mm256_loadu_ps (gain));
+		_mm256_storeu_ps (buf, _mm256_mul_ps (_mm256_loadu_ps (buf), g));
+		buf += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	default_apply_inverse_gain_vector (buf, gain, nframes);
+}
+
+void
+x86_avx2_mix_buffers_with_gain_vector (Sample * dst, const Sample * src, const gain_t * gain, pframes_t nframes)
+{
+	while (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_fmadd_ps (_mm256_loadu_ps (src), _mm256_loadu_ps (gain), _mm256_loadu_ps (dst)));
+		dst += 8;
+		src += 8;
+		gain += 8;
+		nframes -= 8;
+	}
+
+	default_mix_buffers_with_gain_vector (dst, src, gain, nframes);
+}
+
+void
+x86_avx2_interleave (Sample * dst, const Sample * src, pframes_t nframes, uint32_t nchannels)
+{
+	if (nchannels == 2) {
+		/* write every other slot, leaving the other channel's samples alone */
+		const __m256i even = _mm256_setr_epi32 (-1, 0, -1, 0, -1, 0, -1, 0);
+		const __m256i spread = _mm256_setr_epi32 (0, 0, 1, 1, 2, 2, 3, 3);
+		const __m256i spread_hi = _mm256_setr_epi32 (4, 4, 5, 5, 6, 6, 7, 7);
+
+		while (nframes >= 8) {
+			__m256 s = _mm256_loadu_ps (src);
+			_mm256_maskstore_ps (dst, even, _mm256_permutevar8x32_ps (s, spread));
+			_mm256_maskstore_ps (dst + 8, even, _mm256_permutevar8x32_ps (s, spread_hi));
+			src += 8;
+			dst += 16;
+			nframes -= 8;
+		}
+	}
+
+	default_interleave (dst, src, nframes, nchannels);
+}
+
+void
+x86_avx2_deinterleave (Sample * dst, const Sample * src, pframes_t nframes, uint32_t nchannels)
+{
+	if (nchannels == 2) {
+		/* as in x86_sse_deinterleave(), the last sample of a block of
+		   eight frames may lie beyond the end of the data.
+		*/
+		while (nframes > 8) {
+			__m256 a = _mm256_loadu_ps (src);
+			__m256 b = _mm256_loadu_ps (src + 8);
+			__m256 s = _mm256_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+			s = _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (s), _MM_SHUFFLE (3, 1, 2, 0)));
+			_mm256_storeu_ps (dst, s);
+			src += 16;
+			dst += 8;
+			nframes -= 8;
+		}
+	} else if (nchannels > 2) {
+		const int n = nchannels;
+		const __m256i index = _mm256_setr_epi32 (0, n, 2 * n, 3 * n, 4 * n, 5 * n, 6 * n, 7 * n);
+
+		while (nframes >= 8) {
+			_mm256_storeu_ps (dst, _mm256_i32gather_ps (src, index, 4));
+			src += 8 * nchannels;
+			dst += 8;
+			nframes -= 8;
+		}
+	}
+
+	default_deinterleave (dst, src, nframes, nchannels);
+}
+
+void
+x86_avx2_float_to_int16 (int16_t * dst, const Sample * src, pframes_t nframes)
+{
+	const __m256 scale = _mm256_set1_ps (32767.0f);
+
+	while (nframes >= 16) {
+		__m256i a = _mm256_cvttps_epi32 (_mm256_mul_ps (clip (_mm256_loadu_ps (src)), scale));
+		__m256i b = _mm256_cvttps_epi32 (_mm256_mul_ps (clip (_mm256_loadu_ps (src + 8)), scale));
+		/* packing works within each 128 bit lane, so put the lanes back in order */
+		__m256i p = _mm256_permute4x64_epi64 (_mm256_packs_epi32 (a, b), _MM_SHUFFLE (3, 1, 2, 0));
+		_mm256_storeu_si256 ((__m256i *) dst, p);
+		src += 16;
+		dst += 16;
+		nframes -= 16;
+	}
+
+	default_float_to_int16 (dst, src, nframes);
+}
+
+void
+x86_avx2_int16_to_float (Sample * dst, const int16_t * src, pframes_t nframes)
+{
+	const __m256 scale = _mm256_set1_ps (1.0f / 32767.0f);
+
+	while (nframes >= 8) {
+		__m256i i = _mm256_cvtepi16_epi32 (_mm_loadu_si128 ((const __m128i *) src));
+		_mm256_storeu_ps (dst, _mm256_mul_ps (_mm256_cvtepi32_ps (i), scale));
+		src += 8;
+		dst += 8;
+		nframes -= 8;
+	}
+
+	default_int16_to_float (dst, src, nframes);
+}
+
+void
+x86_avx2_float_to_int24 (int32_t * dst, const Sample * src, pframes_t nframes)
+{
+	const __m256 scale = _mm256_set1_ps (8388607.0f);
+
+	while (nframes >= 8) {
+		__m256i i = _mm256_cvttps_epi32 (_mm256_mul_ps (clip (_mm256_loadu_ps (src)), scale));
+		_mm256_storeu_si256 ((__m256i *) dst, i);
+		src += 8;
+		dst += 8;
+		nframes -= 8;
+	}
+
+	default_float_to_int24 (dst, src, nframes);
+}
+
+void
+x86_avx2_int24_to_float (Sample * dst, const int32_t * src, pframes_t nframes)
+{
+	const __m256 scale = _mm256_set1_ps (1.0f / 8388607.0f);
+
+	while (nframes >= 8) {
+		__m256i i = _mm256_loadu_si256 ((const __m256i *) src);
+		_mm256_storeu_ps (dst, _mm256_mul_ps (_mm256_cvtepi32_ps (i), scale));
+		src += 8;
+		dst += 8;
+		nframes -= 8;
+	}
+
+	default_int24_to_float (dst, src, nframes);
+}
+
+/* 32 bit conversions go through double, as the scalar versions do */
+
+void
+x86_avx2_float_to_int32 (int32_t * dst, const Sample * src, pframes_t nframes)
+{
+	const __m256d scale = _mm256_set1_pd (2147483647.0);
+
+	while (nframes >= 8) {
+		__m256 s = clip (_mm256_loadu_ps (src));
+		__m128i a = _mm256_cvttpd_epi32 (_mm256_mul_pd (_mm256_cvtps_pd (_mm256_castps256_ps128 (s)), scale));
+		__m128i b = _mm256_cvttpd_epi32 (_mm256_mul_pd (_mm256_cvtps_pd (_mm256_extractf128_ps (s, 1)), scale));
+		_mm_storeu_si128 ((__m128i *) dst, a);
+		_mm_storeu_si128 ((__m128i *) (dst + 4), b);
+		src += 8;
+		dst += 8;
+		nframes -= 8;
+	}
+
+	default_float_to_int32 (dst, src, nframes);
+}
+
+void
+x86_avx2_int32_to_float (Sample * dst, const int32_t * src, pframes_t nframes)
+{
+	const __m256d scale = _mm256_set1_pd (1.0 / 2147483647.0);
+
+	while (nframes >= 8) {
+		__m128 a = _mm256_cvtpd_ps (_mm256_mul_pd (_mm256_cvtepi32_pd (_mm_loadu_si128 ((const __m128i *) src)), scale));
+		__m128 b = _mm256_cvtpd_ps (_mm256_mul_pd (_mm256_cvtepi32_pd (_mm_loadu_si128 ((const __m128i *) (src + 4))), scale));
+		_mm256_storeu_ps (dst, _mm256_insertf128_ps (_mm256_castps128_ps256 (a), b, 1));
+		src += 8;
+		dst += 8;
+		nframes -= 8;
+	}
+
+	default_int32_to_float (dst, src, nframes);
+}
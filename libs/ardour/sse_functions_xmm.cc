@@ -20,6 +20,9 @@
 
 #include <xmmintrin.h>
 #include "ardour/types.h"
+#include "ardour/mix.h"
+
+using namespace ARDOUR;
 
 void
 x86_sse_find_peaks(const ARDOUR::Sample* buf, ARDOUR::pframes_t nframes, float *min, float *max)
@@ -115,5 +118,97 @@ x86_sse_find_peaks(const ARDOUR::Sample* buf, ARDOUR::pframes_t nframes, float *
 	_mm_store_ss(max, work);
 }
 
+/* The smoothed gain n samples on is target + (initial - target) * (1 - coefficient)^n,
+ * so four consecutive gains can be computed at once rather than one after the other.
+ * The distance to the target is carried in double precision, as the scalar version
+ * does with the gain itself.
+ */
+gain_t
+x86_sse_apply_gain_ramp (Sample * buf, pframes_t nframes, gain_t initial, gain_t target, gain_t coefficient)
+{
+	const double r = 1.0 - coefficient;
+	const double r4 = r * r * r * r;
+	const __m128 powers = _mm_set_ps (r * r * r, r * r, r, 1.0f);
+	const __m128 t = _mm_set1_ps (target);
+	double d = initial - target;
+
+	while (nframes >= 4) {
+		__m128 g = _mm_add_ps (t, _mm_mul_ps (_mm_set1_ps (d), powers));
+		_mm_storeu_ps (buf, _mm_mul_ps (_mm_loadu_ps (buf), g));
+		d *= r4;
+		buf += 4;
+		nframes -= 4;
+	}
+
+	while (nframes > 0) {
+		*buf++ *= target + d;
+		d *= r;
+		--nframes;
+	}
+
+	return target + d;
+}
+
+void
+x86_sse_apply_gain_vector (Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	while (nframes >= 4) {
+		_mm_storeu_ps (buf, _mm_mul_ps (_mm_loadu_ps (buf), _mm_loadu_ps (gain)));
+		buf += 4;
+		gain += 4;
+		nframes -= 4;
+	}
 
+	default_apply_gain_vector (buf, gain, nframes);
+}
+
+void
+x86_sse_apply_inverse_gain_vector (Sample * buf, const gain_t * gain, pframes_t nframes)
+{
+	const __m128 one = _mm_set1_ps (1.0f);
 
+	while (nframes >= 4) {
+		__m128 g = _mm_sub_ps (one, _mm_loadu_ps (gain));
+		_mm_storeu_ps (buf, _mm_mul_ps (_mm_loadu_ps (buf), g));
+		buf += 4;
+		gain += 4;
+		nframes -= 4;
+	}
+
+	default_apply_inverse_gain_vector (buf, gain, nframes);
+}
+
+void
+x86_sse_mix_buffers_with_gain_vector (Sample * dst, const Sample * src, const gain_t * gain, pframes_t nframes)
+{
+	while (nframes >= 4) {
+		__m128 s = _mm_mul_ps (_mm_loadu_ps (src), _mm_loadu_ps (gain));
+		_mm_storeu_ps (dst, _mm_add_ps (_mm_loadu_ps (dst), s));
+		dst += 4;
+		src += 4;
+		gain += 4;
+		nframes -= 4;
+	}
+
+	default_mix_buffers_with_gain_vector (dst, src, gain, nframes);
+}
+
+void
+x86_sse_deinterleave (Sample * dst, const Sample * src, pframes_t nframes, uint32_t nchannels)
+{
+	if (nchannels == 2) {
+		/* four frames are eight samples, the last of which may belong
+		   to the next frame, so stop while there is still one to come.
+		*/
+		while (nframes > 4) {
+			__m128 a = _mm_loadu_ps (src);
+			__m128 b = _mm_loadu_ps (src + 4);
+			_mm_storeu_ps (dst, _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+			src += 8;
+			dst += 4;
+			nframes -= 4;
+		}
+	}
+
+	default_deinterleave (dst, src, nframes, nchannels);
+}
@@ -0,0 +1,113 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "ardour/playlist.h"
+#include "ardour/region.h"
+#include "playlist_region_index_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (PlaylistRegionIndexTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+/* All regions are 100 frames long (see AudioRegionTest) */
+
+void
+PlaylistRegionIndexTest::touchedTest ()
+{
+	_playlist->clear ();
+
+	/* 0 at 0-99, 1 at 50-149, 2 at 300-399 */
+	_playlist->add_region (_r[0], 0);
+	_playlist->add_region (_r[1], 50);
+	_playlist->add_region (_r[2], 300);
+
+	boost::shared_ptr<RegionList> rl = _playlist->regions_touched (60, 70);
+	CPPUNIT_ASSERT_EQUAL (size_t (2), rl->size ());
+	CPPUNIT_ASSERT_EQUAL (_r[0], rl->front ());
+	CPPUNIT_ASSERT_EQUAL (_r[1], rl->back ());
+
+	rl = _playlist->regions_touched (100, 299);
+	CPPUNIT_ASSERT_EQUAL (size_t (1), rl->size ());
+	CPPUNIT_ASSERT_EQUAL (_r[1], rl->front ());
+
+	rl = _playlist->regions_touched (150, 299);
+	CPPUNIT_ASSERT (rl->empty ());
+
+	/* end points are inclusive */
+	rl = _playlist->regions_touched (149, 300);
+	CPPUNIT_ASSERT_EQUAL (size_t (2), rl->size ());
+
+	rl = _playlist->regions_at (99);
+	CPPUNIT_ASSERT_EQUAL (size_t (2), rl->size ());
+	CPPUNIT_ASSERT_EQUAL (uint32_t (1), _playlist->count_regions_at (100));
+	CPPUNIT_ASSERT_EQUAL (uint32_t (0), _playlist->count_regions_at (200));
+
+	/* _r[1] was added later, so it is on top */
+	CPPUNIT_ASSERT_EQUAL (_r[1], _playlist->top_region_at (75));
+	CPPUNIT_ASSERT (!_playlist->top_region_at (200));
+}
+
+void
+PlaylistRegionIndexTest::nextRegionTest ()
+{
+	_playlist->clear ();
+
+	_playlist->add_region (_r[0], 0);
+	_playlist->add_region (_r[1], 500);
+	_playlist->add_region (_r[2], 1000);
+
+	CPPUNIT_ASSERT_EQUAL (_r[1], _playlist->find_next_region (0, Start, 1));
+	CPPUNIT_ASSERT_EQUAL (_r[2], _playlist->find_next_region (500, Start, 1));
+	CPPUNIT_ASSERT (!_playlist->find_next_region (1000, Start, 1));
+
+	CPPUNIT_ASSERT_EQUAL (_r[1], _playlist->find_next_region (1000, Start, -1));
+	CPPUNIT_ASSERT_EQUAL (_r[0], _playlist->find_next_region (500, Start, -1));
+	CPPUNIT_ASSERT (!_playlist->find_next_region (0, Start, -1));
+
+	/* ends are at 99, 599 and 1099 */
+	CPPUNIT_ASSERT_EQUAL (_r[1], _playlist->find_next_region (99, End, 1));
+	CPPUNIT_ASSERT_EQUAL (_r[0], _playlist->find_next_region (599, End, -1));
+}
+
+void
+PlaylistRegionIndexTest::boundsChangeTest ()
+{
+	_playlist->clear ();
+
+	_playlist->add_region (_r[0], 0);
+	_playlist->add_region (_r[1], 500);
+
+	CPPUNIT_ASSERT_EQUAL (size_t (1), _playlist->regions_at (50)->size ());
+
+	/* move _r[1] over _r[0] */
+	_r[1]->set_position (10);
+	CPPUNIT_ASSERT_EQUAL (size_t (2), _playlist->regions_at (50)->size ());
+	CPPUNIT_ASSERT (_playlist->regions_at (550)->empty ());
+
+	/* trim _r[0] so that it no longer reaches 50 */
+	_r[0]->trim_end (40);
+	boost::shared_ptr<RegionList> rl = _playlist->regions_at (50);
+	CPPUNIT_ASSERT_EQUAL (size_t (1), rl->size ());
+	CPPUNIT_ASSERT_EQUAL (_r[1], rl->front ());
+
+	/* and remove it */
+	_playlist->remove_region (_r[1]);
+	CPPUNIT_ASSERT (_playlist->regions_at (50)->empty ());
+	CPPUNIT_ASSERT_EQUAL (size_t (1), _playlist->regions_touched (0, 1000)->size ());
+}
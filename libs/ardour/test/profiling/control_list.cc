@@ -0,0 +1,219 @@
+#include "pbd/timing.h"
+#include "evoral/ControlList.hpp"
+#include "evoral/Curve.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+using namespace PBD;
+using namespace Evoral;
+
+/* a dense fader ride: a point every 64 frames */
+static const int npoints = 10000;
+static const double spacing = 64;
+static const int block = 1024;
+static const int passes = 10;
+static const int lookups = 1000;
+static const int edits = 100;
+
+static uint64_t
+average (vector<uint64_t> const & values)
+{
+	uint64_t total = 0;
+	for (vector<uint64_t>::const_iterator i = values.begin(); i != values.end(); ++i) {
+		total += *i;
+	}
+	return total / values.size();
+}
+
+static double
+random_position ()
+{
+	return (rand () / (double) RAND_MAX) * npoints * spacing;
+}
+
+/** Lookups use the list's index while it is current, and walk the list
+ *  otherwise.  mark_dirty() makes the index stale without rebuilding it, and
+ *  freeze() / thaw() rebuilds it, so the two can be timed on the same list.
+ */
+static void
+use_index (ControlList& cl, bool yn)
+{
+	if (yn) {
+		cl.freeze ();
+		cl.thaw ();
+	} else {
+		cl.mark_dirty ();
+	}
+}
+
+/** Render gain automation for the whole list a block at a time, as
+ *  Amp::setup_gain_automation does during playback.
+ */
+static void
+play (ControlList& cl, vector<float>& out)
+{
+	out.resize ((size_t) (npoints * spacing));
+
+	for (size_t n = 0; n + block <= out.size(); n += block) {
+		cl.curve().rt_safe_get_vector (n, n + block - 1, &out[n], block);
+	}
+}
+
+/** Evaluate at random positions, as a locate does */
+static double
+seek (ControlList& cl)
+{
+	double total = 0;
+	for (int n = 0; n < lookups; ++n) {
+		total += cl.eval (random_position ());
+	}
+	return total;
+}
+
+/** Find the next event after random positions, as MIDI controller playback does */
+static double
+earliest (ControlList& cl)
+{
+	double total = 0;
+	for (int n = 0; n < lookups; ++n) {
+		double x;
+		double y;
+		if (cl.rt_safe_earliest_event (random_position (), x, y)) {
+			total += y;
+		}
+	}
+	return total;
+}
+
+/** Add and remove points, as the editor does */
+static void
+edit (ControlList& cl)
+{
+	for (int n = 0; n < edits; ++n) {
+		double const x = random_position ();
+		cl.add (x, 0.5, false, false);
+		cl.erase_range (x - 1, x + 1);
+	}
+}
+
+static void
+report (char const * name, vector<uint64_t> const * elapsed)
+{
+	cout << name << "\n";
+	cout << "\tlist:    " << timing_summary (elapsed[0]);
+	cout << "\tindex:   " << timing_summary (elapsed[1]);
+	cout << "\tspeedup: " << (double) average (elapsed[0]) / max ((uint64_t) 1, average (elapsed[1])) << "\n";
+}
+
+int main ()
+{
+	Parameter param (0);
+	ParameterDescriptor desc;
+	ControlList cl (param, desc);
+
+	cl.create_curve ();
+	cl.set_interpolation (ControlList::Linear);
+
+	for (int n = 0; n < npoints; ++n) {
+		cl.fast_simple_add (n * spacing, 0.5 + 0.5 * sin (n / 50.0));
+	}
+
+	int failed = 0;
+
+	vector<uint64_t> elapsed[2];
+	vector<float> out[2];
+
+	for (int p = 0; p < passes; ++p) {
+		for (int i = 0; i < 2; ++i) {
+			use_index (cl, i);
+			Timing timing;
+			play (cl, out[i]);
+			timing.update ();
+			elapsed[i].push_back (timing.elapsed ());
+		}
+	}
+
+	for (size_t n = 0; n < out[0].size(); ++n) {
+		if (fabs (out[0][n] - out[1][n]) > 1e-6) {
+			cerr << "play: index and list differ at " << n << "\n";
+			++failed;
+			break;
+		}
+	}
+
+	report ("play", elapsed);
+
+	double result[2];
+
+	elapsed[0].clear ();
+	elapsed[1].clear ();
+
+	for (int p = 0; p < passes; ++p) {
+		for (int i = 0; i < 2; ++i) {
+			use_index (cl, i);
+			srand (p);
+			Timing timing;
+			result[i] = seek (cl);
+			timing.update ();
+			elapsed[i].push_back (timing.elapsed ());
+		}
+
+		if (fabs (result[0] - result[1]) > 1e-6) {
+			cerr << "seek: index and list differ\n";
+			++failed;
+		}
+	}
+
+	report ("seek", elapsed);
+
+	elapsed[0].clear ();
+	elapsed[1].clear ();
+
+	for (int p = 0; p < passes; ++p) {
+		for (int i = 0; i < 2; ++i) {
+			use_index (cl, i);
+			srand (p);
+			Timing timing;
+			result[i] = earliest (cl);
+			timing.update ();
+			elapsed[i].push_back (timing.elapsed ());
+		}
+
+		if (fabs (result[0] - result[1]) > 1e-6) {
+			cerr << "earliest event: index and list differ\n";
+			++failed;
+		}
+	}
+
+	report ("earliest event", elapsed);
+
+	elapsed[0].clear ();
+	elapsed[1].clear ();
+
+	for (int p = 0; p < passes; ++p) {
+		for (int i = 0; i < 2; ++i) {
+			/* while the list is frozen its index is not kept up
+			   to date, which leaves the cost of editing the list
+			   on its own; the rebuild on thaw() is not timed.
+			*/
+			if (i == 0) {
+				cl.freeze ();
+			}
+			srand (p);
+			Timing timing;
+			edit (cl);
+			timing.update ();
+			elapsed[i].push_back (timing.elapsed ());
+			if (i == 0) {
+				cl.thaw ();
+			}
+		}
+	}
+
+	report ("edit", elapsed);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
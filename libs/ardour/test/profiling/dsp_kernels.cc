@@ -0,0 +1,380 @@
+#include "pbd/timing.h"
+#include "ardour/ardour.h"
+#include "ardour/mix.h"
+#include "ardour/runtime_functions.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+using namespace PBD;
+using namespace ARDOUR;
+
+static const char* localedir = LOCALEDIR;
+
+static const pframes_t nframes = 1024;
+static const uint32_t nchannels = 2;
+static const int passes = 100;
+static const int calls = 1000;
+
+/* test data, filled in by main() */
+static vector<Sample>  samples;
+static vector<gain_t>  gains;
+static vector<int16_t> samples16;
+static vector<int32_t> samples24;
+static vector<int32_t> samples32;
+
+/** One of the DSP kernels, which can be run either as chosen by
+ *  setup_hardware_optimization() or as the portable default.
+ */
+class Kernel
+{
+  public:
+	Kernel (char const * n) : name (n) {}
+	virtual ~Kernel () {}
+
+	char const * name;
+
+	/** Put the output buffers back to their initial state */
+	virtual void reset () = 0;
+	/** Run the kernel once; the default version if @param d is 0, otherwise the dispatched one */
+	virtual void run (int d) = 0;
+	/** @return the largest difference between the outputs of the two versions */
+	virtual double difference () const = 0;
+};
+
+/** A kernel which writes to a buffer of Ts; out[0] is written by the default
+ *  version and out[1] by the dispatched one.
+ */
+template<typename T>
+class BufferKernel : public Kernel
+{
+  public:
+	BufferKernel (char const * n, size_t size) : Kernel (n) {
+		out[0].resize (size);
+		out[1].resize (size);
+	}
+
+	void reset () {
+		for (int d = 0; d < 2; ++d) {
+			for (size_t n = 0; n < out[d].size(); ++n) {
+				out[d][n] = initial (n);
+			}
+		}
+	}
+
+	double difference () const {
+		double diff = 0;
+		for (size_t n = 0; n < out[0].size(); ++n) {
+			diff = max (diff, fabs ((double) out[0][n] - (double) out[1][n]));
+		}
+		return diff;
+	}
+
+  protected:
+	virtual T initial (size_t n) const { return samples[n]; }
+	vector<T> out[2];
+};
+
+class Peak : public BufferKernel<float>
+{
+  public:
+	Peak () : BufferKernel<float> ("compute_peak", 1) {
+		fn[0] = default_compute_peak;
+		fn[1] = compute_peak;
+	}
+	void run (int d) { out[d][0] = fn[d] (&samples[0], nframes, out[d][0]); }
+  private:
+	float initial (size_t) const { return 0; }
+	compute_peak_t fn[2];
+};
+
+class FindPeaks : public BufferKernel<float>
+{
+  public:
+	FindPeaks () : BufferKernel<float> ("find_peaks", 2) {
+		fn[0] = default_find_peaks;
+		fn[1] = find_peaks;
+	}
+	void run (int d) { fn[d] (&samples[0], nframes, &out[d][0], &out[d][1]); }
+  private:
+	float initial (size_t) const { return 0; }
+	find_peaks_t fn[2];
+};
+
+class Gain : public BufferKernel<Sample>
+{
+  public:
+	Gain () : BufferKernel<Sample> ("apply_gain_to_buffer", nframes) {
+		fn[0] = default_apply_gain_to_buffer;
+		fn[1] = apply_gain_to_buffer;
+	}
+	void run (int d) { fn[d] (&out[d][0], nframes, 0.9f); }
+  private:
+	apply_gain_to_buffer_t fn[2];
+};
+
+class MixWithGain : public BufferKernel<Sample>
+{
+  public:
+	MixWithGain () : BufferKernel<Sample> ("mix_buffers_with_gain", nframes) {
+		fn[0] = default_mix_buffers_with_gain;
+		fn[1] = mix_buffers_with_gain;
+	}
+	void run (int d) { fn[d] (&out[d][0], &samples[nframes], nframes, 0.5f); }
+  private:
+	mix_buffers_with_gain_t fn[2];
+};
+
+/** mix_buffers_no_gain and copy_vector */
+class Mix : public BufferKernel<Sample>
+{
+  public:
+	Mix (char const * n, mix_buffers_no_gain_t def, mix_buffers_no_gain_t dispatched) : BufferKernel<Sample> (n, nframes) {
+		fn[0] = def;
+		fn[1] = dispatched;
+	}
+	void run (int d) { fn[d] (&out[d][0], &samples[nframes], nframes); }
+  private:
+	mix_buffers_no_gain_t fn[2];
+};
+
+class GainRamp : public BufferKernel<Sample>
+{
+  public:
+	GainRamp () : BufferKernel<Sample> ("apply_gain_ramp", nframes) {
+		fn[0] = default_apply_gain_ramp;
+		fn[1] = apply_gain_ramp;
+	}
+	/* the coefficient is the one Amp uses at 48kHz */
+	void run (int d) { fn[d] (&out[d][0], nframes, 0.0f, 1.0f, 156.825f / 48000); }
+  private:
+	apply_gain_ramp_t fn[2];
+};
+
+/** apply_gain_vector and apply_inverse_gain_vector */
+class GainVector : public BufferKernel<Sample>
+{
+  public:
+	GainVector (char const * n, apply_gain_vector_t def, apply_gain_vector_t dispatched) : BufferKernel<Sample> (n, nframes) {
+		fn[0] = def;
+		fn[1] = dispatched;
+	}
+	void run (int d) { fn[d] (&out[d][0], &gains[0], nframes); }
+  private:
+	apply_gain_vector_t fn[2];
+};
+
+class MixWithGainVector : public BufferKernel<Sample>
+{
+  public:
+	MixWithGainVector () : BufferKernel<Sample> ("mix_buffers_with_gain_vector", nframes) {
+		fn[0] = default_mix_buffers_with_gain_vector;
+		fn[1] = mix_buffers_with_gain_vector;
+	}
+	void run (int d) { fn[d] (&out[d][0], &samples[nframes], &gains[0], nframes); }
+  private:
+	mix_buffers_with_gain_vector_t fn[2];
+};
+
+class Interleave : public BufferKernel<Sample>
+{
+  public:
+	Interleave () : BufferKernel<Sample> ("interleave", nframes * nchannels) {
+		fn[0] = default_interleave;
+		fn[1] = interleave;
+	}
+	void run (int d) {
+		for (uint32_t c = 0; c < nchannels; ++c) {
+			fn[d] (&out[d][c], &samples[c * nframes], nframes, nchannels);
+		}
+	}
+  private:
+	interleave_t fn[2];
+};
+
+class Deinterleave : public BufferKernel<Sample>
+{
+  public:
+	Deinterleave () : BufferKernel<Sample> ("deinterleave", nframes * nchannels) {
+		fn[0] = default_deinterleave;
+		fn[1] = deinterleave;
+	}
+	void run (int d) {
+		for (uint32_t c = 0; c < nchannels; ++c) {
+			fn[d] (&out[d][c * nframes], &samples[c], nframes, nchannels);
+		}
+	}
+  private:
+	interleave_t fn[2];
+};
+
+class FloatToInt16 : public BufferKernel<int16_t>
+{
+  public:
+	FloatToInt16 () : BufferKernel<int16_t> ("float_to_int16", nframes) {
+		fn[0] = default_float_to_int16;
+		fn[1] = float_to_int16;
+	}
+	void run (int d) { fn[d] (&out[d][0], &samples[0], nframes); }
+  private:
+	int16_t initial (size_t) const { return 0; }
+	float_to_int16_t fn[2];
+};
+
+class Int16ToFloat : public BufferKernel<Sample>
+{
+  public:
+	Int16ToFloat () : BufferKernel<Sample> ("int16_to_float", nframes) {
+		fn[0] = default_int16_to_float;
+		fn[1] = int16_to_float;
+	}
+	void run (int d) { fn[d] (&out[d][0], &samples16[0], nframes); }
+  private:
+	int16_to_float_t fn[2];
+};
+
+/** float_to_int24 and float_to_int32 */
+class FloatToInt32 : public BufferKernel<int32_t>
+{
+  public:
+	FloatToInt32 (char const * n, float_to_int32_t def, float_to_int32_t dispatched) : BufferKernel<int32_t> (n, nframes) {
+		fn[0] = def;
+		fn[1] = dispatched;
+	}
+	void run (int d) { fn[d] (&out[d][0], &samples[0], nframes); }
+  private:
+	int32_t initial (size_t) const { return 0; }
+	float_to_int32_t fn[2];
+};
+
+/** int24_to_float and int32_to_float */
+class Int32ToFloat : public BufferKernel<Sample>
+{
+  public:
+	Int32ToFloat (char const * n, int32_to_float_t def, int32_to_float_t dispatched, vector<int32_t> const & in)
+		: BufferKernel<Sample> (n, nframes)
+		, input (in)
+	{
+		fn[0] = def;
+		fn[1] = dispatched;
+	}
+	void run (int d) { fn[d] (&out[d][0], &input[0], nframes); }
+  private:
+	int32_to_float_t fn[2];
+	vector<int32_t> const & input;
+};
+
+static float
+random_sample ()
+{
+	/* a little beyond full scale, so that the conversions clip some samples */
+	return (rand () / (float) RAND_MAX) * 2.2f - 1.1f;
+}
+
+static uint64_t
+average (vector<uint64_t> const & values)
+{
+	uint64_t total = 0;
+	for (vector<uint64_t>::const_iterator i = values.begin(); i != values.end(); ++i) {
+		total += *i;
+	}
+	return total / values.size();
+}
+
+/** Time each kernel's dispatched version against its default one, and check
+ *  that the two agree.
+ */
+int main ()
+{
+	ARDOUR::init (false, true, localedir);
+
+	srand (1);
+
+	samples.resize (nframes * nchannels);
+	gains.resize (nframes);
+	samples16.resize (nframes);
+	samples24.resize (nframes);
+	samples32.resize (nframes);
+
+	for (size_t n = 0; n < samples.size(); ++n) {
+		samples[n] = random_sample ();
+	}
+	for (pframes_t n = 0; n < nframes; ++n) {
+		gains[n] = (float) n / nframes;
+		samples16[n] = rand () % 65536 - 32768;
+		samples24[n] = rand () % 16777216 - 8388608;
+		samples32[n] = (int32_t) ((rand () / (double) RAND_MAX * 2.0 - 1.0) * 2147483647.0);
+	}
+
+	vector<Kernel*> kernels;
+
+	kernels.push_back (new Peak);
+	kernels.push_back (new FindPeaks);
+	kernels.push_back (new Gain);
+	kernels.push_back (new MixWithGain);
+	kernels.push_back (new Mix ("mix_buffers_no_gain", default_mix_buffers_no_gain, mix_buffers_no_gain));
+	kernels.push_back (new Mix ("copy_vector", default_copy_vector, copy_vector));
+	kernels.push_back (new GainRamp);
+	kernels.push_back (new GainVector ("apply_gain_vector", default_apply_gain_vector, apply_gain_vector));
+	kernels.push_back (new GainVector ("apply_inverse_gain_vector", default_apply_inverse_gain_vector, apply_inverse_gain_vector));
+	kernels.push_back (new MixWithGainVector);
+	kernels.push_back (new Interleave);
+	kernels.push_back (new Deinterleave);
+	kernels.push_back (new FloatToInt16);
+	kernels.push_back (new Int16ToFloat);
+	kernels.push_back (new FloatToInt32 ("float_to_int24", default_float_to_int24, float_to_int24));
+	kernels.push_back (new Int32ToFloat ("int24_to_float", default_int24_to_float, int24_to_float, samples24));
+	kernels.push_back (new FloatToInt32 ("float_to_int32", default_float_to_int32, float_to_int32));
+	kernels.push_back (new Int32ToFloat ("int32_to_float", default_int32_to_float, int32_to_float, samples32));
+
+	int failed = 0;
+
+	for (vector<Kernel*>::iterator i = kernels.begin(); i != kernels.end(); ++i) {
+
+		Kernel* k = *i;
+
+		/* the vector versions may round differently (fused multiply-adds,
+		   a closed form for the gain ramp), so allow for a few ulps.
+		*/
+
+		k->reset ();
+		k->run (0);
+		k->run (1);
+
+		double const diff = k->difference ();
+		if (diff > 1e-5) {
+			cerr << k->name << ": dispatched version differs from the default by " << diff << "\n";
+			++failed;
+		}
+
+		/* the in-place kernels now run repeatedly over their own output;
+		   denormals are flushed to zero, so that does not affect timing.
+		*/
+
+		vector<uint64_t> elapsed[2];
+
+		for (int p = 0; p < passes; ++p) {
+			for (int d = 0; d < 2; ++d) {
+				Timing timing;
+				for (int c = 0; c < calls; ++c) {
+					k->run (d);
+				}
+				timing.update ();
+				elapsed[d].push_back (timing.elapsed ());
+			}
+		}
+
+		cout << k->name << "\n";
+		cout << "\tdefault:    " << timing_summary (elapsed[0]);
+		cout << "\tdispatched: " << timing_summary (elapsed[1]);
+		cout << "\tspeedup:    " << (double) average (elapsed[0]) / max ((uint64_t) 1, average (elapsed[1])) << "\n";
+
+		delete k;
+	}
+
+	ARDOUR::cleanup ();
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
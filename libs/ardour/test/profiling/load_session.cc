@@ -1,16 +1,121 @@
 #include "test_util.h"
 #include "pbd/failed_constructor.h"
+#include "pbd/timing.h"
+#include "pbd/xml++.h"
 #include "ardour/ardour.h"
 #include "ardour/audioengine.h"
+#include "ardour/filename_extensions.h"
 #include "ardour/session.h"
+#include <glibmm/miscutils.h>
 #include <iostream>
 #include <cstdlib>
+#include <cassert>
 
 using namespace std;
+using namespace PBD;
 using namespace ARDOUR;
 
 static const char* localedir = LOCALEDIR;
 
+static const int xml_passes = 10;
+
+/* Look up a few of the properties that set_state() asks every node for */
+static int
+lookup_properties (XMLNode const & node)
+{
+	int found = 0;
+
+	if (node.property ("id")) {
+		++found;
+	}
+	if (node.property ("name")) {
+		++found;
+	}
+	if (node.property ("flags")) {
+		++found;
+	}
+
+	for (XMLNodeConstIterator i = node.children().begin(); i != node.children().end(); ++i) {
+		found += lookup_properties (**i);
+	}
+
+	return found;
+}
+
+static int
+list_children (XMLNode const & node, char const * name)
+{
+	int found = node.children (name).size ();
+
+	for (XMLNodeConstIterator i = node.children().begin(); i != node.children().end(); ++i) {
+		found += list_children (**i, name);
+	}
+
+	return found;
+}
+
+static int
+iterate_children (XMLNode const & node, char const * name)
+{
+	int found = 0;
+
+	for (XMLNode::NamedChildIterator i (node, name); !i.done(); ++i) {
+		++found;
+	}
+
+	for (XMLNodeConstIterator i = node.children().begin(); i != node.children().end(); ++i) {
+		found += iterate_children (**i, name);
+	}
+
+	return found;
+}
+
+/** Time reading the session file and looking things up in it, which is
+ *  most of what loading the session does with its XML.
+ */
+static void
+profile_xml (string const & path)
+{
+	vector<uint64_t> read;
+	vector<uint64_t> properties;
+	vector<uint64_t> listed;
+	vector<uint64_t> iterated;
+
+	for (int n = 0; n < xml_passes; ++n) {
+		Timing timing;
+
+		XMLTree tree;
+		if (!tree.read (path)) {
+			cerr << "Could not read " << path << "\n";
+			exit (EXIT_FAILURE);
+		}
+		timing.update ();
+		read.push_back (timing.elapsed ());
+
+		timing.start ();
+		lookup_properties (*tree.root ());
+		timing.update ();
+		properties.push_back (timing.elapsed ());
+
+		timing.start ();
+		int const a = list_children (*tree.root (), "Processor");
+		timing.update ();
+		listed.push_back (timing.elapsed ());
+
+		timing.start ();
+		int const b = iterate_children (*tree.root (), "Processor");
+		timing.update ();
+		iterated.push_back (timing.elapsed ());
+
+		assert (a == b);
+	}
+
+	cout << "XML read: " << timing_summary (read);
+	cout << "Property lookup: " << timing_summary (properties);
+	cout << "children(name): " << timing_summary (listed);
+	cout << "NamedChildIterator: " << timing_summary (iterated);
+}
+
 int main (int argc, char* argv[])
 {
 	if (argc != 3) {
@@ -20,8 +125,11 @@ int main (int argc, char* argv[])
 
 	ARDOUR::init (false, true, localedir);
 
+	profile_xml (Glib::build_filename (argv[1], string (argv[2]) + statefile_suffix));
+
 	Session* s = 0;
-	
+	Timing timing;
+
 	try {
 		s = load_session (argv[1], argv[2]);
 	} catch (failed_constructor& e) {
@@ -38,6 +146,9 @@ int main (int argc, char* argv[])
 		exit (EXIT_FAILURE);
 	}
 
+	timing.update ();
+	cout << "Session load: " << timing.elapsed () << " us\n";
+
 	AudioEngine::instance()->remove_session ();
 	delete s;
 	AudioEngine::instance()->stop ();
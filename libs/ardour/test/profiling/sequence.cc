@@ -0,0 +1,212 @@
+#include "pbd/timing.h"
+#include "evoral/Control.hpp"
+#include "evoral/Event.hpp"
+#include "evoral/Sequence.hpp"
+#include "evoral/TypeMap.hpp"
+#include "evoral/midi_events.h"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace PBD;
+using namespace Evoral;
+
+/* a big orchestral region: 100k notes over 16 channels */
+static const int nnotes = 100000;
+static const int passes = 5;
+static const int seeks = 1000;
+static const int edits = 1000;
+
+class BenchTypeMap : public TypeMap {
+public:
+	bool type_is_midi (uint32_t) const { return true; }
+	uint8_t parameter_midi_type (const Parameter&) const { return MIDI_CMD_CONTROL; }
+	uint32_t midi_event_type (uint8_t) const { return 0; }
+	ParameterDescriptor descriptor (const Parameter&) const { return ParameterDescriptor (); }
+	std::string to_symbol (const Parameter&) const { return "control"; }
+};
+
+/** A sequence which, like MidiModel with InsertMergeReject, refuses notes
+ *  which would overlap others.
+ */
+class BenchSequence : public Sequence<Beats> {
+public:
+	BenchSequence (TypeMap const & map) : Sequence<Beats> (map) {}
+
+	boost::shared_ptr<Control> control_factory (const Parameter& param) {
+		const ParameterDescriptor desc;
+		boost::shared_ptr<ControlList> list (new ControlList (param, desc));
+		return boost::shared_ptr<Control> (new Control (param, desc, list));
+	}
+
+	int resolve_overlaps_unlocked (const NotePtr note, void*) {
+		return (!_writing && overlaps_unlocked (note, NotePtr ())) ? -1 : 0;
+	}
+};
+
+struct NoteSpec {
+	double  time;
+	double  length;
+	uint8_t channel;
+	uint8_t note;
+};
+
+static double
+random_beats (double range)
+{
+	return (rand () / (double) RAND_MAX) * range;
+}
+
+static double const length_in_beats = nnotes / 16.0;
+
+static vector<NoteSpec>
+make_notes ()
+{
+	/* sixteen voices, each playing notes back to back in its own range */
+
+	vector<NoteSpec> notes;
+	double t[16] = { 0 };
+
+	srand (1);
+
+	for (int n = 0; n < nnotes; ++n) {
+		NoteSpec s;
+		s.channel = n % 16;
+		s.time = t[s.channel];
+		s.length = 0.25 + random_beats (1.75);
+		s.note = 24 + s.channel * 4 + rand () % 24;
+		t[s.channel] += s.length + random_beats (0.5);
+		notes.push_back (s);
+	}
+
+	return notes;
+}
+
+/** Append the notes' on and off events in time order, as loading an SMF does */
+static void
+load (Sequence<Beats>& seq, vector<NoteSpec> const & notes)
+{
+	vector<pair<double, int> > order;
+
+	for (size_t n = 0; n < notes.size(); ++n) {
+		order.push_back (make_pair (notes[n].time, (int) n));
+		order.push_back (make_pair (notes[n].time + notes[n].length, -1 - (int) n));
+	}
+
+	sort (order.begin(), order.end());
+
+	seq.start_write ();
+
+	uint8_t buf[3];
+	Event<Beats> ev (0, Beats(), 3, buf, false);
+
+	for (vector<pair<double, int> >::const_iterator i = order.begin(); i != order.end(); ++i) {
+		bool const on = i->second >= 0;
+		NoteSpec const & s (notes[on ? i->second : -1 - i->second]);
+		buf[0] = (on ? MIDI_CMD_NOTE_ON : MIDI_CMD_NOTE_OFF) | s.channel;
+		buf[1] = s.note;
+		buf[2] = 64;
+		ev.set_time (Beats (i->first));
+		seq.append (ev, next_event_id ());
+	}
+
+	seq.end_write (Sequence<Beats>::Relax);
+}
+
+/** Play the whole sequence */
+static int
+iterate (Sequence<Beats> const & seq)
+{
+	int n = 0;
+	for (Sequence<Beats>::const_iterator i = seq.begin(); i != seq.end(); ++i) {
+		n += i->buffer()[1];
+	}
+	return n;
+}
+
+/** Locate to random positions and play a little from each, as the butler
+ *  does when the playhead moves.
+ */
+static int
+seek (Sequence<Beats> const & seq)
+{
+	int n = 0;
+	for (int s = 0; s < seeks; ++s) {
+		Sequence<Beats>::const_iterator i = seq.begin (Beats (random_beats (length_in_beats)));
+		for (int e = 0; e < 16 && i != seq.end(); ++e, ++i) {
+			n += i->buffer()[1];
+		}
+	}
+	return n;
+}
+
+/** Add and remove notes at random, as the editor does, checking each added
+ *  note for overlaps.
+ */
+static int
+edit (BenchSequence& seq)
+{
+	int added = 0;
+
+	for (int e = 0; e < edits; ++e) {
+		Sequence<Beats>::NotePtr note (
+			new Note<Beats> (0, Beats (random_beats (length_in_beats)), Beats (0.5), 24 + rand () % 24));
+
+		if (seq.add_note_unlocked (note)) {
+			++added;
+			seq.remove_note_unlocked (note);
+		}
+	}
+
+	return added;
+}
+
+int main ()
+{
+	BenchTypeMap map;
+	vector<NoteSpec> const notes = make_notes ();
+
+	vector<uint64_t> loaded;
+	vector<uint64_t> iterated;
+	vector<uint64_t> sought;
+	vector<uint64_t> edited;
+
+	int result[4] = { 0, 0, 0, 0 };
+
+	for (int p = 0; p < passes; ++p) {
+		BenchSequence seq (map);
+
+		Timing timing;
+		load (seq, notes);
+		timing.update ();
+		loaded.push_back (timing.elapsed ());
+
+		timing.start ();
+		result[0] = iterate (seq);
+		timing.update ();
+		iterated.push_back (timing.elapsed ());
+
+		srand (p);
+		timing.start ();
+		result[1] = seek (seq);
+		timing.update ();
+		sought.push_back (timing.elapsed ());
+
+		srand (p);
+		timing.start ();
+		result[2] = edit (seq);
+		timing.update ();
+		edited.push_back (timing.elapsed ());
+
+		result[3] = seq.notes().size();
+	}
+
+	cout << "notes:   " << result[3] << "\n";
+	cout << "load:    " << timing_summary (loaded);
+	cout << "iterate: " << timing_summary (iterated);
+	cout << "seek:    " << timing_summary (sought);
+	cout << "edit:    " << timing_summary (edited) << "\t(" << result[2] << " of " << edits << " notes added)\n";
+
+	return 0;
+}
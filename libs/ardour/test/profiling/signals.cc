@@ -0,0 +1,61 @@
+#include "pbd/signals.h"
+#include "pbd/timing.h"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace PBD;
+
+static const int emits = 100000;
+static const int passes = 10;
+
+static int received = 0;
+
+static void
+receiver (int n)
+{
+	received += n;
+}
+
+/** Emit a signal with some number of slots connected, as a busy
+ *  PropertyChanged or Changed signal is during editing and playback.
+ */
+static void
+emit (int nslots)
+{
+	Signal1<void, int> signal;
+	ScopedConnectionList connections;
+
+	for (int n = 0; n < nslots; ++n) {
+		signal.connect_same_thread (connections, boost::bind (&receiver, _1));
+	}
+
+	vector<uint64_t> elapsed;
+	received = 0;
+
+	for (int p = 0; p < passes; ++p) {
+		Timing timing;
+		for (int e = 0; e < emits; ++e) {
+			signal (1);
+		}
+		timing.update ();
+		elapsed.push_back (timing.elapsed ());
+	}
+
+	cout << nslots << " slots:\t" << timing_summary (elapsed);
+
+	if (received != nslots * emits * passes) {
+		cerr << "\t" << received << " slot calls, expected " << nslots * emits * passes << "\n";
+	}
+}
+
+int main ()
+{
+	cout << "time for " << emits << " emissions\n";
+
+	emit (0);
+	emit (1);
+	emit (32);
+
+	return 0;
+}
@@ -37,6 +37,7 @@ ThreadBuffers::ThreadBuffers ()
 	, send_gain_automation_buffer (0)
 	, pan_automation_buffer (0)
 	, npan_buffers (0)
+	, _automation_buffer_size (0)
 {
 }
 
@@ -77,6 +78,7 @@ ThreadBuffers::ensure_buffers (ChanCount howmany, size_t custom)
 	}
 
 	size_t audio_buffer_size = custom > 0 ? custom : _engine->raw_buffer_size (DataType::AUDIO) / sizeof (Sample);
+	_automation_buffer_size = audio_buffer_size;
 
 	delete [] gain_automation_buffer;
 	gain_automation_buffer = new gain_t[audio_buffer_size];
@@ -88,6 +90,52 @@ ThreadBuffers::ensure_buffers (ChanCount howmany, size_t custom)
 	allocate_pan_automation_buffers (audio_buffer_size, howmany.n_audio(), false);
 }
 
+static void
+reallocate_buffer_set (BufferSet*& bufs)
+{
+	BufferSet* fresh = new BufferSet;
+
+	for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
+		size_t const n = bufs->available().get (*t);
+		if (n > 0) {
+			fresh->ensure_buffers (*t, n, bufs->buffer_capacity (*t));
+		}
+	}
+
+	delete bufs;
+	bufs = fresh;
+}
+
+/** Free all our buffers and allocate them again, at the same sizes, from
+ *  the calling thread.  Where memory goes on the NUMA node of the thread
+ *  which first touches it, as on Linux, this moves them next to a process
+ *  thread which has just been pinned to a CPU.
+ *
+ *  The caller must make sure that ensure_buffers() cannot run meanwhile.
+ */
+void
+ThreadBuffers::reallocate ()
+{
+	reallocate_buffer_set (silent_buffers);
+	reallocate_buffer_set (scratch_buffers);
+	reallocate_buffer_set (route_buffers);
+	reallocate_buffer_set (mix_buffers);
+
+	if (_automation_buffer_size == 0) {
+		/* never sized */
+		return;
+	}
+
+	delete [] gain_automation_buffer;
+	gain_automation_buffer = new gain_t[_automation_buffer_size];
+	delete [] trim_automation_buffer;
+	trim_automation_buffer = new gain_t[_automation_buffer_size];
+	delete [] send_gain_automation_buffer;
+	send_gain_automation_buffer = new gain_t[_automation_buffer_size];
+
+	allocate_pan_automation_buffers (_automation_buffer_size, npan_buffers, true);
+}
+
 void
 ThreadBuffers::allocate_pan_automation_buffers (framecnt_t nframes, uint32_t howmany, bool force)
 {
@@ -704,6 +704,24 @@ Track::do_refill ()
 	return _diskstream->do_refill ();
 }
 
+int
+Track::do_refill_with_buffers (Sample* mixdown_buffer, gain_t* gain_buffer)
+{
+	return _diskstream->do_refill_with_buffers (mixdown_buffer, gain_buffer);
+}
+
+std::string
+Track::disk_read_path () const
+{
+	return _diskstream->disk_read_path ();
+}
+
+std::string
+Track::disk_write_path () const
+{
+	return _diskstream->disk_write_path ();
+}
+
 int
 Track::do_flush (RunContext c, bool force)
 {
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cstdio> /* for sprintf */
 #include <cstring>
 #include <climits>
@@ -742,7 +743,8 @@ ARDOUR::how_many_dsp_threads ()
 
         /* CALLER MUST HOLD PROCESS LOCK */
 
-        int num_cpu = hardware_concurrency();
+        vector<uint32_t> const cpus = process_thread_cpus ();
+        int num_cpu = cpus.empty() ? hardware_concurrency() : cpus.size();
         int pu = Config->get_processor_usage ();
         uint32_t num_threads = max (num_cpu - 1, 2); // default to number of cpus minus one, or 2, whichever is larger
 
@@ -771,6 +773,64 @@ ARDOUR::how_many_dsp_threads ()
         return num_threads;
 }
 
+vector<uint32_t>
+ARDOUR::process_thread_cpus ()
+{
+	uint32_t const cpu_count = hardware_concurrency ();
+	vector<uint32_t> cpus;
+
+	if (cpu_count > 0) {
+		cpus = parse_cpu_list (Config->get_process_thread_cpus (), cpu_count);
+	} else {
+		cpus = parse_cpu_list (Config->get_process_thread_cpus ());
+	}
+
+	if (!Config->get_process_threads_on_one_socket ()) {
+		return cpus;
+	}
+
+	if (cpus.empty ()) {
+		for (uint32_t c = 0; c < cpu_count; ++c) {
+			cpus.push_back (c);
+		}
+	}
+
+	/* keep to the socket of the first CPU, so that the threads share a
+	   cache and a memory controller.
+	*/
+
+	vector<uint32_t> same_socket;
+	int const package = cpus.empty () ? -1 : cpu_package (cpus.front ());
+
+	for (vector<uint32_t>::const_iterator i = cpus.begin(); i != cpus.end(); ++i) {
+		if (cpu_package (*i) == package) {
+			same_socket.push_back (*i);
+		}
+	}
+
+	return same_socket;
+}
+
+vector<uint32_t>
+ARDOUR::non_process_thread_cpus ()
+{
+	vector<uint32_t> const process = process_thread_cpus ();
+
+	if (process.empty ()) {
+		return process;
+	}
+
+	vector<uint32_t> others;
+
+	for (uint32_t c = 0; c < hardware_concurrency (); ++c) {
+		if (!binary_search (process.begin(), process.end(), c)) {
+			others.push_back (c);
+		}
+	}
+
+	return others;
+}
+
 double
 ARDOUR::gain_to_slider_position_with_max (double g, double max_gain)
 {
@@ -44,6 +44,7 @@ VSTPlugin::VSTPlugin (AudioEngine& engine, Session& session, VSTHandle* handle)
 	, _handle (handle)
 	, _state (0)
 	, _plugin (0)
+	, _tail_length (-1)
 {
 
 }
@@ -75,6 +76,12 @@ void
 VSTPlugin::activate ()
 {
 	_plugin->dispatcher (_plugin, effMainsChanged, 0, 1, NULL, 0.0f);
+
+	/* ask here rather than in the process thread; 0 means the plugin
+	   doesn't say, and 1 that it has no tail.
+	*/
+	intptr_t const tail = _plugin->dispatcher (_plugin, effGetTailSize, 0, 0, NULL, 0.0f);
+	_tail_length = tail == 0 ? -1 : (tail == 1 ? 0 : tail);
 }
 
 int
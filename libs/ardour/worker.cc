@@ -20,28 +20,194 @@
 #include <stdlib.h>
 #include <unistd.h>
 
-#include "ardour/worker.h"
+#include <algorithm>
+#include <vector>
+
+#include <glibmm/threads.h>
+
+#include "pbd/cpus.h"
 #include "pbd/error.h"
+#include "pbd/semaphore.h"
 
-#include <glibmm/timer.h>
+#include "ardour/worker.h"
 
 namespace ARDOUR {
 
+/**
+   The threads which do the work of every Worker.  It is started with the
+   first Worker and stopped with the last, so sessions without plugins that
+   need it have no worker threads at all.
+*/
+class WorkerPool
+{
+public:
+	/** Add a Worker to the pool, starting the pool if necessary. */
+	static WorkerPool* add(Worker* worker);
+
+	/** Remove a Worker from the pool, waiting for any of its work that is
+	    in progress, and stopping the pool if it was the last one.
+	*/
+	static void remove(Worker* worker);
+
+	/** Tell the pool that there is work to do (audio thread). */
+	void wake() { _sem.post(); }
+
+private:
+	WorkerPool();
+	~WorkerPool();
+
+	void    run();
+	Worker* next_ready();
+
+	static Glib::Threads::Mutex _instance_lock;
+	static WorkerPool*          _instance;
+
+	std::vector<Glib::Threads::Thread*> _threads;
+	std::vector<Worker*>                _workers;
+	size_t                              _next;
+	Glib::Threads::Mutex                _lock;
+	Glib::Threads::Cond                 _idle;
+	PBD::Semaphore                      _sem;
+	bool                                _exit;
+};
+
+Glib::Threads::Mutex WorkerPool::_instance_lock;
+WorkerPool*          WorkerPool::_instance = 0;
+
+WorkerPool::WorkerPool()
+	: _next(0)
+	, _sem(0)
+	, _exit(false)
+{
+	uint32_t const n = std::max(1U, hardware_concurrency());
+
+	for (uint32_t i = 0; i < n; ++i) {
+		_threads.push_back(Glib::Threads::Thread::create(sigc::mem_fun(*this, &WorkerPool::run)));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	_exit = true;
+
+	for (size_t i = 0; i < _threads.size(); ++i) {
+		_sem.post();
+	}
+
+	for (size_t i = 0; i < _threads.size(); ++i) {
+		_threads[i]->join();
+	}
+}
+
+WorkerPool*
+WorkerPool::add(Worker* worker)
+{
+	Glib::Threads::Mutex::Lock im(_instance_lock);
+
+	if (!_instance) {
+		_instance = new WorkerPool;
+	}
+
+	Glib::Threads::Mutex::Lock lm(_instance->_lock);
+	_instance->_workers.push_back(worker);
+
+	return _instance;
+}
+
+void
+WorkerPool::remove(Worker* worker)
+{
+	Glib::Threads::Mutex::Lock im(_instance_lock);
+
+	{
+		Glib::Threads::Mutex::Lock lm(_instance->_lock);
+
+		_instance->_workers.erase(
+			std::find(_instance->_workers.begin(), _instance->_workers.end(), worker));
+
+		while (worker->_busy) {
+			_instance->_idle.wait(_instance->_lock);
+		}
+
+		if (!_instance->_workers.empty()) {
+			return;
+		}
+	}
+
+	delete _instance;
+	_instance = 0;
+}
+
+/** @return a Worker which has a request waiting and is not being run by
+    another thread, taking them in turn; must be called with _lock held.
+*/
+Worker*
+WorkerPool::next_ready()
+{
+	size_t const n = _workers.size();
+
+	for (size_t i = 0; i < n; ++i) {
+		Worker* w = _workers[(_next + i) % n];
+		if (!w->_busy && w->have_request()) {
+			_next = (_next + i + 1) % n;
+			return w;
+		}
+	}
+
+	return 0;
+}
+
+void
+WorkerPool::run()
+{
+	void*  buf      = NULL;
+	size_t buf_size = 0;
+
+	while (true) {
+		_sem.wait();
+		if (_exit) {
+			break;
+		}
+
+		Glib::Threads::Mutex::Lock lm(_lock);
+
+		/* a request may arrive for a Worker while another thread is
+		   running it, in which case this thread will find nothing to
+		   do; so the thread which was running it looks again once it
+		   has finished.
+		*/
+
+		Worker* w;
+		while ((w = next_ready()) != 0) {
+			w->_busy = true;
+			lm.release();
+			w->run(buf, buf_size);
+			lm.acquire();
+			w->_busy = false;
+			_idle.broadcast();
+		}
+	}
+
+	free(buf);
+}
+
 Worker::Worker(Workee* workee, uint32_t ring_size)
 	: _workee(workee)
 	, _requests(new RingBuffer<uint8_t>(ring_size))
 	, _responses(new RingBuffer<uint8_t>(ring_size))
 	, _response((uint8_t*)malloc(ring_size))
-	, _sem(0)
-	, _exit(false)
-	, _thread (Glib::Threads::Thread::create(sigc::mem_fun(*this, &Worker::run)))
-{}
+	, _busy(false)
+{
+	_pool = WorkerPool::add(this);
+}
 
 Worker::~Worker()
 {
-	_exit = true;
-	_sem.post();
-	_thread->join();
+	WorkerPool::remove(this);
+
+	delete _requests;
+	delete _responses;
+	free(_response);
 }
 
 bool
@@ -56,14 +222,14 @@ Worker::schedule(uint32_t size, const void* data)
 	if (_requests->write((const uint8_t*)data, size) != size) {
 		return false;
 	}
-	_sem.post();
+	_pool->wake();
 	return true;
 }
 
 bool
 Worker::respond(uint32_t size, const void* data)
 {
-	if (_requests->write_space() < size + sizeof(size)) {
+	if (_responses->write_space() < size + sizeof(size)) {
 		return false;
 	}
 	if (_responses->write((const uint8_t*)&size, sizeof(size)) != sizeof(size)) {
@@ -116,34 +282,25 @@ Worker::emit_responses()
 	}
 }
 
+bool
+Worker::have_request()
+{
+	/* a request which is still being written will be followed by
+	   another wake(), so it can be left until then.
+	*/
+	return verify_message_completeness(_requests);
+}
+
 void
-Worker::run()
+Worker::run(void*& buf, size_t& buf_size)
 {
-	void*  buf      = NULL;
-	size_t buf_size = 0;
-	while (true) {
-		_sem.wait();
-		if (_exit) {
-			if (buf) free(buf);
-			return;
-		}
+	while (have_request()) {
+		uint32_t size;
 
-		uint32_t size = _requests->read_space();
-		if (size < sizeof(size)) {
-			PBD::error << "Worker: no work-data on ring buffer" << endmsg;
-			continue;
-		}
-		while (!verify_message_completeness(_requests)) {
-			Glib::usleep(2000);
-			if (_exit) {
-				if (buf) free(buf);
-				return;
-			}
-		}
 		if (_requests->read((uint8_t*)&size, sizeof(size)) < sizeof(size)) {
 			PBD::error << "Worker: Error reading size from request ring"
 			           << endmsg;
-			continue;
+			return;
 		}
 
 		if (size > buf_size) {
@@ -160,7 +317,7 @@ Worker::run()
 		if (_requests->read((uint8_t*)buf, size) < size) {
 			PBD::error << "Worker: Error reading body from request ring"
 			           << endmsg;
-			continue;  // TODO: This is probably fatal
+			return;  // TODO: This is probably fatal
 		}
 
 		_workee->work(size, buf);
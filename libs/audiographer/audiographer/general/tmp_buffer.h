@@ -0,0 +1,106 @@
+#ifndef AUDIOGRAPHER_TMP_BUFFER_H
+#define AUDIOGRAPHER_TMP_BUFFER_H
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/format.hpp>
+
+#include "pbd/signals.h"
+
+#include "audiographer/visibility.h"
+#include "audiographer/exception.h"
+#include "audiographer/process_context.h"
+#include "audiographer/sink.h"
+#include "audiographer/throwing.h"
+#include "audiographer/type_utils.h"
+#include "audiographer/utils/listed_source.h"
+
+namespace AudioGrapher
+{
+
+/** Keeps everything written to it in memory, to be read back like a TmpFile.
+  * For material short enough that the second pass need not go through the disk.
+  */
+template<typename T = DefaultSampleType>
+class /*LIBAUDIOGRAPHER_API*/ TmpBuffer
+  : public ListedSource<T>
+  , public Sink<T>
+  , public Throwing<>
+{
+  public:
+	/** Constructor \n Not RT safe
+	  * \param channels number of interleaved channels
+	  * \param reserve_frames frames to allocate space for up front
+	  */
+	TmpBuffer (ChannelCount channels, framecnt_t reserve_frames = 0)
+		: channels (channels)
+		, read_position (0)
+	{
+		data.reserve (reserve_frames);
+	}
+
+	framecnt_t get_frames_written () const { return data.size (); }
+
+	/// Stores data \n RT safe only while within the space reserved
+	void process (ProcessContext<T> const & c)
+	{
+		if (throw_level (ThrowStrict) && c.channels() != channels) {
+			throw Exception (*this, boost::str (boost::format
+				("Wrong number of channels given to process(), %1% instead of %2%")
+				% c.channels() % channels));
+		}
+
+		data.insert (data.end(), c.data(), c.data() + c.frames());
+
+		if (c.has_flag (ProcessContext<T>::EndOfInput)) {
+			BufferWritten ();
+		}
+	}
+
+	using Sink<T>::process;
+
+	/// Moves back to the start for read() \n RT safe
+	void rewind () { read_position = 0; }
+
+	/** Read data into buffer in \a context, as SndfileReader::read() does.
+	  * The data read is output to the outputs, as well as read into the context
+	  * \n RT safe
+	  * \return number of frames read
+	  */
+	framecnt_t read (ProcessContext<T> & context)
+	{
+		if (throw_level (ThrowStrict) && context.channels() != channels) {
+			throw Exception (*this, boost::str (boost::format
+				("Wrong number of channels given to read(), %1% instead of %2%")
+				% context.channels() % channels));
+		}
+
+		framecnt_t const frames_read = std::min (context.frames(), (framecnt_t) data.size() - read_position);
+
+		if (frames_read > 0) {
+			TypeUtils<T>::copy (&data[read_position], context.data(), frames_read);
+			read_position += frames_read;
+		}
+
+		ProcessContext<T> c_out = context.beginning (frames_read);
+
+		if (frames_read < context.frames()) {
+			c_out.set_flag (ProcessContext<T>::EndOfInput);
+		}
+		this->output (c_out);
+		return frames_read;
+	}
+
+	/// Emitted from process() at the end of input
+	PBD::Signal0<void> BufferWritten;
+
+  private:
+	ChannelCount   channels;
+	std::vector<T> data;
+	framecnt_t     read_position;
+};
+
+} // namespace
+
+#endif // AUDIOGRAPHER_TMP_BUFFER_H
@@ -0,0 +1,75 @@
+#include "tests/utils.h"
+#include "audiographer/general/tmp_buffer.h"
+
+using namespace AudioGrapher;
+
+class TmpBufferTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE (TmpBufferTest);
+  CPPUNIT_TEST (testProcess);
+  CPPUNIT_TEST (testPartialRead);
+  CPPUNIT_TEST_SUITE_END ();
+
+  public:
+	void setUp()
+	{
+		frames = 128;
+		random_data = TestUtils::init_random_data(frames);
+	}
+
+	void tearDown()
+	{
+		delete [] random_data;
+	}
+
+	void testProcess()
+	{
+		uint32_t channels = 2;
+		buffer.reset (new TmpBuffer<float>(channels, frames));
+		AllocatingProcessContext<float> c (random_data, frames, channels);
+		c.set_flag (ProcessContext<float>::EndOfInput);
+		buffer->process (c);
+		CPPUNIT_ASSERT_EQUAL (frames, buffer->get_frames_written());
+
+		TypeUtils<float>::zero_fill (c.data (), c.frames());
+
+		buffer->rewind ();
+		CPPUNIT_ASSERT_EQUAL (frames, buffer->read (c));
+		CPPUNIT_ASSERT (TestUtils::array_equals (random_data, c.data(), c.frames()));
+	}
+
+	void testPartialRead()
+	{
+		uint32_t channels = 2;
+		buffer.reset (new TmpBuffer<float>(channels));
+		sink.reset (new AppendingVectorSink<float>());
+		sink->reset ();
+		buffer->add_output (sink);
+
+		/* written in two pieces, read back in pieces which do not line up */
+		ProcessContext<float> first (random_data, 64, channels);
+		buffer->process (first);
+		ProcessContext<float> second (random_data + 64, frames - 64, channels);
+		second.set_flag (ProcessContext<float>::EndOfInput);
+		buffer->process (second);
+
+		AllocatingProcessContext<float> c (48, channels);
+		framecnt_t read = 0;
+		while (buffer->read (c) == c.frames()) {
+			read += c.frames();
+		}
+
+		CPPUNIT_ASSERT_EQUAL (frames, (framecnt_t) sink->get_data().size());
+		CPPUNIT_ASSERT (TestUtils::array_equals (random_data, sink->get_array(), frames));
+		CPPUNIT_ASSERT_EQUAL ((framecnt_t) 96, read);
+	}
+
+  private:
+	boost::shared_ptr<TmpBuffer<float> > buffer;
+	boost::shared_ptr<AppendingVectorSink<float> > sink;
+
+	float * random_data;
+	framecnt_t frames;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION (TmpBufferTest);
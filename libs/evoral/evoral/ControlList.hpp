@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 #include <boost/pool/pool.hpp>
@@ -210,21 +211,41 @@ public:
 
 	/** Lookup cache for eval functions, range contains equivalent values */
 	struct LookupCache {
-		LookupCache() : left(-1) {}
+		LookupCache() : left(-1), index(0) {}
 		double left;  /* leftmost x coordinate used when finding "range" */
 		std::pair<ControlList::const_iterator,ControlList::const_iterator> range;
+		size_t index; /* cursor into the index; see index_seek() */
 	};
 
 	/** Lookup cache for point finding, range contains points after left */
 	struct SearchCache {
-		SearchCache () : left(-1) {}
+		SearchCache () : left(-1), index(0) {}
 		double left;  /* leftmost x coordinate used when finding "first" */
 		ControlList::const_iterator first;
+		size_t index; /* position of "first" in the index, when it is current */
 	};
 
 	const EventList& events() const { return _events; }
 	double default_value() const { return _default_value; }
 
+	/** The index is a contiguous copy of the events' times and values,
+	 *  which is rebuilt whenever the list changes (other than while it is
+	 *  frozen) so that lookups are a binary search rather than a walk of
+	 *  the list.  It must only be used while holding the lock, and only if
+	 *  index_current() says that it matches events().
+	 */
+	bool index_current () const { return !_index_dirty; }
+	const std::vector<double>&        index_when ()   const { return _index_when; }
+	const std::vector<double>&        index_value ()  const { return _index_value; }
+	const std::vector<ControlEvent*>& index_events () const { return _index_events; }
+
+	/** @return the position in the index of the first event at or after
+	 *  @param x, starting the search at @param cursor, which is usually the
+	 *  result of the previous call, so that evaluating successive times
+	 *  costs O(1) rather than O(log n) each.
+	 */
+	size_t index_seek (double x, size_t cursor) const;
+
 	// FIXME: const violations for Curve
 	Glib::Threads::RWLock& lock()       const { return _lock; }
 	LookupCache& lookup_cache() const { return _lookup_cache; }
@@ -294,6 +315,8 @@ protected:
 
 	void _x_scale (double factor);
 
+	void unlocked_rebuild_index ();
+
 	mutable LookupCache   _lookup_cache;
 	mutable SearchCache   _search_cache;
 
@@ -310,6 +333,11 @@ protected:
 	double                _default_value;
 	bool                  _sort_pending;
 
+	std::vector<double>        _index_when;
+	std::vector<double>        _index_value;
+	std::vector<ControlEvent*> _index_events;
+	mutable bool               _index_dirty;
+
 	Curve* _curve;
 
   private:
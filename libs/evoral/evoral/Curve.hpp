@@ -45,6 +45,7 @@ private:
 	double multipoint_eval (double x);
 
 	void _get_vector (double x0, double x1, float *arg, int32_t veclen);
+	void render (double lx, double dx, float *vec, int32_t veclen);
 
 	mutable bool       _dirty;
 	const ControlList& _list;
@@ -59,6 +59,7 @@ public:
 	void close() THROW_FILE_ERROR;
 
 	void seek_to_start() const;
+	uint64_t seek_to_time(uint64_t time) const;
 	int  seek_to_track(int track);
 
 	int read_event(uint32_t* delta_t, uint32_t* size, uint8_t** buf, event_id_t* note_id) const;
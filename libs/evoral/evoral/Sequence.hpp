@@ -90,7 +90,11 @@ public:
 	typedef boost::shared_ptr<WriteLockImpl>                     WriteLock;
 
 	virtual ReadLock  read_lock() const { return ReadLock(new Glib::Threads::RWLock::ReaderLock(_lock)); }
-	virtual WriteLock write_lock()      { return WriteLock(new WriteLockImpl(_lock, _control_lock)); }
+	virtual WriteLock write_lock()      {
+		WriteLock lock (new WriteLockImpl(_lock, _control_lock));
+		mark_timeline_dirty ();
+		return lock;
+	}
 
 	void clear();
 
@@ -120,10 +124,14 @@ public:
 		return a->time() < b->time();
 	}
 
+	/** Orders notes by note number, and notes of the same number by time, so
+	 *  that a search for notes of one pitch can stop once it has passed a
+	 *  given time.
+	 */
 	struct NoteNumberComparator {
 		inline bool operator()(const boost::shared_ptr< const Note<Time> > a,
 		                       const boost::shared_ptr< const Note<Time> > b) const {
-			return a->note() < b->note();
+			return a->note() < b->note() || (a->note() == b->note() && a->time() < b->time());
 		}
 	};
 
@@ -215,6 +223,34 @@ public:
 
 private:
 	typedef std::priority_queue<NotePtr, std::deque<NotePtr>, LaterNoteEndComparator> ActiveNotes;
+
+	/** A note on or note off in the timeline */
+	struct TimelineEntry {
+		TimelineEntry (Time t, const NotePtr* n, bool o, uint32_t p)
+			: time (t), note (n), on (o), partner (p) {}
+
+		Time           time;
+		const NotePtr* note;    ///< the note, in _notes
+		bool           on;
+		uint32_t       partner; ///< index of the note's other entry
+	};
+
+	/** Orders entries by time, and an off before an on at the same time
+	 *  unless it is the off of a note of no length.
+	 */
+	struct TimelineEntryComparator {
+		inline static bool off_first (const TimelineEntry& e) {
+			return !e.on && e.time != (*e.note)->time();
+		}
+		inline bool operator()(const TimelineEntry& a, const TimelineEntry& b) const {
+			return a.time < b.time || (a.time == b.time && off_first (a) && !off_first (b));
+		}
+		inline bool operator()(const TimelineEntry& a, Time t) const {
+			return a.time < t;
+		}
+	};
+
+	typedef std::vector<TimelineEntry> Timeline;
 public:
 
 	/** Read iterator */
@@ -248,8 +284,13 @@ public:
 		Time choose_next(Time earliest_t);
 		void set_event();
 
+		void skip_started_notes();
+
 		typedef std::vector<ControlIterator> ControlIterators;
-		enum MIDIMessageType { NIL, NOTE_ON, NOTE_OFF, CONTROL, SYSEX, PATCH_CHANGE };
+		/* NOTE_ON and NOTE_OFF come from the timeline, ACTIVE_NOTE_OFF
+		   from the active notes given to the constructor.
+		*/
+		enum MIDIMessageType { NIL, NOTE_ON, NOTE_OFF, ACTIVE_NOTE_OFF, CONTROL, SYSEX, PATCH_CHANGE };
 
 		const Sequence<Time>*                 _seq;
 		boost::shared_ptr< Event<Time> >      _event;
@@ -261,7 +302,8 @@ public:
 		MIDIMessageType                       _type;
 		bool                                  _is_end;
 		typename Sequence::ReadLock           _lock;
-		typename Notes::const_iterator        _note_iter;
+		size_t                                _timeline_start; ///< first timeline entry at or after the start time
+		size_t                                _timeline_pos;   ///< next timeline entry
 		typename SysExes::const_iterator      _sysex_iter;
 		typename PatchChanges::const_iterator _patch_change_iter;
 		ControlIterators                      _control_iters;
@@ -329,12 +371,15 @@ protected:
 
 	virtual void control_list_marked_dirty ();
 
-private:
-	friend class const_iterator;
+	/** Called with the write lock held by anything which may change the notes */
+	void mark_timeline_dirty () { _timeline_dirty = true; }
 
 	bool overlaps_unlocked (const NotePtr& ev, const NotePtr& ignore_this_note) const;
 	bool contains_unlocked (const NotePtr& ev) const;
 
+private:
+	friend class const_iterator;
+
 	void append_note_on_unlocked(const MIDIEvent<Time>& event, Evoral::event_id_t);
 	void append_note_off_unlocked(const MIDIEvent<Time>& event);
 	void append_control_unlocked(const Parameter& param, Time time, double value, Evoral::event_id_t);
@@ -344,6 +389,9 @@ private:
 	void get_notes_by_pitch (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 	void get_notes_by_velocity (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 
+	void update_timeline () const;
+	void update_note_range ();
+
 	const TypeMap& _type_map;
 
 	Notes        _notes;       // notes indexed by time
@@ -351,6 +399,22 @@ private:
 	SysExes      _sysexes;
 	PatchChanges _patch_changes;
 
+	/** Every note on and off in _notes, in the order in which const_iterator
+	 *  plays them.  It is rebuilt by the first iterator created after the
+	 *  notes have changed, and is only touched by readers in between, so
+	 *  playback walks a flat array rather than the note tree.
+	 *
+	 *  Only notes are pre-merged.  const_iterator still merges the timeline
+	 *  with controllers, sysexes and patch changes as it goes: controller
+	 *  events are produced by interpolating each ControlList as it is read,
+	 *  so they cannot be laid out in advance, and sequences rarely have
+	 *  enough sysexes or patch changes for merging them to matter.
+	 */
+	mutable Timeline             _timeline;
+	mutable Time                 _timeline_max_length; ///< of the longest note in _timeline
+	mutable bool                 _timeline_dirty;
+	mutable Glib::Threads::Mutex _timeline_lock;
+
 	typedef std::multiset<NotePtr, EarlierNoteComparator> WriteNotes;
 	WriteNotes _write_notes[16];
 
@@ -27,6 +27,7 @@
 #define isnan_local std::isnan
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -58,6 +59,7 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 	_interpolation = desc.toggled ? Discrete : Linear;
 	_frozen = 0;
 	_changed_when_thawed = false;
+	_index_dirty = true;
 	_min_yval = desc.lower;
 	_max_yval = desc.upper;
 	_default_value = desc.normal;
@@ -72,6 +74,7 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
+	unlocked_rebuild_index ();
 }
 
 ControlList::ControlList (const ControlList& other)
@@ -82,6 +85,7 @@ ControlList::ControlList (const ControlList& other)
 {
 	_frozen = 0;
 	_changed_when_thawed = false;
+	_index_dirty = true;
 	_min_yval = other._min_yval;
 	_max_yval = other._max_yval;
 	_default_value = other._default_value;
@@ -98,6 +102,7 @@ ControlList::ControlList (const ControlList& other)
 	copy_events (other);
 
 	mark_dirty ();
+	unlocked_rebuild_index ();
 }
 
 ControlList::ControlList (const ControlList& other, double start, double end)
@@ -108,6 +113,7 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 {
 	_frozen = 0;
 	_changed_when_thawed = false;
+	_index_dirty = true;
 	_min_yval = other._min_yval;
 	_max_yval = other._max_yval;
 	_default_value = other._default_value;
@@ -131,6 +137,7 @@ ControlList::ControlList (const ControlList& other, double start, double end)
 	most_recent_insert_iterator = _events.end();
 
 	mark_dirty ();
+	unlocked_rebuild_index ();
 }
 
 ControlList::~ControlList()
@@ -207,9 +214,74 @@ ControlList::maybe_signal_changed ()
 
 	if (_frozen) {
 		_changed_when_thawed = true;
+	} else {
+		Glib::Threads::RWLock::WriterLock lm (_lock);
+		unlocked_rebuild_index ();
 	}
 }
 
+/** Bring the index back into line with _events; must be called with the
+ *  writer lock held.  This is O(n), but so is the list walk that every edit
+ *  already does to find its place.
+ */
+void
+ControlList::unlocked_rebuild_index ()
+{
+	if (!_index_dirty) {
+		return;
+	}
+
+	_index_when.clear ();
+	_index_value.clear ();
+	_index_events.clear ();
+
+	_index_when.reserve (_events.size());
+	_index_value.reserve (_events.size());
+	_index_events.reserve (_events.size());
+
+	for (const_iterator i = _events.begin(); i != _events.end(); ++i) {
+		_index_when.push_back ((*i)->when);
+		_index_value.push_back ((*i)->value);
+		_index_events.push_back (*i);
+	}
+
+	_lookup_cache.index = 0;
+	_search_cache.index = 0;
+	_index_dirty = false;
+
+	if (_curve && _interpolation == Curved) {
+		/* solve now, rather than in the first reader, which is
+		   likely to be the process thread.
+		*/
+		_curve->solve ();
+	}
+}
+
+size_t
+ControlList::index_seek (double x, size_t cursor) const
+{
+	std::vector<double>::const_iterator const b = _index_when.begin();
+	size_t const n = _index_when.size();
+
+	if (cursor > n) {
+		cursor = n;
+	}
+
+	if (cursor > 0 && _index_when[cursor - 1] >= x) {
+		/* moved backwards */
+		return lower_bound (b, b + cursor, x) - b;
+	}
+
+	/* moved forwards, usually by no more than a point or two */
+	for (int steps = 0; cursor < n && _index_when[cursor] < x; ++cursor) {
+		if (++steps == 4) {
+			return lower_bound (b + cursor, _index_when.end(), x) - b;
+		}
+	}
+
+	return cursor;
+}
+
 void
 ControlList::clear ()
 {
@@ -330,9 +402,20 @@ ControlList::fast_simple_add (double when, double value)
 {
 	Glib::Threads::RWLock::WriterLock lm (_lock);
 	/* to be used only for loading pre-sorted data from saved state */
-	_events.insert (_events.end(), new ControlEvent (when, value));
+	ControlEvent* ev = new ControlEvent (when, value);
+	_events.insert (_events.end(), ev);
+
+	bool const index_was_current = !_index_dirty;
 
 	mark_dirty ();
+
+	if (index_was_current) {
+		/* appending to the index keeps a load of n points O(n) */
+		_index_when.push_back (when);
+		_index_value.push_back (value);
+		_index_events.push_back (ev);
+		_index_dirty = false;
+	}
 }
 
 void
@@ -389,6 +472,7 @@ ControlList::set_in_write_pass (bool yn, bool add_point, double when)
 
 	if (yn && add_point) {
 		add_guard_point (when);
+		mark_dirty ();
 	}
 }
 
@@ -885,6 +969,8 @@ ControlList::thaw ()
 			unlocked_invalidate_insert_iterator ();
 			_sort_pending = false;
 		}
+
+		unlocked_rebuild_index ();
 	}
 }
 
@@ -896,6 +982,7 @@ ControlList::mark_dirty () const
 	_lookup_cache.range.second = _events.end();
 	_search_cache.left = -1;
 	_search_cache.first = _events.end();
+	_index_dirty = true;
 
 	if (_curve) {
 		_curve->mark_dirty();
@@ -1117,6 +1204,20 @@ ControlList::unlocked_eval (double x) const
 	double lval, uval;
 	double fraction;
 
+	if (!_index_dirty) {
+		size_t const n = _index_when.size();
+
+		if (n == 0) {
+			return _default_value;
+		} else if (x >= _index_when[n - 1]) {
+			return _index_value[n - 1];
+		} else if (x <= _index_when[0]) {
+			return _index_value[0];
+		}
+
+		return multipoint_eval (x);
+	}
+
 	const_iterator length_check_iter = _events.begin();
 	for (npoints = 0; npoints < 4; ++npoints, ++length_check_iter) {
 		if (length_check_iter == _events.end()) {
@@ -1172,6 +1273,29 @@ ControlList::multipoint_eval (double x) const
 	double uval, lval;
 	double fraction;
 
+	if (!_index_dirty) {
+		/* unlocked_eval() has dealt with x outside the points, so
+		   normally 0 < i < n here.
+		*/
+		size_t const i = _lookup_cache.index = index_seek (x, _lookup_cache.index);
+
+		if (i == _index_when.size()) {
+			return _index_value.back();
+		} else if (i == 0 || _index_when[i] == x) {
+			return _index_value[i];
+		} else if (_interpolation == Discrete) {
+			return _index_value[i - 1];
+		}
+
+		lpos = _index_when[i - 1];
+		lval = _index_value[i - 1];
+		upos = _index_when[i];
+		uval = _index_value[i];
+
+		fraction = (double) (x - lpos) / (double) (upos - lpos);
+		return lval + (fraction * (uval - lval));
+	}
+
 	/* "Stepped" lookup (no interpolation) */
 	/* FIXME: no cache.  significant? */
 	if (_interpolation == Discrete) {
@@ -1242,6 +1366,18 @@ ControlList::multipoint_eval (double x) const
 void
 ControlList::build_search_cache_if_necessary (double start) const
 {
+	if (!_index_dirty) {
+		/* The same as below, except that moving the cached position
+		   forward is a binary search rather than a walk.
+		*/
+		if ((_search_cache.left < 0) || (_search_cache.left > start) ||
+		    (_search_cache.index < _index_when.size() && _index_when[_search_cache.index] < start)) {
+			_search_cache.index = index_seek (start, _search_cache.index);
+		}
+		_search_cache.left = start;
+		return;
+	}
+
 	if (_events.empty()) {
 		/* Empty, nothing to cache, move to end. */
 		_search_cache.first = _events.end();
@@ -1315,6 +1451,28 @@ ControlList::rt_safe_earliest_event_discrete_unlocked (double start, double& x,
 {
 	build_search_cache_if_necessary (start);
 
+	if (!_index_dirty) {
+
+		if (_search_cache.index >= _index_when.size()) {
+			/* No points in range */
+			return false;
+		}
+
+		const double when = _index_when[_search_cache.index];
+
+		if (inclusive ? when >= start : when > start) {
+			x = when;
+			y = _index_value[_search_cache.index];
+			/* Move left of cache to this point
+			 * (Optimize for immediate call this cycle within range) */
+			_search_cache.left = x;
+			++_search_cache.index;
+			return true;
+		}
+
+		return false;
+	}
+
 	if (_search_cache.first != _events.end()) {
 		const ControlEvent* const first = *_search_cache.first;
 
@@ -1356,20 +1514,51 @@ ControlList::rt_safe_earliest_event_linear_unlocked (double start, double& x, do
 {
 	// cout << "earliest_event(start: " << start << ", x: " << x << ", y: " << y << ", inclusive: " << inclusive <<  ")" << endl;
 
-	const_iterator length_check_iter = _events.begin();
-	if (_events.empty()) { // 0 events
-		return false;
-	} else if (_events.end() == ++length_check_iter) { // 1 event
-		return rt_safe_earliest_event_discrete_unlocked (start, x, y, inclusive);
+	if (!_index_dirty) {
+		if (_index_when.empty()) { // 0 events
+			return false;
+		} else if (_index_when.size() == 1) { // 1 event
+			return rt_safe_earliest_event_discrete_unlocked (start, x, y, inclusive);
+		}
+	} else {
+		const_iterator length_check_iter = _events.begin();
+		if (_events.empty()) { // 0 events
+			return false;
+		} else if (_events.end() == ++length_check_iter) { // 1 event
+			return rt_safe_earliest_event_discrete_unlocked (start, x, y, inclusive);
+		}
 	}
 
 	// Hack to avoid infinitely repeating the same event
 	build_search_cache_if_necessary (start);
 
-	if (_search_cache.first != _events.end()) {
+	const ControlEvent* first = NULL;
+	const ControlEvent* next = NULL;
+
+	if (!_index_dirty) {
 
-		const ControlEvent* first = NULL;
-		const ControlEvent* next = NULL;
+		size_t const n = _index_events.size();
+
+		if (_search_cache.index >= n) {
+			/* No points in the future, so no steps (towards them) in the future */
+			return false;
+		}
+
+		if (_search_cache.index == 0 || _index_when[_search_cache.index] <= start) {
+			/* Step is after first */
+			first = _index_events[_search_cache.index];
+			if (++_search_cache.index == n) {
+				return false;
+			}
+			next = _index_events[_search_cache.index];
+
+		} else {
+			/* Step is before first */
+			first = _index_events[_search_cache.index - 1];
+			next = _index_events[_search_cache.index];
+		}
+
+	} else if (_search_cache.first != _events.end()) {
 
 		if (_search_cache.first == _events.begin() || (*_search_cache.first)->when <= start) {
 			/* Step is after first */
@@ -1388,82 +1577,82 @@ ControlList::rt_safe_earliest_event_linear_unlocked (double start, double& x, do
 			next = *_search_cache.first;
 		}
 
-		if (inclusive && first->when == start) {
-			x = first->when;
-			y = first->value;
+	} else {
+		/* No points in the future, so no steps (towards them) in the future */
+		return false;
+	}
+
+	if (inclusive && first->when == start) {
+		x = first->when;
+		y = first->value;
+		/* Move left of cache to this point
+		 * (Optimize for immediate call this cycle within range) */
+		_search_cache.left = x;
+		return true;
+	} else if (next->when < start || (!inclusive && next->when == start)) {
+		/* "Next" is before the start, no points left. */
+		return false;
+	}
+
+	if (fabs(first->value - next->value) <= 1) {
+		if (next->when > start) {
+			x = next->when;
+			y = next->value;
 			/* Move left of cache to this point
 			 * (Optimize for immediate call this cycle within range) */
 			_search_cache.left = x;
 			return true;
-		} else if (next->when < start || (!inclusive && next->when == start)) {
-			/* "Next" is before the start, no points left. */
+		} else {
 			return false;
 		}
+	}
 
-		if (fabs(first->value - next->value) <= 1) {
-			if (next->when > start) {
-				x = next->when;
-				y = next->value;
-				/* Move left of cache to this point
-				 * (Optimize for immediate call this cycle within range) */
-				_search_cache.left = x;
-				return true;
-			} else {
-				return false;
-			}
-		}
+	const double slope = (next->value - first->value) / (double)(next->when - first->when);
+	//cerr << "start y: " << start_y << endl;
 
-		const double slope = (next->value - first->value) / (double)(next->when - first->when);
-		//cerr << "start y: " << start_y << endl;
+	//y = first->value + (slope * fabs(start - first->when));
+	y = first->value;
 
-		//y = first->value + (slope * fabs(start - first->when));
-		y = first->value;
+	if (first->value < next->value) // ramping up
+		y = ceil(y);
+	else // ramping down
+		y = floor(y);
+
+	x = first->when + (y - first->value) / (double)slope;
+
+	while ((inclusive && x < start) || (x <= start && y != next->value)) {
 
 		if (first->value < next->value) // ramping up
-			y = ceil(y);
+			y += 1.0;
 		else // ramping down
-			y = floor(y);
+			y -= 1.0;
 
 		x = first->when + (y - first->value) / (double)slope;
+	}
 
-		while ((inclusive && x < start) || (x <= start && y != next->value)) {
-
-			if (first->value < next->value) // ramping up
-				y += 1.0;
-			else // ramping down
-				y -= 1.0;
-
-			x = first->when + (y - first->value) / (double)slope;
-		}
-
-		/*cerr << first->value << " @ " << first->when << " ... "
-		  << next->value << " @ " << next->when
-		  << " = " << y << " @ " << x << endl;*/
+	/*cerr << first->value << " @ " << first->when << " ... "
+	  << next->value << " @ " << next->when
+	  << " = " << y << " @ " << x << endl;*/
 
-		assert(    (y >= first->value && y <= next->value)
-		           || (y <= first->value && y >= next->value) );
+	assert(    (y >= first->value && y <= next->value)
+	           || (y <= first->value && y >= next->value) );
 
 
-		const bool past_start = (inclusive ? x >= start : x > start);
-		if (past_start) {
-			/* Move left of cache to this point
-			 * (Optimize for immediate call this cycle within range) */
-			_search_cache.left = x;
-			assert(inclusive ? x >= start : x > start);
-			return true;
+	const bool past_start = (inclusive ? x >= start : x > start);
+	if (past_start) {
+		/* Move left of cache to this point
+		 * (Optimize for immediate call this cycle within range) */
+		_search_cache.left = x;
+		assert(inclusive ? x >= start : x > start);
+		return true;
+	} else {
+		if (inclusive) {
+			x = next->when;
 		} else {
-			if (inclusive) {
-				x = next->when;
-			} else {
-				x = start;
-			}
-			_search_cache.left = x;
-			return true;
+			x = start;
 		}
-
-	} else {
-		/* No points in the future, so no steps (towards them) in the future */
-		return false;
+		_search_cache.left = x;
+		return true;
 	}
 }
 
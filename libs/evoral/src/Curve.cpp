@@ -200,7 +200,13 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		return;
 	}
 
-	if ((npoints = _list.events().size()) == 0) {
+	if (_list.index_current()) {
+		npoints = _list.index_when().size();
+	} else {
+		npoints = _list.events().size();
+	}
+
+	if (npoints == 0) {
 		/* no events in list, so just fill the entire array with the default value */
 		for (int32_t i = 0; i < veclen; ++i) {
 			vec[i] = _list.default_value();
@@ -312,22 +318,141 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen)
 		return;
 	}
 
-	if (_dirty) {
+	/* the spline coefficients are only used by Curved lists, and
+	   are normally computed when the list's index is rebuilt,
+	   rather than here.
+	*/
+
+	if (_dirty && _list.interpolation() == ControlList::Curved) {
 		solve ();
 	}
 
-	rx = lx;
-
 	double dx = 0;
 	if (veclen > 1) {
 		dx = (hx - lx) / (veclen - 1);
 	}
 
+	if (veclen > 1 && _list.index_current()) {
+		render (lx, dx, vec, veclen);
+		return;
+	}
+
+	rx = lx;
+
 	for (i = 0; i < veclen; ++i, rx += dx) {
 		vec[i] = multipoint_eval (rx);
 	}
 }
 
+/* Spans of a curve, written so that the compiler can vectorize them; x for
+ * vec[k] is x0 + k * dx.
+ */
+
+static void
+fill_span (float* vec, int32_t n, float value)
+{
+	for (int32_t k = 0; k < n; ++k) {
+		vec[k] = value;
+	}
+}
+
+static void
+render_line (float* vec, int32_t n, double y0, double dy)
+{
+	for (int32_t k = 0; k < n; ++k) {
+		vec[k] = y0 + dy * k;
+	}
+}
+
+static void
+render_cubic (float* vec, int32_t n, double x0, double dx, double const * coeff)
+{
+	double const c0 = coeff[0];
+	double const c1 = coeff[1];
+	double const c2 = coeff[2];
+	double const c3 = coeff[3];
+
+	for (int32_t k = 0; k < n; ++k) {
+		double const x = x0 + dx * k;
+		vec[k] = c0 + x * (c1 + x * (c2 + x * c3));
+	}
+}
+
+/** Fill @param vec with the curve's values at @param lx, @param lx + @param dx, ...
+ *  a segment at a time, rather than looking up each value separately; this
+ *  gives the same results as multipoint_eval().  The list's index must be
+ *  current.
+ */
+void
+Curve::render (double lx, double dx, float* vec, int32_t veclen)
+{
+	std::vector<double> const & when (_list.index_when());
+	std::vector<double> const & value (_list.index_value());
+	size_t const npoints = when.size();
+
+	ControlList::LookupCache& lookup_cache = _list.lookup_cache();
+	size_t seg = lookup_cache.index;
+	int32_t i = 0;
+
+	while (i < veclen) {
+
+		double const rx = lx + dx * i;
+
+		/* seg is the first point at or after rx, and so the end of
+		   the segment that rx is in.
+		*/
+
+		seg = _list.index_seek (rx, seg);
+
+		if (seg == npoints) {
+			/* after the last point */
+			fill_span (vec + i, veclen - i, value.back());
+			break;
+		}
+
+		if (seg == 0 || when[seg] == rx) {
+			/* before the first point, or on a control point */
+			vec[i++] = value[seg];
+			continue;
+		}
+
+		/* the samples up to the end of this segment */
+
+		int32_t end = (int32_t) min ((double) veclen, ceil ((when[seg] - lx) / dx));
+
+		while (end > i + 1 && lx + dx * (end - 1) >= when[seg]) {
+			--end;
+		}
+		while (end < veclen && lx + dx * end < when[seg]) {
+			++end;
+		}
+		if (end <= i) {
+			end = i + 1;
+		}
+
+		double const lpos = when[seg - 1];
+		double const lval = value[seg - 1];
+		double const vdelta = value[seg] - lval;
+
+		if (vdelta == 0.0) {
+			fill_span (vec + i, end - i, lval);
+		} else {
+			ControlEvent const * after = _list.index_events()[seg];
+
+			if (_list.interpolation() == ControlList::Curved && after->coeff) {
+				render_cubic (vec + i, end - i, rx, dx, after->coeff);
+			} else {
+				double const slope = vdelta / (when[seg] - lpos);
+				render_line (vec + i, end - i, lval + slope * (rx - lpos), slope * dx);
+			}
+		}
+
+		i = end;
+	}
+
+	lookup_cache.index = seg;
+}
+
 double
 Curve::unlocked_eval (double x)
 {
@@ -347,6 +472,37 @@ Curve::multipoint_eval (double x)
 
 	ControlList::LookupCache& lookup_cache = _list.lookup_cache();
 
+	if (_list.index_current()) {
+
+		std::vector<double> const & when (_list.index_when());
+		std::vector<double> const & value (_list.index_value());
+
+		size_t const i = lookup_cache.index = _list.index_seek (x, lookup_cache.index);
+
+		if (i == when.size()) {
+			/* we're after the last point */
+			return value.back();
+		} else if (i == 0 || when[i] == x) {
+			/* we're before the first point, or on a control point */
+			return value[i];
+		}
+
+		double const vdelta = value[i] - value[i - 1];
+
+		if (vdelta == 0.0) {
+			return value[i - 1];
+		}
+
+		ControlEvent const * after = _list.index_events()[i];
+
+		if (_list.interpolation() == ControlList::Curved && after->coeff) {
+			double x2 = x * x;
+			return after->coeff[0] + (after->coeff[1] * x) + (after->coeff[2] * x2) + (after->coeff[3] * x2 * x);
+		} else {
+			return value[i - 1] + (vdelta * ((x - when[i - 1]) / (when[i] - when[i - 1])));
+		}
+	}
+
 	if ((lookup_cache.left < 0) ||
 	    ((lookup_cache.left > x) ||
 	     (lookup_cache.range.first == _list.events().end()) ||
@@ -216,6 +216,46 @@ SMF::seek_to_start() const
 	}
 }
 
+/** Seek so that the next read_event() returns the first event at or after
+ * \a time, in SMF ticks.  libsmf keeps every event of the track in memory
+ * with its absolute time, so this is a binary search rather than a scan.
+ *
+ * \return the time of the event before that one (0 if there is none), to
+ * which the delta times returned by read_event() should be added.
+ */
+uint64_t
+SMF::seek_to_time(uint64_t time) const
+{
+	Glib::Threads::Mutex::Lock lm (_smf_lock);
+
+	if (!_smf_track) {
+		cerr << "WARNING: SMF seek_to_time() with no track" << endl;
+		return 0;
+	}
+
+	/* libsmf numbers events from 1 */
+	size_t lo = 1;
+	size_t hi = _smf_track->number_of_events + 1;
+
+	while (lo < hi) {
+		size_t const mid = lo + (hi - lo) / 2;
+		if (smf_track_get_event_by_number(_smf_track, mid)->time_pulses < time) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo > _smf_track->number_of_events) {
+		_smf_track->next_event_number = 0; /* end of track */
+	} else {
+		_smf_track->next_event_number = lo;
+		_smf_track->time_of_next_event = smf_track_get_event_by_number(_smf_track, lo)->time_pulses;
+	}
+
+	return lo > 1 ? smf_track_get_event_by_number(_smf_track, lo - 1)->time_pulses : 0;
+}
+
 /** Read an event from the current position in file.
  *
  * File position MUST be at the beginning of a delta time, or this will die very messily.
@@ -81,7 +81,8 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 	, _active_patch_change_message (0)
 	, _type(NIL)
 	, _is_end((t == DBL_MAX) || seq.empty())
-	, _note_iter(seq.notes().end())
+	, _timeline_start(0)
+	, _timeline_pos(0)
 	, _sysex_iter(seq.sysexes().end())
 	, _patch_change_iter(seq.patch_changes().end())
 	, _control_iter(_control_iters.end())
@@ -106,27 +107,18 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 		}
 	}
 
-	// Find first note which begins at or after t
-	_note_iter = seq.note_lower_bound(t);
+	// Find first note on or off at or after t, skipping offs of notes which began before it
+	seq.update_timeline();
+	_timeline_start = lower_bound(seq._timeline.begin(), seq._timeline.end(), t, TimelineEntryComparator())
+		- seq._timeline.begin();
+	_timeline_pos = _timeline_start;
+	skip_started_notes();
 
 	// Find first sysex event at or after t
-	for (typename Sequence<Time>::SysExes::const_iterator i = seq.sysexes().begin();
-	     i != seq.sysexes().end(); ++i) {
-		if ((*i)->time() >= t) {
-			_sysex_iter = i;
-			break;
-		}
-	}
-	assert(_sysex_iter == seq.sysexes().end() || (*_sysex_iter)->time() >= t);
+	_sysex_iter = seq.sysex_lower_bound(t);
 
 	// Find first patch event at or after t
-	for (typename Sequence<Time>::PatchChanges::const_iterator i = seq.patch_changes().begin(); i != seq.patch_changes().end(); ++i) {
-		if ((*i)->time() >= t) {
-			_patch_change_iter = i;
-			break;
-		}
-	}
-	assert (_patch_change_iter == seq.patch_changes().end() || (*_patch_change_iter)->time() >= t);
+	_patch_change_iter = seq.patch_change_lower_bound(t);
 
 	// Find first control event after t
 	_control_iters.reserve(seq._controls.size());
@@ -217,10 +209,32 @@ Sequence<Time>::const_iterator::invalidate(std::set< boost::weak_ptr< Note<Time>
 		}
 		_active_notes.pop();
 	}
+	if (notes && _seq && _lock) {
+		/* Add the notes we have played the on but not the off of,
+		   counting the current entry if it is an on.  No such note can
+		   begin more than the longest note's length before the last
+		   entry we played.
+		*/
+		const Timeline& timeline (_seq->_timeline);
+		const size_t    played = _timeline_pos + (_type == NOTE_ON ? 1 : 0);
+		if (played > _timeline_start) {
+			const Time last = timeline[played - 1].time;
+			for (size_t i = played; i > _timeline_start; --i) {
+				const TimelineEntry& e (timeline[i - 1]);
+				if (e.time + _seq->_timeline_max_length < last) {
+					break;
+				}
+				if (e.on && e.partner >= _timeline_pos) {
+					notes->insert(*e.note);
+				}
+			}
+		}
+	}
 	_type = NIL;
 	_is_end = true;
 	if (_seq) {
-		_note_iter = _seq->notes().end();
+		_timeline_start = 0;
+		_timeline_pos = 0;
 		_sysex_iter = _seq->sysexes().end();
 		_patch_change_iter = _seq->patch_changes().end();
 		_active_patch_change_message = 0;
@@ -236,16 +250,17 @@ Sequence<Time>::const_iterator::choose_next(Time earliest_t)
 {
 	_type = NIL;
 
-	// Next earliest note on
-	if (_note_iter != _seq->notes().end()) {
-		_type      = NOTE_ON;
-		earliest_t = (*_note_iter)->time();
+	// Next earliest note on or off
+	if (_timeline_pos < _seq->_timeline.size()) {
+		const TimelineEntry& e (_seq->_timeline[_timeline_pos]);
+		_type      = e.on ? NOTE_ON : NOTE_OFF;
+		earliest_t = e.time;
 	}
 
-	// Use the next note off iff it's earlier or the same time as the note on
+	// Use the next active note off iff it's earlier or the same time
 	if ((!_active_notes.empty())) {
 		if (_type == NIL || _active_notes.top()->end_time() <= earliest_t) {
-			_type      = NOTE_OFF;
+			_type      = ACTIVE_NOTE_OFF;
 			earliest_t = _active_notes.top()->end_time();
 		}
 	}
@@ -284,11 +299,14 @@ Sequence<Time>::const_iterator::set_event()
 	switch (_type) {
 	case NOTE_ON:
 		DEBUG_TRACE(DEBUG::Sequence, "iterator = note on\n");
-		*_event = (*_note_iter)->on_event();
-		_active_notes.push(*_note_iter);
+		*_event = (*_seq->_timeline[_timeline_pos].note)->on_event();
 		break;
 	case NOTE_OFF:
 		DEBUG_TRACE(DEBUG::Sequence, "iterator = note off\n");
+		*_event = (*_seq->_timeline[_timeline_pos].note)->off_event();
+		break;
+	case ACTIVE_NOTE_OFF:
+		DEBUG_TRACE(DEBUG::Sequence, "iterator = active note off\n");
 		assert(!_active_notes.empty());
 		*_event = _active_notes.top()->off_event();
 		// We don't pop the active note until we increment past it
@@ -319,6 +337,23 @@ Sequence<Time>::const_iterator::set_event()
 	}
 }
 
+/** Move past the offs of notes which began before this iterator's start
+ *  time; those still sounding are the caller's business, through the
+ *  active notes.
+ */
+template<typename Time>
+void
+Sequence<Time>::const_iterator::skip_started_notes()
+{
+	const Timeline& timeline (_seq->_timeline);
+
+	while (_timeline_pos < timeline.size() &&
+	       !timeline[_timeline_pos].on &&
+	       timeline[_timeline_pos].partner < _timeline_start) {
+		++_timeline_pos;
+	}
+}
+
 template<typename Time>
 const typename Sequence<Time>::const_iterator&
 Sequence<Time>::const_iterator::operator++()
@@ -348,9 +383,11 @@ Sequence<Time>::const_iterator::operator++()
 	// Increment past current event
 	switch (_type) {
 	case NOTE_ON:
-		++_note_iter;
-		break;
 	case NOTE_OFF:
+		++_timeline_pos;
+		skip_started_notes();
+		break;
+	case ACTIVE_NOTE_OFF:
 		_active_notes.pop();
 		break;
 	case CONTROL:
@@ -430,7 +467,8 @@ Sequence<Time>::const_iterator::operator=(const const_iterator& other)
 	_active_notes  = other._active_notes;
 	_type          = other._type;
 	_is_end        = other._is_end;
-	_note_iter     = other._note_iter;
+	_timeline_start = other._timeline_start;
+	_timeline_pos  = other._timeline_pos;
 	_sysex_iter    = other._sysex_iter;
 	_patch_change_iter = other._patch_change_iter;
 	_control_iters = other._control_iters;
@@ -462,6 +500,7 @@ Sequence<Time>::Sequence(const TypeMap& type_map)
 	, _overlap_pitch_resolution (FirstOnFirstOff)
 	, _writing(false)
 	, _type_map(type_map)
+	, _timeline_dirty(true)
 	, _end_iter(*this, std::numeric_limits<Time>::max(), false, std::set<Evoral::Parameter> ())
 	, _percussive(false)
 	, _lowest_note(127)
@@ -484,6 +523,7 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
 	, _overlap_pitch_resolution (other._overlap_pitch_resolution)
 	, _writing(false)
 	, _type_map(other._type_map)
+	, _timeline_dirty(true)
 	, _end_iter(*this, std::numeric_limits<Time>::max(), false, std::set<Evoral::Parameter> ())
 	, _percussive(other._percussive)
 	, _lowest_note(other._lowest_note)
@@ -491,7 +531,7 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
 {
 	for (typename Notes::const_iterator i = other._notes.begin(); i != other._notes.end(); ++i) {
 		NotePtr n (new Note<Time> (**i));
-		_notes.insert (n);
+		_notes.insert (_notes.end(), n);
 	}
 
 	for (typename SysExes::const_iterator i = other._sysexes.begin(); i != other._sysexes.end(); ++i) {
@@ -597,6 +637,9 @@ Sequence<Time>::clear()
 {
 	WriteLock lock(write_lock());
 	_notes.clear();
+	for (int i = 0; i < 16; ++i) {
+		_pitches[i].clear();
+	}
 	for (Controls::iterator li = _controls.begin(); li != _controls.end(); ++li)
 		li->second->list()->clear();
 }
@@ -648,13 +691,15 @@ Sequence<Time>::end_write (StuckNoteOption option, Time when)
 				break;
 			case DeleteStuckNotes:
 				cerr << "WARNING: Stuck note lost: " << (*n)->note() << endl;
+				pitches((*n)->channel()).erase (*n);
 				_notes.erase(n);
 				break;
 			case ResolveStuckNotes:
 				if (when <= (*n)->time()) {
 					cerr << "WARNING: Stuck note resolution - end time @ "
 					     << when << " is before note on: " << (**n) << endl;
-					_notes.erase (*n);
+					pitches((*n)->channel()).erase (*n);
+					_notes.erase (n);
 				} else {
 					(*n)->set_length (when - (*n)->time());
 					cerr << "WARNING: resolved note-on with no note-off to generate " << (**n) << endl;
@@ -670,6 +715,8 @@ Sequence<Time>::end_write (StuckNoteOption option, Time when)
 		_write_notes[i].clear();
 	}
 
+	update_note_range ();
+
 	_writing = false;
 }
 
@@ -697,9 +744,11 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 	if (note->note() > _highest_note)
 		_highest_note = note->note();
 
-	_notes.insert (note);
+	/* notes usually arrive in time order, so try the end first */
+	_notes.insert (_notes.end(), note);
 	_pitches[note->channel()].insert (note);
 
+	mark_timeline_dirty ();
 	_edited = true;
 
 	return true;
@@ -730,18 +779,6 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 			DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing note #%2 %3 @ %4\n", this, (*i)->id(), (int)(*i)->note(), (*i)->time()));
 			_notes.erase (i);
 
-			if (note->note() == _lowest_note || note->note() == _highest_note) {
-
-				_lowest_note = 127;
-				_highest_note = 0;
-
-				for (typename Sequence<Time>::Notes::iterator ii = _notes.begin(); ii != _notes.end(); ++ii) {
-					if ((*ii)->note() < _lowest_note)
-						_lowest_note = (*ii)->note();
-					if ((*ii)->note() > _highest_note)
-						_highest_note = (*ii)->note();
-				}
-			}
 
 			erased = true;
 			break;
@@ -770,19 +807,6 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 				DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\tID-based pass, erasing note #%2 %3 @ %4\n", this, (*i)->id(), (int)(*i)->note(), (*i)->time()));
 				_notes.erase (i);
 				
-				if (note->note() == _lowest_note || note->note() == _highest_note) {
-					
-					_lowest_note = 127;
-					_highest_note = 0;
-					
-					for (typename Sequence<Time>::Notes::iterator ii = _notes.begin(); ii != _notes.end(); ++ii) {
-						if ((*ii)->note() < _lowest_note)
-							_lowest_note = (*ii)->note();
-						if ((*ii)->note() > _highest_note)
-							_highest_note = (*ii)->note();
-					}
-				}
-				
 				erased = true;
 				id_matched = true;
 				break;
@@ -814,11 +838,11 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 		} else {
 
 			/* Now find the same note in the "pitches" list (which indexes
-			 * notes by channel+time. We care only about its note number
-			 * so the search_note has all other properties unset.
+			 * notes by channel+pitch+time), starting from the first
+			 * note of the same pitch and time.
 			 */
 			
-			NotePtr search_note (new Note<Time>(0, Time(), Time(), note->note(), 0));
+			NotePtr search_note (new Note<Time>(0, note->time(), Time(), note->note(), 0));
 
 			for (j = p.lower_bound (search_note); j != p.end() && (*j)->note() == note->note(); ++j) {
 				
@@ -834,6 +858,11 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 			warning << string_compose ("erased note %1 not found in pitches for channel %2", *note, (int) note->channel()) << endmsg;
 		}
 
+		if (note->note() == _lowest_note || note->note() == _highest_note) {
+			update_note_range ();
+		}
+
+		mark_timeline_dirty ();
 		_edited = true;
 	
 	} else {
@@ -976,7 +1005,7 @@ Sequence<Time>::append_note_on_unlocked (const MIDIEvent<Time>& ev, event_id_t e
 
 	DEBUG_TRACE (DEBUG::Sequence, string_compose ("Appending active note on %1 channel %2\n",
 	                                              (unsigned)(uint8_t)note->note(), note->channel()));
-	_write_notes[note->channel()].insert (note);
+	_write_notes[note->channel()].insert (_write_notes[note->channel()].end(), note);
 
 }
 
@@ -1114,7 +1143,7 @@ Sequence<Time>::contains_unlocked (const NotePtr& note) const
 	NotePtr search_note(new Note<Time>(0, Time(), Time(), note->note()));
 
 	for (typename Pitches::const_iterator i = p.lower_bound (search_note);
-	     i != p.end() && (*i)->note() == note->note(); ++i) {
+	     i != p.end() && (*i)->note() == note->note() && (*i)->time() <= note->time(); ++i) {
 
 		if (**i == *note) {
 			return true;
@@ -1152,6 +1181,11 @@ Sequence<Time>::overlaps_unlocked (const NotePtr& note, const NotePtr& without)
 		Time sb = (*i)->time();
 		Time eb = (*i)->end_time();
 
+		if (sb > ea) {
+			/* this and all later notes of this pitch start after it ends */
+			break;
+		}
+
 		if (((sb > sa) && (eb <= ea)) ||
 		    ((eb >= sa) && (eb <= ea)) ||
 		    ((sb > sa) && (sb <= ea)) ||
@@ -1168,6 +1202,71 @@ void
 Sequence<Time>::set_notes (const typename Sequence<Time>::Notes& n)
 {
 	_notes = n;
+	mark_timeline_dirty ();
+}
+
+/** Set the lowest and highest note numbers from the notes on each channel */
+template<typename Time>
+void
+Sequence<Time>::update_note_range ()
+{
+	_lowest_note = 127;
+	_highest_note = 0;
+
+	for (int c = 0; c < 16; ++c) {
+		if (_pitches[c].empty()) {
+			continue;
+		}
+		_lowest_note = min (_lowest_note, (*_pitches[c].begin())->note());
+		_highest_note = max (_highest_note, (*_pitches[c].rbegin())->note());
+	}
+}
+
+/** Rebuild the timeline if the notes have changed since it was last built.
+ *  Called with (at least) the read lock held.
+ */
+template<typename Time>
+void
+Sequence<Time>::update_timeline () const
+{
+	Glib::Threads::Mutex::Lock lm (_timeline_lock);
+
+	if (!_timeline_dirty) {
+		return;
+	}
+
+	/* Each note's on and off go in with the index of the note, and get
+	   the index of their partner once they have been sorted.
+	*/
+
+	_timeline.clear ();
+	_timeline.reserve (_notes.size() * 2);
+	_timeline_max_length = Time();
+
+	uint32_t n = 0;
+	for (typename Notes::const_iterator i = _notes.begin(); i != _notes.end(); ++i, ++n) {
+		_timeline.push_back (TimelineEntry ((*i)->time(), &*i, true, n));
+		_timeline.push_back (TimelineEntry ((*i)->end_time(), &*i, false, n));
+		_timeline_max_length = max (_timeline_max_length, (*i)->length());
+	}
+
+	stable_sort (_timeline.begin(), _timeline.end(), TimelineEntryComparator());
+
+	std::vector<uint32_t> ons (n);
+	for (uint32_t i = 0; i < _timeline.size(); ++i) {
+		if (_timeline[i].on) {
+			ons[_timeline[i].partner] = i;
+		}
+	}
+	for (uint32_t i = 0; i < _timeline.size(); ++i) {
+		if (!_timeline[i].on) {
+			TimelineEntry& on (_timeline[ons[_timeline[i].partner]]);
+			_timeline[i].partner = ons[_timeline[i].partner];
+			on.partner = i;
+		}
+	}
+
+	_timeline_dirty = false;
 }
 
 // CONST iterator implementations (x3)
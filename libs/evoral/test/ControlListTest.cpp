@@ -0,0 +1,145 @@
+#include "ControlListTest.hpp"
+#include "evoral/ControlList.hpp"
+#include <stdlib.h>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (ControlListTest);
+
+using namespace std;
+using namespace Evoral;
+
+/* Evaluating a list uses its index when that is current, and walks the list
+ * otherwise; mark_dirty() makes the index stale without rebuilding it, so
+ * these tests compare the two.
+ */
+
+void
+ControlListTest::fill (ControlList& cl)
+{
+	/* a ramp, with a pair of points at the same time, as guard points make */
+	cl.fast_simple_add (   0.0,  0.0);
+	cl.fast_simple_add ( 100.0, 10.0);
+	cl.fast_simple_add ( 200.0, 10.0);
+	cl.fast_simple_add ( 200.0, 90.0);
+	cl.fast_simple_add ( 300.0, 20.0);
+	cl.fast_simple_add (1000.0, 70.0);
+}
+
+void
+ControlListTest::indexedEval ()
+{
+	boost::shared_ptr<ControlList> cl = TestCtrlList ();
+	fill (*cl);
+
+	ControlList::InterpolationStyle const styles[] = { ControlList::Linear, ControlList::Discrete };
+
+	for (int s = 0; s < 2; ++s) {
+		cl->set_interpolation (styles[s]);
+
+		vector<double> indexed;
+		vector<double> walked;
+
+		cl->freeze ();
+		cl->thaw ();
+		CPPUNIT_ASSERT (cl->index_current ());
+
+		/* forwards, then backwards, to exercise the cursor both ways */
+		for (double x = -50; x <= 1050; x += 12.5) {
+			indexed.push_back (cl->eval (x));
+		}
+		for (double x = 1050; x >= -50; x -= 12.5) {
+			indexed.push_back (cl->eval (x));
+		}
+
+		cl->mark_dirty ();
+		CPPUNIT_ASSERT (!cl->index_current ());
+
+		for (double x = -50; x <= 1050; x += 12.5) {
+			walked.push_back (cl->eval (x));
+		}
+		for (double x = 1050; x >= -50; x -= 12.5) {
+			walked.push_back (cl->eval (x));
+		}
+
+		CPPUNIT_ASSERT_EQUAL (walked.size(), indexed.size());
+		for (size_t i = 0; i < walked.size(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (walked[i], indexed[i], 1e-12);
+		}
+	}
+
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (10.0, cl->eval (200.0), 1e-12);
+}
+
+void
+ControlListTest::indexedEarliestEvent ()
+{
+	boost::shared_ptr<ControlList> cl = TestCtrlList ();
+	fill (*cl);
+
+	ControlList::InterpolationStyle const styles[] = { ControlList::Linear, ControlList::Discrete };
+
+	for (int s = 0; s < 2; ++s) {
+		cl->set_interpolation (styles[s]);
+
+		vector<pair<double, double> > indexed;
+		vector<pair<double, double> > walked;
+
+		cl->freeze ();
+		cl->thaw ();
+
+		double x;
+		double y;
+		double start = 0;
+		bool inclusive = true;
+
+		while (indexed.size() < 1000 && cl->rt_safe_earliest_event_unlocked (start, x, y, inclusive)) {
+			indexed.push_back (make_pair (x, y));
+			start = x;
+			inclusive = false;
+		}
+
+		cl->mark_dirty ();
+		start = 0;
+		inclusive = true;
+
+		while (walked.size() < 1000 && cl->rt_safe_earliest_event_unlocked (start, x, y, inclusive)) {
+			walked.push_back (make_pair (x, y));
+			start = x;
+			inclusive = false;
+		}
+
+		CPPUNIT_ASSERT (!indexed.empty ());
+		CPPUNIT_ASSERT_EQUAL (walked.size(), indexed.size());
+		for (size_t i = 0; i < walked.size(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (walked[i].first, indexed[i].first, 1e-12);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (walked[i].second, indexed[i].second, 1e-12);
+		}
+	}
+}
+
+void
+ControlListTest::indexFollowsEdits ()
+{
+	boost::shared_ptr<ControlList> cl = TestCtrlList ();
+	fill (*cl);
+
+	cl->add (500.0, 100.0, false, false);
+	CPPUNIT_ASSERT (cl->index_current ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 7, cl->index_when().size());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (100.0, cl->eval (500.0), 1e-12);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (60.0, cl->eval (400.0), 1e-12);
+
+	cl->erase_range (450.0, 550.0);
+	CPPUNIT_ASSERT (cl->index_current ());
+	CPPUNIT_ASSERT_EQUAL ((size_t) 6, cl->index_when().size());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (45.0, cl->eval (650.0), 1e-12);
+
+	/* while frozen the index is left alone, and brought up to date on thaw */
+	cl->freeze ();
+	cl->shift (0.0, 100.0);
+	CPPUNIT_ASSERT (!cl->index_current ());
+	cl->thaw ();
+	CPPUNIT_ASSERT (cl->index_current ());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (100.0, cl->index_when().front(), 1e-12);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (45.0, cl->eval (750.0), 1e-12);
+}
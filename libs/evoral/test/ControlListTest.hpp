@@ -0,0 +1,28 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <boost/shared_ptr.hpp>
+#include "evoral/ControlList.hpp"
+
+class ControlListTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (ControlListTest);
+	CPPUNIT_TEST (indexedEval);
+	CPPUNIT_TEST (indexedEarliestEvent);
+	CPPUNIT_TEST (indexFollowsEdits);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void indexedEval ();
+	void indexedEarliestEvent ();
+	void indexFollowsEdits ();
+
+private:
+	boost::shared_ptr<Evoral::ControlList> TestCtrlList() {
+		Evoral::Parameter param (Evoral::Parameter(0));
+		Evoral::ParameterDescriptor desc;
+		desc.upper = 128;
+		return boost::shared_ptr<Evoral::ControlList> (new Evoral::ControlList(param, desc));
+	}
+
+	void fill (Evoral::ControlList &);
+};
@@ -407,3 +407,49 @@ CurveTest::constrainedCubic ()
 		CPPUNIT_ASSERT_DOUBLES_EQUAL(v, g[x], 0.000008);
 	}
 }
+
+void
+CurveTest::blockEval ()
+{
+	/* get_vector renders a segment at a time when the list's index is
+	   current, and evaluates each value separately when it is not
+	   (which mark_dirty() arranges); the two should agree.
+	*/
+
+	float block[1024];
+	float single[1024];
+
+	boost::shared_ptr<Evoral::ControlList> cl = TestCtrlList();
+	cl->create_curve ();
+
+	srand (1);
+
+	double x = 0;
+	for (int i = 0; i < 100; ++i) {
+		/* a few pairs of points at the same time, as guard points make */
+		if (i % 10 != 5) {
+			x += 1 + rand () % 100;
+		}
+		cl->fast_simple_add (x, rand () / (double) RAND_MAX);
+	}
+
+	ControlList::InterpolationStyle const styles[] = { ControlList::Linear, ControlList::Curved };
+
+	for (int s = 0; s < 2; ++s) {
+		cl->set_interpolation (styles[s]);
+
+		for (double x0 = -100; x0 < x; x0 += 333.3) {
+			cl->freeze ();
+			cl->thaw ();
+			CPPUNIT_ASSERT (cl->index_current ());
+			cl->curve ().get_vector (x0, x0 + 1000, block, 1024);
+
+			cl->mark_dirty ();
+			cl->curve ().get_vector (x0, x0 + 1000, single, 1024);
+
+			for (int i = 0; i < 1024; ++i) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL (single[i], block[i], 1e-5);
+			}
+		}
+	}
+}
@@ -1,5 +1,8 @@
 #include "SMFTest.hpp"
 
+#include <algorithm>
+#include <vector>
+
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
@@ -67,3 +70,58 @@ SMFTest::takeFiveTest ()
 	                Evoral::Beats::ticks_at_rate(time, smf.ppqn()));
 	CPPUNIT_ASSERT(!seq->empty());
 }
+
+void
+SMFTest::seekToTimeTest ()
+{
+	TestSMF smf;
+	string testdata_path;
+	CPPUNIT_ASSERT (find_file (test_search_path (), "TakeFive.mid", testdata_path));
+	smf.open(testdata_path);
+	CPPUNIT_ASSERT(!smf.is_empty());
+
+	/* read the whole file once, noting the time of each event */
+
+	vector<uint64_t> times;
+	vector<int>      sizes;
+
+	uint64_t time    = 0; /* in SMF ticks */
+	uint32_t delta_t = 0;
+	uint32_t size    = 0;
+	uint8_t* buf     = NULL;
+	int ret;
+
+	smf.seek_to_start();
+	while ((ret = smf.read_event(&delta_t, &size, &buf)) >= 0) {
+		time += delta_t;
+		times.push_back (time);
+		sizes.push_back (ret);
+	}
+
+	CPPUNIT_ASSERT (!times.empty());
+
+	/* then seek to various times, and check that reading carries on
+	   from the first event at or after each one.
+	*/
+
+	for (uint64_t target = 0; target <= times.back() + 1; target += 1 + times.back() / 97) {
+
+		size_t const first = lower_bound (times.begin(), times.end(), target) - times.begin();
+
+		time = smf.seek_to_time (target);
+
+		if (first == times.size()) {
+			CPPUNIT_ASSERT_EQUAL (-1, smf.read_event(&delta_t, &size, &buf));
+			continue;
+		}
+
+		for (size_t n = first; n < times.size() && n < first + 10; ++n) {
+			ret = smf.read_event(&delta_t, &size, &buf);
+			time += delta_t;
+			CPPUNIT_ASSERT_EQUAL (sizes[n], ret);
+			CPPUNIT_ASSERT_EQUAL (times[n], time);
+		}
+	}
+
+	free (buf);
+}
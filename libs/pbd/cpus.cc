@@ -22,8 +22,14 @@
 #include "libpbd-config.h"
 #endif
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
 #ifdef __linux__
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
 #elif defined(__APPLE__) || defined(__FreeBSD__)
 #include <stddef.h>
 #include <sys/types.h>
@@ -58,3 +64,94 @@ hardware_concurrency()
         return 0;
 #endif
 }
+
+std::vector<uint32_t>
+parse_cpu_list (std::string const & str, uint32_t cpu_count)
+{
+	std::vector<uint32_t> cpus;
+	std::string::size_type pos = 0;
+
+	while (pos < str.length()) {
+		std::string::size_type comma = str.find (',', pos);
+		if (comma == std::string::npos) {
+			comma = str.length();
+		}
+
+		std::string const range = str.substr (pos, comma - pos);
+		pos = comma + 1;
+
+		char* end;
+		long const first = strtol (range.c_str(), &end, 10);
+		if (end == range.c_str() || first < 0) {
+			continue;
+		}
+
+		long last = first;
+		if (*end == '-') {
+			char const * second = end + 1;
+			last = strtol (second, &end, 10);
+			if (end == second || last < first) {
+				continue;
+			}
+		}
+
+		if (first >= (long) cpu_count) {
+			continue;
+		}
+
+		/* don't expand a silly range such as 0-100000000 */
+		last = std::min (last, (long) cpu_count - 1);
+
+		for (long c = first; c <= last; ++c) {
+			cpus.push_back (c);
+		}
+	}
+
+	std::sort (cpus.begin(), cpus.end());
+	cpus.erase (std::unique (cpus.begin(), cpus.end()), cpus.end());
+
+	return cpus;
+}
+
+int
+cpu_package (uint32_t cpu)
+{
+#ifdef __linux__
+	char path[128];
+	snprintf (path, sizeof (path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+
+	FILE* f = fopen (path, "r");
+	if (!f) {
+		return -1;
+	}
+
+	int package;
+	if (fscanf (f, "%d", &package) != 1) {
+		package = -1;
+	}
+	fclose (f);
+
+	return package;
+#else
+	return -1;
+#endif
+}
+
+int
+set_thread_cpus (std::vector<uint32_t> const & cpus)
+{
+#if defined(__linux__) && defined(CPU_SET)
+	cpu_set_t set;
+	CPU_ZERO (&set);
+
+	for (std::vector<uint32_t>::const_iterator i = cpus.begin(); i != cpus.end(); ++i) {
+		if (*i < CPU_SETSIZE) {
+			CPU_SET (*i, &set);
+		}
+	}
+
+	return pthread_setaffinity_np (pthread_self (), sizeof (set), &set) == 0 ? 0 : -1;
+#else
+	return -1;
+#endif
+}
@@ -33,6 +33,73 @@
 using namespace PBD;
 using namespace std;
 
+#if ( (defined __x86_64__) || (defined __i386__) ) // ARCH_X86
+
+static void
+cpuid (uint32_t leaf, uint32_t subleaf, uint32_t& eax, uint32_t& ebx, uint32_t& ecx)
+{
+	uint32_t edx;
+
+	eax = leaf;
+	ecx = subleaf;
+
+#ifndef _LP64
+	/* ebx may be the PIC register, so keep it out of gcc's hands */
+	asm volatile (
+		"movl %%ebx, %%esi\n"
+		"cpuid\n"
+		"xchgl %%ebx, %%esi\n"
+		: "+a" (eax), "=S" (ebx), "+c" (ecx), "=d" (edx)
+		);
+#else
+	asm volatile (
+		"cpuid\n"
+		: "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx)
+		);
+#endif
+}
+
+/** @return true if the CPU has AVX2 and FMA and the OS saves the
+ *  YMM registers on a context switch.
+ */
+static bool
+avx2_and_fma_usable ()
+{
+	uint32_t eax, ebx, ecx;
+
+	cpuid (0, 0, eax, ebx, ecx);
+
+	if (eax < 7) {
+		return false;
+	}
+
+	cpuid (1, 0, eax, ebx, ecx);
+
+	/* FMA, OSXSAVE and AVX */
+	if ((ecx & ((1<<12)|(1<<27)|(1<<28))) != ((1<<12)|(1<<27)|(1<<28))) {
+		return false;
+	}
+
+	uint32_t xcr0_lo, xcr0_hi;
+
+	/* xgetbv, spelled out for assemblers which don't know it */
+	asm volatile (
+		".byte 0x0f, 0x01, 0xd0\n"
+		: "=a" (xcr0_lo), "=d" (xcr0_hi)
+		: "c" (0)
+		);
+
+	if ((xcr0_lo & 0x6) != 0x6) {
+		return false;
+	}
+
+	cpuid (7, 0, eax, ebx, ecx);
+
+	return ebx & (1<<5);
+}
+
+#endif
+
 FPU::FPU ()
 {
 	unsigned long cpuflags = 0;
@@ -84,6 +151,14 @@ FPU::FPU ()
 		_flags = Flags (_flags | HasSSE2);
 	}
 
+	/* HasAVX is left unset here: the AVX routines are only built for
+	   Windows, and AVX2 covers the same ground where it is available.
+	*/
+
+	if (avx2_and_fma_usable ()) {
+		_flags = Flags (_flags | HasAVX2 | HasFMA);
+	}
+
 	if (cpuflags & (1 << 24)) {
 		
 		char** fxbuf = 0;
@@ -57,6 +57,15 @@ FPU::FPU ()
         // there are the cases when 0x3 could be the result
         if ( (xcrFeatureMask & 0x6) == 0x6) {
 			_flags = Flags (_flags | (HasAVX) );
+
+			// AVX2 is reported by leaf 7, FMA alongside AVX by leaf 1
+			__cpuid (cpuInfo, 0);
+			if (cpuInfo[0] >= 7) {
+				__cpuidex (cpuInfo, 7, 0);
+				if ((cpuInfo[1] & (1<<5)) && (cpuflags_ECX & (1<<12))) {
+					_flags = Flags (_flags | HasAVX2 | HasFMA);
+				}
+			}
 		}
 	}
 
@@ -22,9 +22,29 @@
 #define __libpbd_cpus_h__
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 #include "pbd/libpbd_visibility.h"
 
 LIBPBD_API extern uint32_t hardware_concurrency ();
 
+/** Parse a list of CPUs in the form used by taskset(1) and cpusets,
+ *  e.g. "0-3,8,10-11", into CPU numbers in ascending order without
+ *  repeats.  Anything which does not parse is ignored, as are CPUs
+ *  numbered @a cpu_count or above.
+ */
+LIBPBD_API extern std::vector<uint32_t> parse_cpu_list (std::string const &, uint32_t cpu_count = 1024);
+
+/** @return the physical package (socket) that a CPU is in, or -1 if
+ *  we cannot tell.
+ */
+LIBPBD_API extern int cpu_package (uint32_t cpu);
+
+/** Restrict the calling thread to the given CPUs.
+ *  @return 0 on success, or -1 on failure or if the platform does not
+ *  support it.
+ */
+LIBPBD_API extern int set_thread_cpus (std::vector<uint32_t> const &);
+
 #endif /* __libpbd_cpus_h__ */
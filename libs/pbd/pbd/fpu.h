@@ -31,7 +31,9 @@ class LIBPBD_API FPU {
 		HasDenormalsAreZero = 0x2,
 		HasSSE = 0x4,
 		HasSSE2 = 0x8,
-		HasAVX = 0x10
+		HasAVX = 0x10,
+		HasAVX2 = 0x20,
+		HasFMA = 0x40
 	};
 
   public:
@@ -43,6 +45,8 @@ class LIBPBD_API FPU {
 	bool has_sse () const { return _flags & HasSSE; }
 	bool has_sse2 () const { return _flags & HasSSE2; }
 	bool has_avx () const { return _flags & HasAVX; }
+	bool has_avx2 () const { return _flags & HasAVX2; }
+	bool has_fma () const { return _flags & HasFMA; }
 	
   private:
 	Flags _flags;
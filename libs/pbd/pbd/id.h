@@ -54,6 +54,11 @@ class LIBPBD_API ID {
 		return _id < other._id;
 	}
 
+	/** For boost::hash, and so unordered containers */
+	friend std::size_t hash_value (const ID& id) {
+		return id._id;
+	}
+
 	void print (char* buf, uint32_t bufsize) const;
         std::string to_s() const;
 	
@@ -0,0 +1,131 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_mpsc_queue_h__
+#define __libpbd_mpsc_queue_h__
+
+#include <glib.h>
+
+#include "pbd/libpbd_visibility.h"
+
+namespace PBD {
+
+/** A bounded, lock-free queue which any number of threads may write to
+ *  and one thread reads from.
+ *
+ *  RingBuffer is only safe with a single writer.  Here each slot carries a
+ *  sequence number which says whether it is free for the writer which has
+ *  claimed it or full for the reader, and writers claim slots by
+ *  compare-and-exchange on the write position, so neither side ever waits
+ *  for the other.
+ */
+template<class T>
+class /*LIBPBD_API*/ MPSCQueue
+{
+  public:
+	MPSCQueue (guint sz) {
+		guint power_of_two;
+		for (power_of_two = 1; 1U<<power_of_two < sz; power_of_two++) {}
+		size = 1<<power_of_two;
+		size_mask = size - 1;
+		cells = new Cell[size];
+		for (guint i = 0; i < size; ++i) {
+			g_atomic_int_set (&cells[i].sequence, i);
+		}
+		g_atomic_int_set (&write_pos, 0);
+		read_pos = 0;
+	}
+
+	~MPSCQueue () {
+		delete [] cells;
+	}
+
+	/** Add an item; may be called from any thread.
+	 *  @return false if the queue is full.
+	 */
+	bool write (T const & item) {
+		Cell* cell;
+		guint pos = g_atomic_int_get (&write_pos);
+
+		for (;;) {
+			cell = &cells[pos & size_mask];
+			const gint dif = (gint) ((guint) g_atomic_int_get (&cell->sequence) - pos);
+			if (dif == 0) {
+				/* free: try to claim it */
+				if (g_atomic_int_compare_and_exchange (&write_pos, (gint) pos, (gint) (pos + 1))) {
+					break;
+				}
+				pos = g_atomic_int_get (&write_pos);
+			} else if (dif < 0) {
+				/* still holds an item from the last time around */
+				return false;
+			} else {
+				/* another writer claimed it first */
+				pos = g_atomic_int_get (&write_pos);
+			}
+		}
+
+		cell->item = item;
+		g_atomic_int_set (&cell->sequence, pos + 1);
+		return true;
+	}
+
+	/** Take the oldest item; must only be called from the reader's thread.
+	 *  @return false if there is nothing to read, or if the writer of the
+	 *  oldest item has not finished writing it yet.
+	 */
+	bool read (T& item) {
+		Cell* cell = &cells[read_pos & size_mask];
+		const gint dif = (gint) ((guint) g_atomic_int_get (&cell->sequence) - (read_pos + 1));
+
+		if (dif < 0) {
+			return false;
+		}
+
+		item = cell->item;
+		g_atomic_int_set (&cell->sequence, read_pos + size);
+		++read_pos;
+		return true;
+	}
+
+	/** @return the number of items claimed by writers and not yet read.
+	 *  Only meaningful in the reader's thread, and only a snapshot there.
+	 */
+	guint read_space () const {
+		return (guint) g_atomic_int_get (&write_pos) - read_pos;
+	}
+
+	guint bufsize () const { return size; }
+
+  private:
+	struct Cell {
+		gint sequence;
+		T    item;
+	};
+
+	Cell*         cells;
+	guint         size;
+	guint         size_mask;
+	mutable gint  write_pos;
+	guint         read_pos;
+};
+
+} /* namespace */
+
+#endif /* __libpbd_mpsc_queue_h__ */
@@ -124,17 +124,7 @@ public:
 	{
 		m_lock.lock();
 
-		// clean out any dead wood
-
-		typename std::list<boost::shared_ptr<T> >::iterator i;
-
-		for (i = m_dead_wood.begin(); i != m_dead_wood.end(); ) {
-			if ((*i).unique()) {
-				i = m_dead_wood.erase (i);
-			} else {
-				++i;
-			}
-		}
+		clean_dead_wood ();
 
 		/* store the current so that we can do compare and exchange
 		   when someone calls update(). Notice that we hold
@@ -188,12 +178,40 @@ public:
 		return ret;
 	}
 
+	/** Make @a new_value the current value, for a writer which builds
+	 *  it from scratch and so has no need of write_copy()'s copy.
+	 */
+	void replace (boost::shared_ptr<T> new_value)
+	{
+		m_lock.lock();
+
+		clean_dead_wood ();
+
+		current_write_old = RCUManager<T>::x.m_rcu_value;
+
+		/* releases the lock */
+		update (new_value);
+	}
+
 	void flush () {
 		Glib::Threads::Mutex::Lock lm (m_lock);
 		m_dead_wood.clear ();
 	}
 
 private:
+	void clean_dead_wood ()
+	{
+		typename std::list<boost::shared_ptr<T> >::iterator i;
+
+		for (i = m_dead_wood.begin(); i != m_dead_wood.end(); ) {
+			if ((*i).unique()) {
+				i = m_dead_wood.erase (i);
+			} else {
+				++i;
+			}
+		}
+	}
+
 	Glib::Threads::Mutex                      m_lock;
 	boost::shared_ptr<T>*            current_write_old;
 	std::list<boost::shared_ptr<T> > m_dead_wood;
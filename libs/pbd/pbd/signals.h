@@ -22,6 +22,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #ifdef nil
 #undef nil
@@ -98,6 +99,149 @@ private:
 	SignalBase* _signal;
 };
 
+/** The slots connected to a signal, kept so that emission can walk them
+ *  without taking a lock or allocating memory.
+ *
+ *  Connecting or disconnecting copies the list, changes the copy and then
+ *  publishes it; the caller must hold the signal's mutex.  Emitters count
+ *  themselves in before they look at the list and out when they are done,
+ *  and a list which has been replaced is only freed by a later connect or
+ *  disconnect which finds nobody emitting.  So no emitter ever has its
+ *  list freed under it, and an emitter (which may be a realtime thread)
+ *  never frees anything or takes a lock; the price is that a disconnected
+ *  slot, with whatever its function holds on to, may live on until the
+ *  signal's connections next change.  Each slot also has a flag which
+ *  is cleared on disconnection, so that a slot which is disconnected
+ *  during an emission (by an earlier slot, perhaps) is not then called.
+ */
+template<typename F>
+class /*LIBPBD_API*/ SlotList : public boost::noncopyable
+{
+public:
+	class Slot {
+	public:
+		Slot (boost::shared_ptr<Connection> c, F const & f)
+			: connection (c)
+			, function (f)
+		{
+			g_atomic_int_set (&_connected, 1);
+		}
+
+		bool connected () const { return g_atomic_int_get (&_connected); }
+		void disconnect () { g_atomic_int_set (&_connected, 0); }
+
+		boost::shared_ptr<Connection> const connection;
+		F const function;
+
+	private:
+		mutable gint _connected;
+	};
+
+	typedef std::vector<boost::shared_ptr<Slot> > List;
+	typedef boost::shared_ptr<Slot> const * const_iterator;
+
+	/** The slots as they were when the Emission was created */
+	class Emission {
+	public:
+		Emission (SlotList& s)
+			: _slots (s)
+		{
+			g_atomic_int_inc (&s._emitting);
+			_list = (List const *) g_atomic_pointer_get (&s._list);
+		}
+
+		~Emission () {
+			g_atomic_int_add (&_slots._emitting, -1);
+		}
+
+		const_iterator begin () const { return (_list && !_list->empty ()) ? &(*_list)[0] : 0; }
+		const_iterator end () const { return begin () + (_list ? _list->size () : 0); }
+
+	private:
+		SlotList&    _slots;
+		List const * _list;
+	};
+
+	SlotList ()
+		: _list (0)
+	{
+		g_atomic_int_set (&_emitting, 0);
+	}
+
+	~SlotList () {
+		delete _list;
+		for (typename std::vector<List*>::iterator i = _retired.begin(); i != _retired.end(); ++i) {
+			delete *i;
+		}
+	}
+
+	/* The rest must be called with the signal's mutex held */
+
+	bool empty () const { return !_list || _list->empty (); }
+
+	void add (boost::shared_ptr<Connection> c, F const & f) {
+		List* l = _list ? new List (*_list) : new List;
+		l->push_back (boost::shared_ptr<Slot> (new Slot (c, f)));
+		replace (l);
+	}
+
+	void remove (boost::shared_ptr<Connection> c) {
+		if (!_list) {
+			return;
+		}
+
+		List* l = new List;
+		l->reserve (_list->size ());
+
+		for (typename List::const_iterator i = _list->begin(); i != _list->end(); ++i) {
+			if ((*i)->connection == c) {
+				(*i)->disconnect ();
+			} else {
+				l->push_back (*i);
+			}
+		}
+
+		replace (l);
+	}
+
+	/** Tell our connections that the signal is going away */
+	void going_away () {
+		if (_list) {
+			for (typename List::const_iterator i = _list->begin(); i != _list->end(); ++i) {
+				(*i)->connection->signal_going_away ();
+			}
+		}
+	}
+
+private:
+	void replace (List* l) {
+		if (_list) {
+			_retired.push_back (_list);
+		}
+
+		g_atomic_pointer_set (&_list, l);
+
+		free_retired ();
+	}
+
+	void free_retired () {
+		/* An emitter counts itself in before it looks at _list, so if
+		   there are no emitters now, any which start later will see
+		   the current list and we can free the old ones.
+		*/
+		if (g_atomic_int_get (&_emitting) == 0) {
+			for (typename std::vector<List*>::iterator i = _retired.begin(); i != _retired.end(); ++i) {
+				delete *i;
+			}
+			_retired.clear ();
+		}
+	}
+
+	List*                _list;
+	std::vector<List*>   _retired; ///< protected by the signal's mutex
+	mutable gint         _emitting;
+};
+
 template<typename R>
 class /*LIBPBD_API*/ OptionalLastValue
 {
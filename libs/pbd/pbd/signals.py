@@ -102,7 +102,7 @@ def signal(f, n, v):
 
     print("""
 	/** The slots that this signal will call on emission */
-	typedef std::map<boost::shared_ptr<Connection>, slot_function_type> Slots;
+	typedef SlotList<slot_function_type> Slots;
 	Slots _slots;
 """, file=f)
 
@@ -112,10 +112,7 @@ def signal(f, n, v):
 
     print("\t\tGlib::Threads::Mutex::Lock lm (_mutex);", file=f)
     print("\t\t/* Tell our connection objects that we are going away, so they don't try to call us */", file=f)
-    print("\t\tfor (%sSlots::const_iterator i = _slots.begin(); i != _slots.end(); ++i) {" % typename, file=f)
-
-    print("\t\t\ti->first->signal_going_away ();", file=f)
-    print("\t\t}", file=f)
+    print("\t\t_slots.going_away ();", file=f)
     print("\t}", file=f)
     print("", file=f)
 
@@ -230,34 +227,24 @@ def signal(f, n, v):
     else:
         print("\ttypename C::result_type operator() (%s)" % comma_separated(Anan), file=f)
     print("\t{", file=f)
-    print("\t\t/* First, take a copy of our list of slots as it is now */", file=f)
+    print("\t\t/* Walk our list of slots as it is now, without locking or copying it */", file=f)
     print("", file=f)
-    print("\t\tSlots s;", file=f)
-    print("\t\t{", file=f)
-    print("\t\t\tGlib::Threads::Mutex::Lock lm (_mutex);", file=f)
-    print("\t\t\ts = _slots;", file=f)
-    print("\t\t}", file=f)
+    print("\t\t%sSlots::Emission e (_slots);" % typename, file=f)
     print("", file=f)
     if not v:
         print("\t\tstd::list<R> r;", file=f)
-    print("\t\tfor (%sSlots::const_iterator i = s.begin(); i != s.end(); ++i) {" % typename, file=f)
+    print("\t\tfor (%sSlots::const_iterator i = e.begin(); i != e.end(); ++i) {" % typename, file=f)
     print("""
 			/* We may have just called a slot, and this may have resulted in
-			   disconnection of other slots from us.  The list copy means that
-			   this won't cause any problems with invalidated iterators, but we
-			   must check to see if the slot we are about to call is still on the list.
+			   disconnection of other slots from us.  Our list is not changed
+			   by that, but we must check that the slot we are about to call
+			   is still connected.
 			*/
-			bool still_there = false;
-			{
-				Glib::Threads::Mutex::Lock lm (_mutex);
-				still_there = _slots.find (i->first) != _slots.end ();
-			}
-
-			if (still_there) {""", file=f)
+			if ((*i)->connected ()) {""", file=f)
     if v:
-        print("\t\t\t\t(i->second)(%s);" % comma_separated(an), file=f)
+        print("\t\t\t\t((*i)->function)(%s);" % comma_separated(an), file=f)
     else:
-        print("\t\t\t\tr.push_back ((i->second)(%s));" % comma_separated(an), file=f)
+        print("\t\t\t\tr.push_back (((*i)->function)(%s));" % comma_separated(an), file=f)
     print("\t\t\t}", file=f)
     print("\t\t}", file=f)
     print("", file=f)
@@ -293,7 +280,7 @@ def signal(f, n, v):
 #endif
 		boost::shared_ptr<Connection> c (new Connection (this));
 		Glib::Threads::Mutex::Lock lm (_mutex);
-		_slots[c] = f;
+		_slots.add (c, f);
 		return c;
 	}""", file=f)
 
@@ -301,7 +288,7 @@ def signal(f, n, v):
 	void disconnect (boost::shared_ptr<Connection> c)
 	{
 		Glib::Threads::Mutex::Lock lm (_mutex);
-		_slots.erase (c);
+		_slots.remove (c);
 	}
 };    
 """, file=f)
@@ -58,7 +58,10 @@ class LIBPBD_API Stateful {
 	void add_property (PropertyBase& s);
 
 	/* Extra XML node: so that 3rd parties can attach state to the XMLNode
-	   representing the state of this object.
+	   representing the state of this object.  Changes made through the
+	   node returned by extra_xml() do not bump the state generation;
+	   use add_extra_xml() to replace a node in an object whose state
+	   may be cached.
 	 */
 
 	void add_extra_xml (XMLNode&);
@@ -93,6 +96,17 @@ class LIBPBD_API Stateful {
 	virtual void resume_property_changes ();
 
         bool property_changes_suspended() const { return g_atomic_int_get (const_cast<gint*>(&_stateful_frozen)) > 0; }
+
+	/** @return a number which changes whenever the state of this object
+	 *  may have changed, so that state kept from an earlier get_state()
+	 *  can be reused while it stays the same.
+	 */
+	uint32_t state_generation () const { return g_atomic_int_get (const_cast<gint*>(&_state_generation)); }
+
+	/** @return true if there is extra XML, which may be changed through
+	 *  extra_xml() without the state generation changing.
+	 */
+	bool has_extra_xml () const { return _extra_xml != 0; }
         
   protected:
 
@@ -122,9 +136,15 @@ class LIBPBD_API Stateful {
         */
         virtual void mid_thaw (const PropertyChange&) { }
 
+	/** derived classes must call this for any change to their state which
+	    is not made through send_change().
+	*/
+	void bump_state_generation () { g_atomic_int_inc (&_state_generation); }
+
   private:
 	PBD::ID  _id;
         gint     _stateful_frozen;
+        gint     _state_generation;
 };
 
 } // namespace PBD
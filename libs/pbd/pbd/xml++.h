@@ -110,6 +110,29 @@ public:
 
 	const XMLNodeList& children(const std::string& str = std::string()) const;
 	XMLNode* child(const char*) const;
+
+	/** Walks the children of a node which have a given name, without
+	 *  building a list of them as children(name) does:
+	 *
+	 *    for (XMLNode::NamedChildIterator i (node, "Port"); !i.done(); ++i) { ... }
+	 */
+	class LIBPBD_API NamedChildIterator {
+	public:
+		NamedChildIterator (const XMLNode& parent, const char* name);
+
+		bool done () const { return _i == _end; }
+		XMLNode* operator* () const { return *_i; }
+		XMLNode* operator-> () const { return *_i; }
+		NamedChildIterator& operator++ ();
+
+	private:
+		XMLNodeConstIterator _i;
+		XMLNodeConstIterator _end;
+		const char*          _name;
+
+		void skip ();
+	};
+
 	XMLNode* add_child(const char *);
 	XMLNode* add_child_copy(const XMLNode&);
 	void     add_child_nocopy(XMLNode&);
@@ -144,7 +167,6 @@ private:
 	std::string         _content;
 	XMLNodeList         _children;
 	XMLPropertyList     _proplist;
-	XMLPropertyMap      _propmap;
 	mutable XMLNodeList _selected_children;
 
 	void clear_lists ();
@@ -153,15 +175,19 @@ private:
 class LIBPBD_API XMLProperty {
 public:
 	XMLProperty(const std::string& n, const std::string& v = std::string());
+	XMLProperty(const char* n, const std::string& v = std::string());
 	~XMLProperty();
 
-	const std::string& name() const { return _name; }
+	const std::string& name() const { return *_name; }
 	const std::string& value() const { return _value; }
 	const std::string& set_value(const std::string& v) { return _value = v; }
 
 private:
-	std::string _name;
-	std::string _value;
+	/* property names come from a small vocabulary, so all properties
+	   with the same name share one copy of it.
+	*/
+	const std::string* _name;
+	std::string        _value;
 };
 
 class LIBPBD_API XMLException: public std::exception {
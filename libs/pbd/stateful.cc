@@ -47,6 +47,7 @@ int Stateful::loading_state_version = 0;
 Stateful::Stateful ()
 	: _properties (new OwnedPropertyList)
 	, _stateful_frozen (0)
+	, _state_generation (0)
 {
 	_extra_xml = 0;
 	_instant_xml = 0;
@@ -71,6 +72,8 @@ Stateful::add_extra_xml (XMLNode& node)
 
 	_extra_xml->remove_nodes (node.name());
 	_extra_xml->add_child_nocopy (node);
+
+	bump_state_generation ();
 }
 
 XMLNode *
@@ -104,6 +107,7 @@ Stateful::save_extra_xml (const XMLNode& node)
 	if (xtra) {
 		delete _extra_xml;
 		_extra_xml = new XMLNode (*xtra);
+		bump_state_generation ();
 	}
 }
 
@@ -281,6 +285,8 @@ Stateful::send_change (const PropertyChange& what_changed)
 		return;
 	}
 
+	bump_state_generation ();
+
 	{
 		Glib::Threads::Mutex::Lock lm (_lock);
 		if (property_changes_suspended ()) {
@@ -0,0 +1,35 @@
+#include "cpus_test.h"
+#include "pbd/cpus.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (CpusTest);
+
+using namespace std;
+
+void
+CpusTest::testParseCpuList ()
+{
+	CPPUNIT_ASSERT (parse_cpu_list ("").empty ());
+
+	vector<uint32_t> cpus = parse_cpu_list ("3");
+	CPPUNIT_ASSERT_EQUAL (size_t (1), cpus.size ());
+	CPPUNIT_ASSERT_EQUAL (uint32_t (3), cpus[0]);
+
+	/* ranges and single CPUs, out of order and overlapping */
+	cpus = parse_cpu_list ("8,0-3,2,10-11");
+	uint32_t const expected[] = { 0, 1, 2, 3, 8, 10, 11 };
+	CPPUNIT_ASSERT_EQUAL (sizeof (expected) / sizeof (expected[0]), cpus.size ());
+	for (size_t i = 0; i < cpus.size (); ++i) {
+		CPPUNIT_ASSERT_EQUAL (expected[i], cpus[i]);
+	}
+
+	/* rubbish and backwards ranges are ignored */
+	cpus = parse_cpu_list ("x,5-4,7-,6");
+	CPPUNIT_ASSERT_EQUAL (size_t (1), cpus.size ());
+	CPPUNIT_ASSERT_EQUAL (uint32_t (6), cpus[0]);
+
+	/* CPUs which do not exist are dropped */
+	cpus = parse_cpu_list ("2,3-100000000,100000001", 4);
+	CPPUNIT_ASSERT_EQUAL (size_t (2), cpus.size ());
+	CPPUNIT_ASSERT_EQUAL (uint32_t (2), cpus[0]);
+	CPPUNIT_ASSERT_EQUAL (uint32_t (3), cpus[1]);
+}
@@ -0,0 +1,13 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class CpusTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (CpusTest);
+	CPPUNIT_TEST (testParseCpuList);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testParseCpuList ();
+
+};
@@ -0,0 +1,114 @@
+#include <pthread.h>
+#include <vector>
+
+#include "mpsc_queue_test.h"
+#include "pbd/mpsc_queue.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MPSCQueueTest);
+
+using namespace std;
+using namespace PBD;
+
+void
+MPSCQueueTest::testBasic ()
+{
+	MPSCQueue<int> q (5);
+
+	/* rounded up to a power of two */
+	CPPUNIT_ASSERT_EQUAL (8U, q.bufsize ());
+
+	int n;
+	CPPUNIT_ASSERT (!q.read (n));
+
+	for (int i = 0; i < 8; ++i) {
+		CPPUNIT_ASSERT (q.write (i));
+	}
+
+	CPPUNIT_ASSERT (!q.write (8));
+	CPPUNIT_ASSERT_EQUAL (8U, q.read_space ());
+
+	for (int i = 0; i < 8; ++i) {
+		CPPUNIT_ASSERT (q.read (n));
+		CPPUNIT_ASSERT_EQUAL (i, n);
+	}
+
+	CPPUNIT_ASSERT (!q.read (n));
+	CPPUNIT_ASSERT_EQUAL (0U, q.read_space ());
+}
+
+void
+MPSCQueueTest::testWrap ()
+{
+	MPSCQueue<int> q (4);
+
+	int n;
+	for (int i = 0; i < 100; ++i) {
+		CPPUNIT_ASSERT (q.write (i));
+		CPPUNIT_ASSERT (q.write (-i));
+		CPPUNIT_ASSERT (q.read (n));
+		CPPUNIT_ASSERT_EQUAL (i, n);
+		CPPUNIT_ASSERT (q.read (n));
+		CPPUNIT_ASSERT_EQUAL (-i, n);
+	}
+}
+
+static const int writers = 4;
+static const int items_per_writer = 10000;
+
+struct Writer {
+	MPSCQueue<int>* queue;
+	int             id;
+};
+
+static void*
+write_items (void* arg)
+{
+	Writer* w = static_cast<Writer*> (arg);
+
+	for (int i = 0; i < items_per_writer; ) {
+		if (w->queue->write (w->id * items_per_writer + i)) {
+			++i;
+		}
+	}
+
+	return 0;
+}
+
+/** Several threads write at once; every item must arrive exactly once,
+ *  and each writer's items in the order it wrote them.
+ */
+void
+MPSCQueueTest::testWriters ()
+{
+	MPSCQueue<int> q (1024);
+
+	Writer w[writers];
+	pthread_t threads[writers];
+
+	for (int i = 0; i < writers; ++i) {
+		w[i].queue = &q;
+		w[i].id = i;
+		CPPUNIT_ASSERT_EQUAL (0, pthread_create (&threads[i], 0, write_items, &w[i]));
+	}
+
+	vector<int> next (writers, 0);
+	int received = 0;
+
+	while (received < writers * items_per_writer) {
+		int n;
+		if (q.read (n)) {
+			const int id = n / items_per_writer;
+			CPPUNIT_ASSERT (id >= 0 && id < writers);
+			CPPUNIT_ASSERT_EQUAL (next[id], n % items_per_writer);
+			++next[id];
+			++received;
+		}
+	}
+
+	for (int i = 0; i < writers; ++i) {
+		pthread_join (threads[i], 0);
+	}
+
+	int n;
+	CPPUNIT_ASSERT (!q.read (n));
+}
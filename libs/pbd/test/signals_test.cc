@@ -89,3 +89,33 @@ SignalsTest::testScopedConnectionList ()
 	
 	CPPUNIT_ASSERT_EQUAL (1, N);
 }
+
+static PBD::ScopedConnection* to_disconnect = 0;
+
+void
+disconnector ()
+{
+	to_disconnect->disconnect ();
+}
+
+void
+SignalsTest::testDisconnectDuringEmission ()
+{
+	Emitter* e = new Emitter;
+	PBD::ScopedConnection c;
+	PBD::ScopedConnection d;
+
+	/* the first slot disconnects the second, which must then not be called */
+	to_disconnect = &d;
+	e->Fred.connect_same_thread (c, boost::bind (&disconnector));
+	e->Fred.connect_same_thread (d, boost::bind (&receiver));
+
+	N = 0;
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (0, N);
+
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (0, N);
+
+	delete e;
+}
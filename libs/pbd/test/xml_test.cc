@@ -0,0 +1,67 @@
+#include <cstdlib>
+
+#include "xml_test.h"
+#include "pbd/xml++.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (XMLTest);
+
+using namespace std;
+
+void
+XMLTest::testProperties ()
+{
+	XMLNode node ("Region");
+
+	node.add_property ("name", "foo");
+	node.add_property ("start_frame", "0");
+
+	CPPUNIT_ASSERT (node.property ("name"));
+	CPPUNIT_ASSERT_EQUAL (string ("foo"), node.property ("name")->value ());
+	CPPUNIT_ASSERT_EQUAL (string ("foo"), node.property (string ("name"))->value ());
+	CPPUNIT_ASSERT (node.property ("length") == 0);
+
+	/* old-style names are normalized */
+	CPPUNIT_ASSERT (node.property ("start-frame"));
+	CPPUNIT_ASSERT (node.property ("start_frame") == 0);
+
+	/* adding an existing property replaces its value */
+	node.add_property ("name", "bar");
+	CPPUNIT_ASSERT_EQUAL (size_t (2), node.properties().size ());
+	CPPUNIT_ASSERT_EQUAL (string ("bar"), node.property ("name")->value ());
+
+	/* names are shared between nodes */
+	XMLNode other ("Region");
+	other.add_property ("name", "baz");
+	CPPUNIT_ASSERT (&other.property ("name")->name () == &node.property ("name")->name ());
+
+	XMLNode copy (node);
+	CPPUNIT_ASSERT_EQUAL (string ("bar"), copy.property ("name")->value ());
+	CPPUNIT_ASSERT (copy.property ("start-frame"));
+
+	node.remove_property ("name");
+	CPPUNIT_ASSERT (node.property ("name") == 0);
+	CPPUNIT_ASSERT_EQUAL (size_t (1), node.properties().size ());
+	CPPUNIT_ASSERT (copy.property ("name"));
+}
+
+void
+XMLTest::testNamedChildren ()
+{
+	XMLNode node ("Processor");
+
+	node.add_child ("Port")->add_property ("id", "0");
+	node.add_child ("Controllable");
+	node.add_child ("Port")->add_property ("id", "1");
+	node.add_child ("Port")->add_property ("id", "2");
+
+	int n = 0;
+	for (XMLNode::NamedChildIterator i (node, "Port"); !i.done (); ++i, ++n) {
+		CPPUNIT_ASSERT_EQUAL (string ("Port"), (*i)->name ());
+		CPPUNIT_ASSERT_EQUAL (n, atoi (i->property ("id")->value().c_str()));
+	}
+	CPPUNIT_ASSERT_EQUAL (3, n);
+	CPPUNIT_ASSERT_EQUAL (size_t (3), node.children ("Port").size ());
+
+	XMLNode::NamedChildIterator none (node, "Automation");
+	CPPUNIT_ASSERT (none.done ());
+}
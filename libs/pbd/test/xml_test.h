@@ -0,0 +1,15 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class XMLTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (XMLTest);
+	CPPUNIT_TEST (testProperties);
+	CPPUNIT_TEST (testNamedChildren);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testProperties ();
+	void testNamedChildren ();
+
+};
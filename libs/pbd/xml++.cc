@@ -6,6 +6,8 @@
  */
 
 #include <iostream>
+#include <cstring>
+#include <glibmm/threads.h>
 #include "pbd/xml++.h"
 #include <libxml/debugXML.h>
 #include <libxml/xpath.h>
@@ -15,6 +17,21 @@ xmlChar* xml_version = xmlCharStrdup("1.0");
 
 using namespace std;
 
+struct CStringLess {
+	bool operator() (const char* a, const char* b) const { return strcmp (a, b) < 0; }
+};
+
+/* maps each property name seen so far, and its normalized form, to a
+   shared copy of the normalized name; entries are never removed.  This
+   costs a lock and a map lookup per property created, in exchange for
+   not allocating a name for each one.
+*/
+typedef map<const char*, const string*, CStringLess> PropertyNames;
+static PropertyNames property_names;
+static Glib::Threads::Mutex property_names_lock;
+
+static const string* intern_property_name (const char*);
+
 static XMLNode*           readnode(xmlNodePtr);
 static void               writenode(xmlDocPtr, XMLNode*, xmlNodePtr, int);
 static XMLSharedNodeList* find_impl(xmlXPathContext* ctxt, const string& xpath);
@@ -247,7 +264,6 @@ XMLNode::clear_lists ()
 	XMLPropertyIterator curprop;
 
 	_selected_children.clear ();
-	_propmap.clear ();
 
 	for (curchild = _children.begin(); curchild != _children.end();	++curchild) {
 		delete *curchild;
@@ -267,22 +283,20 @@ XMLNode::operator= (const XMLNode& from)
 {
 	if (&from != this) {
 
-		XMLPropertyList props;
-		XMLPropertyIterator curprop;
-		XMLNodeList nodes;
-		XMLNodeIterator curnode;
+		XMLPropertyConstIterator curprop;
+		XMLNodeConstIterator curnode;
 		
 		clear_lists ();
 
 		_name = from.name();
 		set_content(from.content());
 		
-		props = from.properties();
+		const XMLPropertyList& props = from.properties();
 		for (curprop = props.begin(); curprop != props.end(); ++curprop) {
-			add_property((*curprop)->name().c_str(), (*curprop)->value());
+			_proplist.push_back (new XMLProperty (**curprop));
 		}
 		
-		nodes = from.children();
+		const XMLNodeList& nodes = from.children();
 		for (curnode = nodes.begin(); curnode != nodes.end(); ++curnode) {
 			add_child_copy(**curnode);
 		}
@@ -347,6 +361,30 @@ XMLNode::children(const string& n) const
 	return _selected_children;
 }
 
+XMLNode::NamedChildIterator::NamedChildIterator (const XMLNode& parent, const char* name)
+	: _i (parent._children.begin())
+	, _end (parent._children.end())
+	, _name (name)
+{
+	skip ();
+}
+
+XMLNode::NamedChildIterator&
+XMLNode::NamedChildIterator::operator++ ()
+{
+	++_i;
+	skip ();
+	return *this;
+}
+
+void
+XMLNode::NamedChildIterator::skip ()
+{
+	while (_i != _end && (*_i)->name() != _name) {
+		++_i;
+	}
+}
+
 XMLNode*
 XMLNode::add_child(const char* n)
 {
@@ -395,7 +433,7 @@ XMLTree::find(const string xpath, XMLNode* node) const
 std::string
 XMLNode::attribute_value()
 {
-	XMLNodeList children = this->children();
+	const XMLNodeList& children = this->children();
 	assert(!_is_content);
 	assert(children.size() == 1);
 	XMLNode* child = *(children.begin());
@@ -409,14 +447,18 @@ XMLNode::add_content(const string& c)
 	return add_child_copy(XMLNode (string(), c));
 }
 
+/* Nodes have only a handful of properties, so a scan of the list finds
+   one faster than a map lookup could, and without having to make a
+   string of the name first.
+*/
+
 XMLProperty*
 XMLNode::property(const char* n)
 {
-	string ns(n);
-	map<string,XMLProperty*>::iterator iter;
-
-	if ((iter = _propmap.find(ns)) != _propmap.end()) {
-		return iter->second;
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if ((*i)->name() == n) {
+			return *i;
+		}
 	}
 
 	return 0;
@@ -425,10 +467,10 @@ XMLNode::property(const char* n)
 XMLProperty*
 XMLNode::property(const string& ns)
 {
-	map<string,XMLProperty*>::iterator iter;
-
-	if ((iter = _propmap.find(ns)) != _propmap.end()) {
-		return iter->second;
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if ((*i)->name() == ns) {
+			return *i;
+		}
 	}
 
 	return 0;
@@ -437,21 +479,17 @@ XMLNode::property(const string& ns)
 XMLProperty*
 XMLNode::add_property(const char* n, const string& v)
 {
-	string ns(n);
-        map<string,XMLProperty*>::iterator iter;
-	
-        if ((iter = _propmap.find(ns)) != _propmap.end()) {
-                iter->second->set_value (v);
-                return iter->second;
-	}
+	const string* name = intern_property_name (n);
 
-	XMLProperty* tmp = new XMLProperty(ns, v);
-
-	if (!tmp) {
-		return 0;
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if (&(*i)->name() == name) {
+			(*i)->set_value (v);
+			return *i;
+		}
 	}
 
-	_propmap[tmp->name()] = tmp;
+	XMLProperty* tmp = new XMLProperty(n, v);
+
 	_proplist.insert(_proplist.end(), tmp);
 
 	return tmp;
@@ -475,11 +513,11 @@ XMLNode::add_property(const char* name, const long value)
 void
 XMLNode::remove_property(const string& n)
 {
-	if (_propmap.find(n) != _propmap.end()) {
-		XMLProperty* p = _propmap[n];
+	XMLProperty* p = property (n);
+
+	if (p) {
 		_proplist.remove (p);
 		delete p;
-		_propmap.erase(n);
 	}
 }
 
@@ -548,21 +586,64 @@ XMLNode::remove_nodes_and_delete(const string& propname, const string& val)
 }
 
 XMLProperty::XMLProperty(const string& n, const string& v)
-	: _name(n)
+	: _name(intern_property_name (n.c_str()))
+	, _value(v)
+{
+}
+
+XMLProperty::XMLProperty(const char* n, const string& v)
+	: _name(intern_property_name (n))
 	, _value(v)
 {
-	// Normalize property name (replace '_' with '-' as old session are inconsistent)
-	for (size_t i = 0; i < _name.length(); ++i) {
-		if (_name[i] == '_') {
-			_name[i] = '-';
-		}
-	}
 }
 
 XMLProperty::~XMLProperty()
 {
 }
 
+static const string*
+intern_property_name (const char* n)
+{
+	Glib::Threads::Mutex::Lock lm (property_names_lock);
+
+	PropertyNames::const_iterator i = property_names.find (n);
+
+	if (i != property_names.end()) {
+		return i->second;
+	}
+
+	string normalized (n);
+
+	// Normalize property name (replace '_' with '-' as old session are inconsistent)
+	for (string::size_type c = 0; c < normalized.length(); ++c) {
+		if (normalized[c] == '_') {
+			normalized[c] = '-';
+		}
+	}
+
+	/* names which normalize to the same thing must share a copy, as
+	   XMLNode::add_property() compares them by address.  The keys must
+	   outlive the caller's string.
+	*/
+
+	const string* name;
+
+	i = property_names.find (normalized.c_str());
+
+	if (i != property_names.end()) {
+		name = i->second;
+	} else {
+		name = new string (normalized);
+		property_names.insert (make_pair (strdup (name->c_str()), name));
+	}
+
+	if (normalized != n) {
+		property_names.insert (make_pair (strdup (n), name));
+	}
+
+	return name;
+}
+
 static XMLNode*
 readnode(xmlNodePtr node)
 {
@@ -601,10 +682,8 @@ readnode(xmlNodePtr node)
 static void
 writenode(xmlDocPtr doc, XMLNode* n, xmlNodePtr p, int root = 0)
 {
-	XMLPropertyList props;
-	XMLPropertyIterator curprop;
-	XMLNodeList children;
-	XMLNodeIterator curchild;
+	XMLPropertyConstIterator curprop;
+	XMLNodeConstIterator curchild;
 	xmlNodePtr node;
 
 	if (root) {
@@ -618,12 +697,12 @@ writenode(xmlDocPtr doc, XMLNode* n, xmlNodePtr p, int root = 0)
 		xmlNodeSetContentLen(node, (const xmlChar*)n->content().c_str(), n->content().length());
 	}
 
-	props = n->properties();
+	const XMLPropertyList& props = n->properties();
 	for (curprop = props.begin(); curprop != props.end(); ++curprop) {
 		xmlSetProp(node, (const xmlChar*) (*curprop)->name().c_str(), (const xmlChar*) (*curprop)->value().c_str());
 	}
 
-	children = n->children();
+	const XMLNodeList& children = n->children();
 	for (curchild = children.begin(); curchild != children.end(); ++curchild) {
 		writenode(doc, *curchild, node);
 	}
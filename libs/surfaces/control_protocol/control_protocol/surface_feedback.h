@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser
+    General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_control_protocol_surface_feedback_h__
+#define __ardour_control_protocol_surface_feedback_h__
+
+#include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <glib.h>
+#include <glibmm/main.h>
+
+#include "pbd/mpsc_queue.h"
+#include "pbd/signals.h"
+
+#include "ardour/types.h"
+
+#include "control_protocol/visibility.h"
+
+namespace PBD {
+	class Controllable;
+}
+
+namespace ARDOUR {
+
+/** Collects changes to the controls which a surface shows,
+ *  and hands them to the surface in batches at a fixed rate.
+ *
+ *  A control which changes many times between two batches (as one being
+ *  automated will) appears once in the next batch, with its latest value,
+ *  and one which changes and then changes back does not appear at all.
+ *  Controls may change in any thread, including the process thread;
+ *  marking one as changed is lock-free and does not allocate.
+ *
+ *  Everything else, including emission of Send, happens in the thread of
+ *  the main context given to attach(), or in whichever thread calls
+ *  flush() when the surface drives it itself.
+ */
+class LIBCONTROLCP_API SurfaceFeedback
+{
+  public:
+	typedef uint32_t TargetID;
+
+	struct Change {
+		TargetID target;
+		float    value;
+	};
+
+	typedef std::vector<Change> Changes;
+
+	/** @param interval Time between batches, in milliseconds; at least 1 */
+	SurfaceFeedback (uint32_t interval = 50);
+	~SurfaceFeedback ();
+
+	TargetID add_control (boost::shared_ptr<PBD::Controllable>);
+	void remove (TargetID);
+	void clear ();
+
+	/** Send batches from a timeout in @a context */
+	void attach (Glib::RefPtr<Glib::MainContext> context);
+	void detach ();
+
+	void set_interval (uint32_t);
+	uint32_t interval () const { return _interval; }
+
+	/** Send everything which has changed since the last batch */
+	void flush ();
+
+	/** Send every target in the next batch, whether it has changed or
+	 *  not; for a surface which has just connected or been reset.
+	 */
+	void refresh ();
+
+	/** Emitted with each batch, which is never empty */
+	PBD::Signal1<void, Changes const &> Send;
+
+  private:
+	struct Target {
+		Target ();
+
+		boost::shared_ptr<PBD::Controllable> control;
+
+		float last_sent;
+		bool  sent;
+		gint  dirty;
+
+		PBD::ScopedConnection connection;
+	};
+
+	typedef std::map<TargetID, boost::shared_ptr<Target> > Targets;
+
+	Targets _targets;
+	TargetID _next_id;
+	uint32_t _interval;
+
+	/* targets which have been marked dirty since the last batch */
+	PBD::MPSCQueue<TargetID> _dirty;
+	/* set if _dirty filled up, so that flush() looks at every target */
+	gint _overflow;
+
+	Changes _changes;
+
+	Glib::RefPtr<Glib::MainContext> _context;
+	sigc::connection _timeout_connection;
+
+	TargetID add (boost::shared_ptr<Target>);
+	void mark (boost::weak_ptr<Target>, TargetID);
+	void send (TargetID, Target&);
+	bool timeout ();
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_control_protocol_surface_feedback_h__ */
@@ -0,0 +1,223 @@
+/*
+    Copyright (C) 2015 Paul Davis
+
+    This program is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser
+    General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your
+    option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "pbd/controllable.h"
+
+#include "control_protocol/surface_feedback.h"
+
+using namespace ARDOUR;
+using namespace std;
+using namespace PBD;
+
+SurfaceFeedback::Target::Target ()
+	: last_sent (0)
+	, sent (false)
+{
+	g_atomic_int_set (&dirty, 0);
+}
+
+SurfaceFeedback::SurfaceFeedback (uint32_t interval)
+	: _next_id (0)
+	, _interval (max (interval, (uint32_t) 1))
+	, _dirty (1024)
+{
+	g_atomic_int_set (&_overflow, 0);
+}
+
+SurfaceFeedback::~SurfaceFeedback ()
+{
+	detach ();
+	clear ();
+}
+
+SurfaceFeedback::TargetID
+SurfaceFeedback::add_control (boost::shared_ptr<Controllable> c)
+{
+	boost::shared_ptr<Target> t (new Target);
+	t->control = c;
+
+	TargetID const id = add (t);
+
+	/* Changed may be emitted in the process thread while automation is
+	   playing, so all that happens there is a mark.
+	*/
+	c->Changed.connect_same_thread (t->connection, boost::bind (&SurfaceFeedback::mark, this, boost::weak_ptr<Target> (t), id));
+
+	return id;
+}
+
+SurfaceFeedback::TargetID
+SurfaceFeedback::add (boost::shared_ptr<Target> t)
+{
+	TargetID const id = _next_id++;
+	_targets.insert (make_pair (id, t));
+
+	/* send its current state in the next batch */
+	mark (t, id);
+
+	return id;
+}
+
+void
+SurfaceFeedback::remove (TargetID id)
+{
+	/* any mark still in _dirty is ignored by flush() */
+	_targets.erase (id);
+}
+
+void
+SurfaceFeedback::clear ()
+{
+	_targets.clear ();
+}
+
+void
+SurfaceFeedback::attach (Glib::RefPtr<Glib::MainContext> context)
+{
+	detach ();
+
+	_context = context;
+
+	Glib::RefPtr<Glib::TimeoutSource> timeout = Glib::TimeoutSource::create (_interval);
+	_timeout_connection = timeout->connect (sigc::mem_fun (*this, &SurfaceFeedback::timeout));
+	timeout->attach (_context);
+}
+
+void
+SurfaceFeedback::detach ()
+{
+	_timeout_connection.disconnect ();
+	_context.reset ();
+}
+
+void
+SurfaceFeedback::set_interval (uint32_t ms)
+{
+	/* a zero timeout would never stop firing */
+	_interval = max (ms, (uint32_t) 1);
+
+	if (_context) {
+		attach (_context);
+	}
+}
+
+bool
+SurfaceFeedback::timeout ()
+{
+	flush ();
+	return true;
+}
+
+/** Called from any thread, possibly the process thread, when a target
+ *  changes.
+ */
+void
+SurfaceFeedback::mark (boost::weak_ptr<Target> wt, TargetID id)
+{
+	boost::shared_ptr<Target> t = wt.lock ();
+
+	if (!t) {
+		return;
+	}
+
+	/* a target is only queued once between batches, however often it changes */
+
+	if (!g_atomic_int_compare_and_exchange (&t->dirty, 0, 1)) {
+		return;
+	}
+
+	if (!_dirty.write (id)) {
+		g_atomic_int_set (&_overflow, 1);
+	}
+}
+
+void
+SurfaceFeedback::flush ()
+{
+	_changes.clear ();
+
+	if (g_atomic_int_compare_and_exchange (&_overflow, 1, 0)) {
+
+		/* some marks did not fit in the queue, so look at every target;
+		   whatever is in the queue is taken out and ignored.
+		*/
+
+		TargetID id;
+		while (_dirty.read (id)) {}
+
+		for (Targets::iterator i = _targets.begin(); i != _targets.end(); ++i) {
+			if (g_atomic_int_get (&i->second->dirty)) {
+				send (i->first, *i->second);
+			}
+		}
+
+	} else {
+
+		TargetID id;
+
+		while (_dirty.read (id)) {
+			Targets::iterator i = _targets.find (id);
+			if (i != _targets.end()) {
+				send (id, *i->second);
+			}
+		}
+	}
+
+	if (!_changes.empty ()) {
+		Send (_changes); /* EMIT SIGNAL */
+	}
+}
+
+/** Add a dirty target to the batch, if it has changed since it was last sent */
+void
+SurfaceFeedback::send (TargetID id, Target& t)
+{
+	/* clear the mark before reading the value, so that a change which
+	   comes in after the read marks the target again.
+	*/
+	g_atomic_int_set (&t.dirty, 0);
+
+	float const v = t.control->get_value ();
+
+	if (t.sent && v == t.last_sent) {
+		return;
+	}
+
+	Change c;
+	c.target = id;
+	c.value = v;
+	_changes.push_back (c);
+
+	t.last_sent = v;
+	t.sent = true;
+}
+
+void
+SurfaceFeedback::refresh ()
+{
+	for (Targets::iterator i = _targets.begin(); i != _targets.end(); ++i) {
+		i->second->sent = false;
+		mark (i->second, i->first);
+	}
+}
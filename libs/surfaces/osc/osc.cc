@@ -85,6 +85,7 @@ OSC::OSC (Session& s, uint32_t port)
 	, _osc_unix_server (0)
 	, _namespace_root ("/ardour")
 	, _send_route_changes (true)
+	, _feedback_interval (50)
 {
 	_instance = this;
 
@@ -150,6 +151,16 @@ OSC::get_feedback () const
 	return _send_route_changes;
 }
 
+void
+OSC::set_feedback_interval (uint32_t ms)
+{
+	_feedback_interval = ms;
+
+	for (ClientFeedbacks::iterator x = client_feedbacks.begin(); x != client_feedbacks.end(); ++x) {
+		x->second->set_interval (ms);
+	}
+}
+
 int
 OSC::start ()
 {
@@ -307,6 +318,8 @@ OSC::stop ()
 		}
 	}
 
+	drop_unused_client_feedback ();
+
 	return 0;
 }
 
@@ -447,7 +460,7 @@ OSC::listen_to_route (boost::shared_ptr<Route> route, lo_address addr)
 		}
 	}
 
-	OSCRouteObserver* o = new OSCRouteObserver (route, addr);
+	OSCRouteObserver* o = new OSCRouteObserver (route, addr, client_feedback (addr));
 	route_observers.push_back (o);
 
 	route->DropReferences.connect (*this, MISSING_INVALIDATOR, boost::bind (&OSC::drop_route, this, boost::weak_ptr<Route> (route)), this);
@@ -478,6 +491,8 @@ OSC::drop_route (boost::weak_ptr<Route> wr)
 			++x;
 		}
 	}
+
+	drop_unused_client_feedback ();
 }
 
 void
@@ -506,6 +521,41 @@ OSC::end_listen (boost::shared_ptr<Route> r, lo_address addr)
 			++x;
 		}
 	}
+
+	drop_unused_client_feedback ();
+}
+
+/** @return the feedback for the client at @a addr, shared by all of its
+ *  route observers.
+ */
+OSCClientFeedback&
+OSC::client_feedback (lo_address addr)
+{
+	char* url = lo_address_get_url (addr);
+	string const key (url ? url : "");
+	free (url);
+
+	ClientFeedbacks::iterator i = client_feedbacks.find (key);
+
+	if (i == client_feedbacks.end()) {
+		i = client_feedbacks.insert (make_pair (key, new OSCClientFeedback (addr, _feedback_interval, _main_loop->get_context()))).first;
+	}
+
+	return *i->second;
+}
+
+/** Remove feedback for clients which are no longer listening to any routes */
+void
+OSC::drop_unused_client_feedback ()
+{
+	for (ClientFeedbacks::iterator i = client_feedbacks.begin(); i != client_feedbacks.end();) {
+		if (i->second->empty ()) {
+			delete i->second;
+			client_feedbacks.erase (i++);
+		} else {
+			++i;
+		}
+	}
 }
 
 void
@@ -1090,15 +1140,30 @@ OSC::route_plugin_parameter_print (int rid, int piid, int par)
 XMLNode&
 OSC::get_state ()
 {
-	return ControlProtocol::get_state();
+	XMLNode& node (ControlProtocol::get_state());
+	char buf[32];
+
+	snprintf (buf, sizeof (buf), "%u", _feedback_interval);
+	node.add_property (X_("feedback_interval"), buf);
+
+	return node;
 }
 
 int
 OSC::set_state (const XMLNode& node, int version)
 {
+	const XMLProperty* prop;
+
 	if (ControlProtocol::set_state (node, version)) {
 		return -1;
 	}
 
+	if ((prop = node.property (X_("feedback_interval"))) != 0) {
+		uint32_t ms;
+		if (sscanf (prop->value().c_str(), "%u", &ms) == 1) {
+			set_feedback_interval (ms);
+		}
+	}
+
 	return 0;
 }
@@ -20,6 +20,7 @@
 #ifndef ardour_osc_h
 #define ardour_osc_h
 
+#include <map>
 #include <string>
 
 #include <sys/time.h>
@@ -39,6 +40,7 @@
 
 class OSCControllable;
 class OSCRouteObserver;
+class OSCClientFeedback;
 
 namespace ARDOUR {
 class Session;
@@ -76,6 +78,10 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 
 	void set_namespace_root (std::string);
 
+	/** Set the time between bundles of route feedback, in milliseconds */
+	void set_feedback_interval (uint32_t ms);
+	uint32_t feedback_interval () const { return _feedback_interval; }
+
 	int start ();
 	int stop ();
 
@@ -98,6 +104,7 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	std::string _osc_url_file;
 	std::string _namespace_root;
 	bool _send_route_changes;
+	uint32_t _feedback_interval;
 
 	void register_callbacks ();
 
@@ -242,6 +249,9 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	void listen_to_route (boost::shared_ptr<ARDOUR::Route>, lo_address);
 	void end_listen (boost::shared_ptr<ARDOUR::Route>, lo_address);
 	void drop_route (boost::weak_ptr<ARDOUR::Route>);
+
+	OSCClientFeedback& client_feedback (lo_address);
+	void drop_unused_client_feedback ();
 	
 	void route_name_changed (const PBD::PropertyChange&, boost::weak_ptr<ARDOUR::Route> r, lo_address addr);
 	
@@ -252,6 +262,11 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	
 	RouteObservers route_observers;
 
+	/* one for each client, keyed by URL, shared by its route observers */
+	typedef std::map<std::string, OSCClientFeedback*> ClientFeedbacks;
+
+	ClientFeedbacks client_feedbacks;
+
 	static OSC* _instance;
 };
 
@@ -33,8 +33,81 @@ using namespace PBD;
 using namespace ARDOUR;
 using namespace ArdourSurface;
 
-OSCRouteObserver::OSCRouteObserver (boost::shared_ptr<Route> r, lo_address a)
+OSCClientFeedback::OSCClientFeedback (lo_address a, uint32_t interval, Glib::RefPtr<Glib::MainContext> context)
+	: feedback (interval)
+{
+	addr = lo_address_new (lo_address_get_hostname(a) , lo_address_get_port(a));
+
+	/* Send is emitted from the timeout, so in the OSC thread */
+	feedback.Send.connect_same_thread (send_connection, boost::bind (&OSCClientFeedback::send_changes, this, _1));
+	feedback.attach (context);
+}
+
+OSCClientFeedback::~OSCClientFeedback ()
+{
+	feedback.detach ();
+	send_connection.disconnect ();
+
+	lo_address_free (addr);
+}
+
+SurfaceFeedback::TargetID
+OSCClientFeedback::add_control (boost::shared_ptr<Route> route, string const & path, boost::shared_ptr<Controllable> controllable)
+{
+	SurfaceFeedback::TargetID const id = feedback.add_control (controllable);
+
+	Target& t = targets[id];
+	t.route = route;
+	t.path = path;
+
+	return id;
+}
+
+void
+OSCClientFeedback::remove (SurfaceFeedback::TargetID id)
+{
+	feedback.remove (id);
+	targets.erase (id);
+}
+
+/** Send a batch of changes as one bundle, rather than one packet each */
+void
+OSCClientFeedback::send_changes (SurfaceFeedback::Changes const & changes)
+{
+	lo_bundle bundle = lo_bundle_new (LO_TT_IMMEDIATE);
+	bool empty = true;
+
+	for (SurfaceFeedback::Changes::const_iterator c = changes.begin(); c != changes.end(); ++c) {
+
+		std::map<SurfaceFeedback::TargetID, Target>::const_iterator t = targets.find (c->target);
+		if (t == targets.end()) {
+			continue;
+		}
+
+		boost::shared_ptr<Route> route = t->second.route.lock ();
+		if (!route) {
+			continue;
+		}
+
+		lo_message msg = lo_message_new ();
+
+		lo_message_add_int32 (msg, route->remote_control_id());
+		lo_message_add_float (msg, c->value);
+
+		lo_bundle_add_message (bundle, t->second.path.c_str(), msg);
+		empty = false;
+	}
+
+	if (!empty) {
+		lo_send_bundle (addr, bundle);
+	}
+
+	lo_bundle_free_messages (bundle);
+}
+
+OSCRouteObserver::OSCRouteObserver (boost::shared_ptr<Route> r, lo_address a, OSCClientFeedback& f)
 	: _route (r)
+	, feedback (f)
 {
 	addr = lo_address_new (lo_address_get_hostname(a) , lo_address_get_port(a));
 	
@@ -43,32 +116,31 @@ OSCRouteObserver::OSCRouteObserver (boost::shared_ptr<Route> r, lo_address a)
 	if (boost::dynamic_pointer_cast<AudioTrack>(_route) || boost::dynamic_pointer_cast<MidiTrack>(_route)) {
 
 		boost::shared_ptr<Track> track = boost::dynamic_pointer_cast<Track>(r);
-		boost::shared_ptr<Controllable> rec_controllable = boost::dynamic_pointer_cast<Controllable>(track->rec_enable_control());
-
-		rec_controllable->Changed.connect (rec_changed_connection, MISSING_INVALIDATOR, bind (&OSCRouteObserver::send_change_message, this, X_("/route/rec"), track->rec_enable_control()), OSC::instance());
+		add_control (X_("/route/rec"), track->rec_enable_control());
 	}
 	
-	boost::shared_ptr<Controllable> mute_controllable = boost::dynamic_pointer_cast<Controllable>(_route->mute_control());
-	mute_controllable->Changed.connect (mute_changed_connection, MISSING_INVALIDATOR, bind (&OSCRouteObserver::send_change_message, this, X_("/route/mute"), _route->mute_control()), OSC::instance());
-
-	boost::shared_ptr<Controllable> solo_controllable = boost::dynamic_pointer_cast<Controllable>(_route->solo_control());
-	solo_controllable->Changed.connect (solo_changed_connection, MISSING_INVALIDATOR, bind (&OSCRouteObserver::send_change_message, this, X_("/route/solo"), _route->solo_control()), OSC::instance());
-
-	boost::shared_ptr<Controllable> gain_controllable = boost::dynamic_pointer_cast<Controllable>(_route->gain_control());
-	gain_controllable->Changed.connect (gain_changed_connection, MISSING_INVALIDATOR, bind (&OSCRouteObserver::send_change_message, this, X_("/route/gain"), _route->gain_control()), OSC::instance());
+	add_control (X_("/route/mute"), _route->mute_control());
+	add_control (X_("/route/solo"), _route->solo_control());
+	add_control (X_("/route/gain"), _route->gain_control());
 }
 
 OSCRouteObserver::~OSCRouteObserver ()
 {
 	name_changed_connection.disconnect();
-	rec_changed_connection.disconnect();
-	mute_changed_connection.disconnect();
-	solo_changed_connection.disconnect();
-	gain_changed_connection.disconnect();
+
+	for (vector<SurfaceFeedback::TargetID>::const_iterator i = feedback_targets.begin(); i != feedback_targets.end(); ++i) {
+		feedback.remove (*i);
+	}
 
 	lo_address_free (addr);
 }
 
+void
+OSCRouteObserver::add_control (string path, boost::shared_ptr<Controllable> controllable)
+{
+	feedback_targets.push_back (feedback.add_control (_route, path, controllable));
+}
+
 void
 OSCRouteObserver::name_changed (const PBD::PropertyChange& what_changed)
 {
@@ -88,19 +160,3 @@ OSCRouteObserver::name_changed (const PBD::PropertyChange& what_changed)
 	lo_send_message (addr, "/route/name", msg);
 	lo_message_free (msg);
 }
-
-void
-OSCRouteObserver::send_change_message (string path, boost::shared_ptr<Controllable> controllable)
-{
-	lo_message msg = lo_message_new ();
-
-	lo_message_add_int32 (msg, _route->remote_control_id());
-	lo_message_add_float (msg, (float) controllable->get_value());
-
-	/* XXX thread issues */
-
-	//std::cerr << "ORC: send " << path << " = " << controllable->get_value() << std::endl;
-
-	lo_send_message (addr, path.c_str(), msg);
-	lo_message_free (msg);
-}
@@ -20,20 +20,56 @@
 #ifndef __osc_oscrouteobserver_h__
 #define __osc_oscrouteobserver_h__
 
+#include <map>
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <sigc++/sigc++.h>
+#include <glibmm/main.h>
 #include <lo/lo.h>
 
 #include "pbd/controllable.h"
 #include "pbd/stateful.h"
 #include "ardour/types.h"
 
+#include "control_protocol/surface_feedback.h"
+
+/** Route feedback for one OSC client.  The observers of all of the
+ *  client's routes add their controls here, so that the changes to them
+ *  go out in one bundle per interval, from one timeout in the OSC thread.
+ */
+class OSCClientFeedback
+{
+  public:
+	OSCClientFeedback (lo_address addr, uint32_t interval, Glib::RefPtr<Glib::MainContext> context);
+	~OSCClientFeedback ();
+
+	ARDOUR::SurfaceFeedback::TargetID add_control (boost::shared_ptr<ARDOUR::Route>, std::string const & path, boost::shared_ptr<PBD::Controllable>);
+	void remove (ARDOUR::SurfaceFeedback::TargetID);
+	bool empty () const { return targets.empty (); }
+
+	void set_interval (uint32_t ms) { feedback.set_interval (ms); }
+
+  private:
+	struct Target {
+		boost::weak_ptr<ARDOUR::Route> route;
+		std::string path;
+	};
+
+	lo_address addr;
+	ARDOUR::SurfaceFeedback feedback;
+	std::map<ARDOUR::SurfaceFeedback::TargetID, Target> targets;
+	PBD::ScopedConnection send_connection;
+
+	void send_changes (ARDOUR::SurfaceFeedback::Changes const & changes);
+};
+
 class OSCRouteObserver
 {
 
   public:
-	OSCRouteObserver (boost::shared_ptr<ARDOUR::Route>, lo_address addr);
+	OSCRouteObserver (boost::shared_ptr<ARDOUR::Route>, lo_address addr, OSCClientFeedback& feedback);
 	~OSCRouteObserver ();
 
 	boost::shared_ptr<ARDOUR::Route> route () const { return _route; }
@@ -44,16 +80,18 @@ class OSCRouteObserver
 	//boost::shared_ptr<Controllable> _controllable;
 	
 	PBD::ScopedConnection name_changed_connection;
-	PBD::ScopedConnection rec_changed_connection;
-	PBD::ScopedConnection mute_changed_connection;
-	PBD::ScopedConnection solo_changed_connection;
-	PBD::ScopedConnection gain_changed_connection;
-	
+
+	/** sends changes to rec-enable, mute, solo and gain, with those of
+	 *  the client's other routes
+	 */
+	OSCClientFeedback& feedback;
+	std::vector<ARDOUR::SurfaceFeedback::TargetID> feedback_targets;
+
 	lo_address addr;
 	std::string path;
 
 	void name_changed (const PBD::PropertyChange& what_changed);
-	void send_change_message (std::string path, boost::shared_ptr<PBD::Controllable> controllable);
+	void add_control (std::string path, boost::shared_ptr<PBD::Controllable> controllable);
 };
 
 #endif /* __osc_oscrouteobserver_h__ */